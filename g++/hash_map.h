@@ -36,6 +36,10 @@
 #ifdef __STL_USE_NAMESPACES
 using __STD::hash;
 using __STD::hashtable;
+using __STD::hash_prime_policy;
+using __STD::hash_pow2_policy;
+using __STD::hash_incremental_policy;
+using __STD::hash_cached_policy;
 using __STD::hash_map;
 using __STD::hash_multimap;
 #endif /* __STL_USE_NAMESPACES */
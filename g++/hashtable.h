@@ -39,6 +39,10 @@
 #ifdef __STL_USE_NAMESPACES
 using __STD::hash;
 using __STD::hashtable;
+using __STD::hash_prime_policy;
+using __STD::hash_pow2_policy;
+using __STD::hash_incremental_policy;
+using __STD::hash_cached_policy;
 #endif /* __STL_USE_NAMESPACES */
 
 #endif /* __SGI_STL_HASHTABLE_H */
@@ -50,7 +50,15 @@ void __rope_iterator_base<charT,Alloc>::setbuf
 		size_t leaf_end = leaf_pos + leaf -> size;
 		char_producer<charT> *fn =
 			((__rope_RopeFunction<charT,Alloc> *)leaf) -> fn;
-
+		__GC_CONST charT * s =
+			(__GC_CONST charT *)(fn -> contiguous());
+
+		if (0 != s) {
+		    x.buf_start = s;
+		    x.buf_ptr = s + (pos - leaf_pos);
+		    x.buf_end = s + leaf -> size;
+		    break;
+		}
 		if (buf_start_pos + len <= pos) {
 		    buf_start_pos = pos - len/4;
 		    if (buf_start_pos + len > leaf_end) {
@@ -82,7 +90,7 @@ void __rope_iterator_base<charT,Alloc>::setcache
     int curr_depth = -1;  /* index into path    */
     size_t curr_start_pos = 0;
     size_t pos = x.current_pos;
-    unsigned char dirns = 0;	// Bit vector indicating right turns in the path
+    unsigned long dirns = 0;	// Bit vector indicating right turns in the path
 
     __stl_assert(pos <= x.root -> size);
     if (pos >= x.root -> size) {
@@ -155,7 +163,7 @@ void __rope_iterator_base<charT,Alloc>::setcache_for_incr
     const RopeBase * current_node = x.path_end[current_index];
     size_t len = current_node -> size;
     size_t node_start_pos = x.leaf_pos;
-    unsigned char dirns = x.path_directions;
+    unsigned long dirns = x.path_directions;
     __rope_RopeConcatenation<charT,Alloc> * c;
 
     __stl_assert(x.current_pos <= x.root -> size);
@@ -210,6 +218,124 @@ void __rope_iterator_base<charT,Alloc>::setcache_for_incr
     setbuf(x);
 }
 
+template <class charT, class Alloc>
+void __rope_iterator_base<charT,Alloc>::copy_from
+(const __rope_iterator_base<charT,Alloc> &x)
+{
+    current_pos = x.current_pos;
+    root = x.root;
+    buf_ptr = x.buf_ptr;
+    if (0 == buf_ptr) return;
+    leaf_pos = x.leaf_pos;
+    leaf_index = x.leaf_index;
+    path_directions = x.path_directions;
+    for (int i = 0; i <= leaf_index; i++) {
+	path_end[i] = x.path_end[i];
+    }
+    if (x.buf_start == x.tmp_buf) {
+	size_t len = x.buf_end - x.buf_start;
+	uninitialized_copy_n(x.tmp_buf, len, tmp_buf);
+	buf_start = tmp_buf;
+	buf_ptr = tmp_buf + (x.buf_ptr - x.buf_start);
+	buf_end = tmp_buf + len;
+    } else {
+	buf_start = x.buf_start;
+	buf_end = x.buf_end;
+    }
+}
+
+template <class charT, class Alloc>
+__rope_piece_cursor<charT,Alloc>::~__rope_piece_cursor()
+{
+    if (0 != buf) {
+	DataAlloc::deallocate(buf, rope<charT,Alloc>::apply_chunk_len);
+    }
+}
+
+// Pop the next pending range and descend to the first piece in it.
+template <class charT, class Alloc>
+void __rope_piece_cursor<charT,Alloc>::advance()
+{
+    while (depth > 0) {
+	--depth;
+	const RopeBase * r = stack[depth].node;
+	size_t begin = stack[depth].begin;
+	size_t end = stack[depth].end;
+	for (;;) {
+	    if (0 != r -> c_string) {
+		piece = r -> c_string + begin;
+		piece_len = end - begin;
+		return;
+	    }
+	    switch(r -> tag) {
+		case RopeBase::concat:
+		  {
+		    const RopeConcatenation * c = (const RopeConcatenation *)r;
+		    size_t left_len = c -> left -> size;
+		    if (begin >= left_len) {
+			r = c -> right;
+			begin -= left_len;
+			end -= left_len;
+			continue;
+		    }
+		    if (end > left_len) {
+			__stl_assert(depth <= RopeBase::max_rope_depth);
+			stack[depth].node = c -> right;
+			stack[depth].begin = 0;
+			stack[depth].end = end - left_len;
+			++depth;
+			end = left_len;
+		    }
+		    r = c -> left;
+		  }
+		  continue;
+		case RopeBase::leaf:
+		    piece = ((const RopeLeaf *)r) -> data + begin;
+		    piece_len = end - begin;
+		    return;
+		case RopeBase::substringfn:
+		  {
+		    const RopeSubstring * ss = (const RopeSubstring *)r;
+		    begin += ss -> start;
+		    end += ss -> start;
+		    r = ss -> base;
+		  }
+		  continue;
+		case RopeBase::function:
+		  {
+		    char_producer<charT> * fn = ((const RopeFunction *)r) -> fn;
+		    const charT * s = fn -> contiguous();
+		    if (0 != s) {
+			piece = s + begin;
+			piece_len = end - begin;
+			return;
+		    }
+		    size_t n = end - begin;
+		    if (n > rope<charT,Alloc>::apply_chunk_len) {
+			n = rope<charT,Alloc>::apply_chunk_len;
+			stack[depth].node = r;
+			stack[depth].begin = begin + n;
+			stack[depth].end = end;
+			++depth;
+		    }
+		    if (0 == buf) {
+			buf = DataAlloc::allocate(
+				rope<charT,Alloc>::apply_chunk_len);
+		    }
+		    (*fn)(begin, n, buf);
+		    piece = buf;
+		    piece_len = n;
+		  }
+		  return;
+		default:
+		    __stl_assert(false);
+	    }
+	}
+    }
+    piece = 0;
+    piece_len = 0;
+}
+
 template <class charT, class Alloc>
 void __rope_iterator_base<charT,Alloc>::incr(size_t n) {
     current_pos += n;
@@ -286,6 +412,7 @@ rope<charT,Alloc>::RopeLeaf_from_char_ptr(__GC_CONST charT *s, size_t size)
     }
     t -> is_balanced = true;
     t -> depth = 0;
+    t -> leaf_capacity_log = 0;
     t -> size = size;
     t -> data = s;
 #   ifndef __GC
@@ -342,12 +469,17 @@ inline void __rope_RopeBase<charT,Alloc>::free_c_string()
 }
 
 template <class charT, class Alloc>
-inline void __rope_RopeBase<charT,Alloc>::free_string(charT* s, size_t n)
+inline void __rope_RopeBase<charT,Alloc>::free_string(charT* s, size_t n,
+						      unsigned char capacity_log)
 {
     if (!__is_basic_char_type((charT *)0)) {
 	destroy(s, s + n);
     }
-    DataAlloc::deallocate(s, rounded_up_size(n));
+    if (0 == capacity_log) {
+	DataAlloc::deallocate(s, rounded_up_size(n));
+    } else {
+	DataAlloc::deallocate(s, (size_t)1 << capacity_log);
+    }
 }
 
 template <class charT, class Alloc>
@@ -363,7 +495,7 @@ void __rope_RopeBase<charT,Alloc>::free_tree()
 		if (d != c_string) {
 		    free_c_string();
 		}
-		free_string(d, size);
+		free_string(d, size, leaf_capacity_log);
 		LAlloc::deallocate(l);
 	    }
 	    break;
@@ -405,7 +537,8 @@ void __rope_RopeBase<charT,Alloc>::free_tree()
 #else
 
 template <class charT, class Alloc>
-inline void __rope_RopeBase<charT,Alloc>::free_string(charT* s, size_t n)
+inline void __rope_RopeBase<charT,Alloc>::free_string(charT* s, size_t n,
+						      unsigned char)
 {}
 
 #endif
@@ -443,7 +576,7 @@ rope<charT,Alloc>::destr_leaf_concat_char_iter
     __stl_assert(r -> refcount >= 1);
     if (r -> refcount > 1) return leaf_concat_char_iter(r, iter, len);
     size_t old_len = r -> size;
-    if (allocated_capacity(old_len) >= old_len + len) {
+    if (leaf_capacity(r) >= old_len + len) {
 	// The space has been partially initialized for the standard
 	// character types.  But that doesn't matter for those types.
 	uninitialized_copy_n(iter, len, r -> data + old_len);
@@ -561,55 +694,179 @@ rope<charT,Alloc>::RopeBase * rope<charT,Alloc>::concat_char_iter
 }
 
 #ifndef __GC
+template <class charT, class Alloc>
+rope<charT,Alloc>::RopeLeaf *
+rope<charT,Alloc>::RopeLeaf_for_append(const charT *s, size_t size,
+				       unsigned char log)
+{
+    charT * buf = DataAlloc::allocate((size_t)1 << log);
+    RopeLeaf * result;
+
+    __STL_TRY {
+	uninitialized_copy_n(s, size, buf);
+    }
+    __STL_UNWIND(DataAlloc::deallocate(buf, (size_t)1 << log));
+    __cond_store_eos(buf[size]);
+    __STL_TRY {
+	result = RopeLeaf_from_char_ptr(buf, size);
+    }
+    __STL_UNWIND(RopeBase::free_string(buf, size, log));
+    result -> leaf_capacity_log = log;
+    return result;
+}
+
+template <class charT, class Alloc>
+void rope<charT,Alloc>::grow_leaf(RopeLeaf * l, unsigned char log)
+{
+    size_t len = l -> size;
+    charT * old_data = l -> data;
+    charT * new_data = DataAlloc::allocate((size_t)1 << log);
+
+    __stl_assert(1 == l -> refcount);
+    __STL_TRY {
+	uninitialized_copy_n(old_data, len, new_data);
+    }
+    __STL_UNWIND(DataAlloc::deallocate(new_data, (size_t)1 << log));
+    __cond_store_eos(new_data[len]);
+    if (l -> c_string == old_data) l -> c_string = new_data;
+    l -> data = new_data;
+    RopeBase::free_string(old_data, len, l -> leaf_capacity_log);
+    l -> leaf_capacity_log = log;
+}
+
+template <class charT, class Alloc>
+void rope<charT,Alloc>::update_concat(RopeConcatenation * c)
+{
+    RopeBase * left = c -> left;
+    RopeBase * right = c -> right;
+    unsigned char child_depth = left -> depth;
+
+    if (0 != c -> c_string) {
+	c -> free_c_string();
+	c -> c_string = 0;
+    }
+    if (right -> depth > child_depth) child_depth = right -> depth;
+    c -> depth = (unsigned char)(child_depth + 1);
+    c -> size = left -> size + right -> size;
+    if (c -> is_balanced
+	&& (c -> depth > RopeBase::max_rope_depth || !is_balanced(c))) {
+	c -> is_balanced = false;
+    }
+}
+
 template <class charT, class Alloc>
 rope<charT,Alloc>::RopeBase * rope<charT,Alloc>
 ::destr_concat_char_iter
 		(RopeBase * r, const charT *s, size_t slen)
 {
-    RopeBase *result;
     if (0 == r) return RopeLeaf_from_unowned_char_ptr(s, slen);
     size_t count = r -> refcount;
-    size_t orig_size = r -> size;
     __stl_assert(count >= 1);
     if (count > 1) return concat_char_iter(r, s, slen);
     if (0 == slen) {
 	r -> refcount = 2;      // One more than before
 	return r;
     }
-    if (orig_size + slen <= copy_max && RopeBase::leaf == r -> tag) {
-	result = destr_leaf_concat_char_iter((RopeLeaf *)r, s, slen);
-	return result;
+    // path[0] ... path[n-1] is the right edge of r, as far down as
+    // each node is referenced only by its parent.  All of it may be
+    // changed in place.
+    RopeBase * path[RopeBase::max_rope_depth + 1];
+    int n = 0;
+    RopeBase * x = r;
+    for (;;) {
+	path[n++] = x;
+	if (RopeBase::concat != x -> tag) break;
+	x = ((RopeConcatenation *)x) -> right;
+	if (x -> refcount > 1) break;
     }
-    if (RopeBase::concat == r -> tag) {
-	RopeLeaf *right = (RopeLeaf *)(((RopeConcatenation *)r) -> right);
-	if (RopeBase::leaf == right -> tag
-	    && right -> size + slen <= copy_max) {
-	  RopeBase * new_right = destr_leaf_concat_char_iter(right, s, slen);
-	  if (right == new_right) {
-	      __stl_assert(new_right -> refcount == 2);
-	      new_right -> refcount = 1;
-	  } else {
-	      __stl_assert(new_right -> refcount >= 1);
-	      right -> unref_nonnil();
-	  }
-	  __stl_assert(r -> refcount == 1);
-	  r -> refcount = 2;    // One more than before.
-	  ((RopeConcatenation *)r) -> right = new_right;
-	  r -> size = orig_size + slen;
-	  if (0 != r -> c_string) {
-	      r -> free_c_string();
-	      r -> c_string = 0;
-	  }
-	  return r;
+    // As much as fits goes into the last leaf, after growing it if
+    // it is short enough.  The rest goes into a new leaf.
+    RopeLeaf * l = 0;
+    size_t done = 0;
+    if (RopeBase::leaf == path[n-1] -> tag) {
+	l = (RopeLeaf *)path[n-1];
+	size_t room = leaf_capacity(l) - l -> size;
+	if (room < slen) {
+	    unsigned char log = append_leaf_log(l -> size + slen);
+	    if (0 != log) {
+		grow_leaf(l, log);
+		room = leaf_capacity(l) - l -> size;
+	    }
 	}
+	done = room < slen ? room : slen;
     }
-    RopeBase *right = RopeLeaf_from_unowned_char_ptr(s, slen);
-    r -> ref_nonnil();
-    __STL_TRY {
-      result = tree_concat(r, right);
+    size_t rest = slen - done;
+    RopeBase * nleaf = 0;
+    RopeConcatenation * nc = 0;
+    int k = 0;
+    if (0 != rest) {
+	unsigned char log = append_leaf_log(rest);
+	if (0 != log) {
+	    nleaf = RopeLeaf_for_append(s + done, rest, log);
+	} else {
+	    nleaf = RopeLeaf_from_unowned_char_ptr(s + done, rest);
+	}
+	__STL_TRY {
+	    nc = CAlloc::allocate();
+	}
+	__STL_UNWIND(unref(nleaf));
+	// Hang the new leaf below the first node on the path whose
+	// right subtree is no shallower than its left one.  As in an
+	// AVL tree, this keeps the depth within about 1.44 log2 of
+	// the number of leaves, so balance() is rarely needed.
+	while (k + 1 < n) {
+	    RopeBase * left = ((RopeConcatenation *)path[k]) -> left;
+	    if (path[k+1] -> depth >= left -> depth) break;
+	    ++k;
+	}
+    }
+    if (0 != done) {
+	__STL_TRY {
+	    uninitialized_copy_n(s, done, l -> data + l -> size);
+	}
+	__STL_UNWIND(unref(nleaf); if (0 != nc) CAlloc::deallocate(nc));
+	if (l -> c_string != l -> data && 0 != l -> c_string) {
+	    l -> free_c_string();
+	    l -> c_string = 0;
+	}
+	__cond_store_eos(l -> data[l -> size + done]);
+	l -> size += done;
+    }
+    // Nodes from the attachment point down to the last leaf grew by
+    // done characters, which cannot change their depth.  Those above
+    // the attachment point may have become deeper.
+    int i;
+    for (i = k; i < n - 1; ++i) {
+	RopeBase * c = path[i];
+	if (0 != c -> c_string) {
+	    c -> free_c_string();
+	    c -> c_string = 0;
+	}
+	c -> size += done;
+    }
+    if (0 != nc) {
+	nc -> tag = RopeBase::concat;
+	nc -> c_string = 0;
+	nc -> is_balanced = false;
+	nc -> refcount = 1;
+	nc -> init_refcount_lock();
+	nc -> left = path[k];
+	nc -> right = nleaf;
+	update_concat(nc);
+	if (0 != k) ((RopeConcatenation *)path[k-1]) -> right = nc;
+	for (i = k - 1; i >= 0; --i) {
+	    update_concat((RopeConcatenation *)path[i]);
+	}
+    }
+    // Either r is returned, or it is now the left child of nc.
+    // Both count as one more reference than before.
+    __stl_assert(r -> refcount == 1);
+    r -> refcount = 2;
+    RopeBase * result = (0 == k && 0 != nc) ? nc : r;
+    if (result -> depth > RopeBase::max_rope_depth) {
+	self_destruct_ptr old(result);
+	return balance(result);
     }
-    __STL_UNWIND(unref(r); unref(right))
-    __stl_assert(1 == result -> refcount);
     return result;
 }
 #endif /* !__GC */
@@ -786,6 +1043,21 @@ class __rope_flatten_char_consumer : public __rope_char_consumer<charT> {
 	}
 };
 	    
+template<class charT>
+inline const charT * __rope_find(const charT * first, const charT * last,
+				 charT c)
+{
+    while (first != last && !(*first == c)) ++first;
+    return first;
+}
+
+inline const char * __rope_find(const char * first, const char * last,
+				char c)
+{
+    const void * p = memchr(first, c, last - first);
+    return 0 == p? last : (const char *)p;
+}
+
 template<class charT>
 class __rope_find_char_char_consumer : public __rope_char_consumer<charT> {
     private:
@@ -795,13 +1067,9 @@ class __rope_find_char_char_consumer : public __rope_char_consumer<charT> {
 	__rope_find_char_char_consumer(charT p) : pattern(p), count(0) {}
 	~__rope_find_char_char_consumer() {}
 	bool operator() (const charT* leaf, size_t n) {
-	    size_t i;
-	    for (i = 0; i < n; i++) {
-		if (leaf[i] == pattern) {
-		    count += i; return false;
-		}
-	    }
-	    count += n; return true;
+	    size_t i = __rope_find(leaf, leaf + n, pattern) - leaf;
+	    count += i;
+	    return i == n;
 	}
 };
 	    
@@ -829,11 +1097,11 @@ bool __rope_insert_char_consumer<charT>::operator()
     return true;
 }
 
+// Whole pieces go to the streambuf at once, through xsputn.
 inline bool __rope_insert_char_consumer<char>::operator()
 					(const char * leaf, size_t n)
 {
-    size_t i;
-    for (i = 0; i < n; i++) o.put(leaf[i]);
+    o.write(leaf, n);
     return true;
 }
 
@@ -848,6 +1116,92 @@ inline bool __rope_insert_char_consumer<wchar_t>::operator()
 }
 #endif /* !_MSC_VER  && !BORLAND */
 
+#ifdef __STL_USE_WRITEV
+// Write all of iov[0] ... iov[n-1], resuming after partial writes.
+inline bool __rope_writev(int fd, struct iovec * iov, int n)
+{
+    while (n > 0) {
+	ssize_t written = writev(fd, iov, n);
+	if (written < 0) {
+	    if (EINTR == errno) continue;
+	    return false;
+	}
+	size_t done = written;
+	while (n > 0 && done >= iov -> iov_len) {
+	    done -= iov -> iov_len;
+	    ++iov;
+	    --n;
+	}
+	if (n > 0) {
+	    iov -> iov_base = (char *)(iov -> iov_base) + done;
+	    iov -> iov_len -= done;
+	}
+    }
+    return true;
+}
+
+// Gathers pieces that stay valid into one writev call per
+// iov_count pieces.  Transient pieces force a flush.
+template<class charT>
+class __rope_writev_char_consumer : public __rope_char_consumer<charT> {
+    private:
+	enum { iov_count = 64 };
+	int fd;
+	int pending;
+	struct iovec iov[iov_count];
+    public:
+	__rope_writev_char_consumer(int f) : fd(f), pending(0) {}
+	~__rope_writev_char_consumer() {}
+	bool flush() {
+	    int n = pending;
+	    pending = 0;
+	    return __rope_writev(fd, iov, n);
+	}
+	bool operator() (const charT* leaf, size_t n) {
+	    if (0 == n) return true;
+	    iov[pending].iov_base = (void *)leaf;
+	    iov[pending].iov_len = n * sizeof(charT);
+	    ++pending;
+	    return pending < iov_count || flush();
+	}
+	bool transient(const charT* buffer, size_t n) {
+	    return (*this)(buffer, n) && flush();
+	}
+};
+
+template <class charT, class Alloc>
+bool rope<charT, Alloc>::write(int fd, size_t begin, size_t end) const
+{
+    __rope_writev_char_consumer<charT> c(fd);
+    return apply_to_pieces(c, tree_ptr, begin, end) && c.flush();
+}
+#endif /* __STL_USE_WRITEV */
+
+template <class charT, class Alloc>
+bool rope<charT, Alloc>::map_file(const char* path)
+{
+    __rope_file_char_producer<charT> * fn =
+	new __rope_file_char_producer<charT>;
+    if (!fn -> file.open(path)) {
+	delete fn;
+	return false;
+    }
+    // A trailing partial character is dropped.
+    size_t len = fn -> file.size() / sizeof(charT);
+    RopeBase * result = 0;
+    if (0 == len) {
+	delete fn;
+    } else {
+	__STL_TRY {
+	    result = RopeFunction_from_fn(fn, len, true);
+	}
+	__STL_UNWIND(delete fn)
+    }
+    unref(tree_ptr);
+    tree_ptr = result;
+    return true;
+}
+
 template <class charT, class Alloc>
 bool rope<charT, Alloc>::apply_to_pieces(
 				__rope_char_consumer<charT>& c,
@@ -883,19 +1237,34 @@ bool rope<charT, Alloc>::apply_to_pieces(
 		RopeLeaf * l = (RopeLeaf *)r;
 		return c(l -> data + begin, end - begin);
 	    }
-	case RopeBase::function:
 	case RopeBase::substringfn:
+	    {
+		// Visit the base directly, so that a substring of a
+		// leaf is passed on in place.
+		RopeSubstring * ss = (RopeSubstring *)r;
+		size_t start = ss -> start;
+		return apply_to_pieces(c, ss -> base,
+				       start + begin, start + end);
+	    }
+	case RopeBase::function:
 	    {
 		RopeFunction * f = (RopeFunction *)r;
+		const charT * s = f -> fn -> contiguous();
+		if (0 != s) return c(s + begin, end - begin);
 		size_t len = end - begin;
-		bool result;
-		charT * buffer = DataAlloc::allocate(len);
+		size_t buf_len = min(len, (size_t)apply_chunk_len);
+		bool result = true;
+		charT * buffer = DataAlloc::allocate(buf_len);
 		__STL_TRY {
-		  (*(f -> fn))(begin, end, buffer);
-		  result = c(buffer, len);
-                  DataAlloc::deallocate(buffer, len);
+		  while (result && begin < end) {
+		    size_t n = min(end - begin, buf_len);
+		    (*(f -> fn))(begin, n, buffer);
+		    result = c.transient(buffer, n);
+		    begin += n;
+		  }
+                  DataAlloc::deallocate(buffer, buf_len);
                 }
-		__STL_UNWIND(DataAlloc::deallocate(buffer, len))
+		__STL_UNWIND(DataAlloc::deallocate(buffer, buf_len))
 		return result;
 	    }
 	default:
@@ -970,6 +1339,38 @@ rope<charT,Alloc>::find(charT pattern, size_t start) const
     return start + c.count;
 }
 
+template <class charT, class Alloc>
+size_t
+rope<charT,Alloc>::find(const charT *s, size_t start) const
+{
+    size_t len = char_ptr_len(s);
+    size_t n = size();
+    if (0 == len) return start;
+    for (piece_cursor c(tree_ptr, start, n); !c.done(); c.next()) {
+	const charT * first = c.data();
+	const charT * last = first + c.size();
+	const charT * p = first;
+	while ((p = __rope_find(p, last, s[0])) != last) {
+	    size_t pos = c.index() + (p - first);
+	    if (pos + len > n) return n;
+	    if (len <= (size_t)(last - p)) {
+		if (equal(p, p + len, s)) return pos;
+	    } else {
+		// The match would run into the following pieces.
+		piece_cursor m(tree_ptr, pos, pos + len);
+		const charT * t = s;
+		while (!m.done() && equal(m.data(), m.data() + m.size(), t)) {
+		    t += m.size();
+		    m.next();
+		}
+		if (m.done()) return pos;
+	    }
+	    ++p;
+	}
+    }
+    return n;
+}
+
 template <class charT, class Alloc>
 charT *
 rope<charT,Alloc>::flatten(RopeBase * r, charT * buffer)
@@ -1278,10 +1679,25 @@ rope<charT,Alloc>::fetch_ptr(RopeBase *r, size_type i)
 }
 # endif /* __GC */
 
+// Compare n characters of two pieces.  For char the common case, equal
+// pieces, is settled by memcmp; lexicographical_compare_3way is kept for
+// the ordering, since plain char may be signed.
+template <class charT>
+inline int __rope_compare_pieces(const charT * x, const charT * y, size_t n)
+{
+    return lexicographical_compare_3way(x, x + n, y, y + n);
+}
+
+inline int __rope_compare_pieces(const char * x, const char * y, size_t n)
+{
+    if (0 == memcmp(x, y, n)) return 0;
+    return lexicographical_compare_3way(x, x + n, y, y + n);
+}
+
 // The following could be implemented trivially using
-// lexicographical_compare_3way.
-// We do a little more work to avoid dealing with rope iterators for
-// flat strings.
+// lexicographical_compare_3way on rope iterators.
+// We walk both ropes a piece at a time instead, and compare the
+// overlapping parts of the pieces as arrays.
 template <class charT, class Alloc>
 int
 rope<charT,Alloc>::compare (const RopeBase *left, const RopeBase *right)
@@ -1289,40 +1705,44 @@ rope<charT,Alloc>::compare (const RopeBase *left, const RopeBase *right)
     size_t left_len;
     size_t right_len;
 
-    if (0 == right) return 0 != left;
+    if (left == right) return 0;
+    if (0 == right) return 1;
     if (0 == left) return -1;
     left_len = left -> size;
     right_len = right -> size;
-    if (RopeBase::leaf == left -> tag) {
+    if (RopeBase::leaf == left -> tag && RopeBase::leaf == right -> tag) {
 	RopeLeaf *l = (RopeLeaf *) left;
-	if (RopeBase::leaf == right -> tag) {
-	    RopeLeaf *r = (RopeLeaf *) right;
-	    return lexicographical_compare_3way(
+	RopeLeaf *r = (RopeLeaf *) right;
+	return lexicographical_compare_3way(
 			l -> data, l -> data + left_len,
 			r -> data, r -> data + right_len);
-	} else {
-	    const_iterator rstart(right, 0);
-	    const_iterator rend(right, right_len);
-	    return lexicographical_compare_3way(
-			l -> data, l -> data + left_len,
-			rstart, rend);
+    }
+    piece_cursor lc(left, 0, left_len);
+    piece_cursor rc(right, 0, right_len);
+    const charT * lp = lc.data();
+    const charT * rp = rc.data();
+    size_t ln = lc.size();
+    size_t rn = rc.size();
+    while (0 != ln && 0 != rn) {
+	size_t n = min(ln, rn);
+	int result = __rope_compare_pieces(lp, rp, n);
+	if (0 != result) return result;
+	lp += n; ln -= n;
+	rp += n; rn -= n;
+	if (0 == ln) {
+	    lc.next();
+	    lp = lc.data();
+	    ln = lc.size();
 	}
-    } else {
-	const_iterator lstart(left, 0);
-	const_iterator lend(left, left_len);
-	if (RopeBase::leaf == right -> tag) {
-	    RopeLeaf *r = (RopeLeaf *) right;
-	    return lexicographical_compare_3way(
-				   lstart, lend,
-				   r -> data, r -> data + right_len);
-	} else {
-	    const_iterator rstart(right, 0);
-	    const_iterator rend(right, right_len);
-	    return lexicographical_compare_3way(
-				   lstart, lend,
-				   rstart, rend);
+	if (0 == rn) {
+	    rc.next();
+	    rp = rc.data();
+	    rn = rc.size();
 	}
     }
+    if (0 != ln) return 1;
+    if (0 != rn) return -1;
+    return 0;
 }
 
 // Assignment to reference proxies.
@@ -1429,7 +1849,7 @@ rope<charT, Alloc>::rope(size_t n, charT c)
 
 template<class charT, class Alloc> charT rope<charT,Alloc>::empty_c_str[1];
 
-# ifdef __STL_PTHREADS
+# if defined(__STL_PTHREADS) && !defined(__STL_ATOMIC_BUILTINS)
     template<class charT, class Alloc>
     pthread_mutex_t rope<charT,Alloc>::swap_lock = PTHREAD_MUTEX_INITIALIZER;
 # endif
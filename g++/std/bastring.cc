@@ -46,9 +46,7 @@ template <class charT, class traits, class Allocator>
 inline size_t basic_string <charT, traits, Allocator>::Rep::
 frob_size (size_t s)
 {
-  size_t i = 16;
-  while (i < s) i *= 2;
-  return i;
+  return (s + 15) & ~size_t (15);
 }
 
 template <class charT, class traits, class Allocator>
@@ -66,30 +64,25 @@ create (size_t extra)
 
 template <class charT, class traits, class Allocator>
 charT * basic_string <charT, traits, Allocator>::Rep::
-clone ()
+clone (size_t len)
 {
   Rep *p = Rep::create (len);
-  p->copy (0, data (), len);
-  p->len = len;
+  _copy (p->data (), data (), len);
   return p->data ();
 }
 
-template <class charT, class traits, class Allocator>
-inline bool basic_string <charT, traits, Allocator>::Rep::
-excess_slop (size_t s, size_t r)
-{
-  return 2 * (s <= 16 ? 16 : s) < r;
-}
-
 template <class charT, class traits, class Allocator>
 inline bool basic_string <charT, traits, Allocator>::
 check_realloc (basic_string::size_type s) const
 {
-  s += sizeof (charT);
-  rep ()->selfish = false;
-  return (rep ()->ref > 1
-	  || s > capacity ()
-	  || Rep::excess_slop (s, capacity ()));
+  if (is_local ())
+    return s >= local_size;
+  s += 1;
+  // A selfish Rep is never shared, so this store cannot race with
+  // another string's check of the same Rep.
+  if (rep ()->selfish)
+    rep ()->selfish = false;
+  return (rep ()->count () > 1 || s > rep ()->res);
 }
 
 template <class charT, class traits, class Allocator>
@@ -99,17 +92,66 @@ alloc (basic_string::size_type size, bool save)
   if (! check_realloc (size))
     return;
 
-  Rep *p = Rep::create (size);
+  charT *p = new_storage (size);
 
   if (save)
+    _copy (p, data (), length ());
+  else
+    dat_len = 0;
+
+  install (p);
+}
+
+template <class charT, class traits, class Allocator>
+void basic_string <charT, traits, Allocator>::
+reserve (size_type n)
+{
+  LENGTHERROR (n > max_size ());
+  if (n <= capacity ())
+    return;
+
+  charT *p = Rep::create (n)->data ();
+  _copy (p, data (), length ());
+  install (p);
+}
+
+template <class charT, class traits, class Allocator>
+void basic_string <charT, traits, Allocator>::
+shrink_to_fit ()
+{
+  // A shared Rep is left alone, since a copy would only add memory.
+  if (is_local () || rep ()->count () > 1
+      || Rep::frob_size (length () + 1) >= rep ()->res)
+    return;
+
+  charT *p = new_storage (length ());
+  _copy (p, data (), length ());
+  install (p);
+}
+
+template <class charT, class traits, class Allocator>
+void basic_string <charT, traits, Allocator>::
+swap (basic_string &s)
+{
+  if (! is_local () && ! s.is_local ())
     {
-      p->copy (0, data (), length ());
-      p->len = length ();
+      charT *d = dat; dat = s.dat; s.dat = d;
     }
   else
-    p->len = 0;
-
-  repup (p);
+    {
+      charT tmp[local_size];
+      charT *d = is_local () ? 0 : dat;
+      charT *sd = s.is_local () ? 0 : s.dat;
+      if (! d)
+	_copy (tmp, local_buf, dat_len);
+      if (! sd)
+	_copy (local_buf, s.local_buf, s.dat_len);
+      dat = sd ? sd : local_buf;
+      if (! d)
+	_copy (s.local_buf, tmp, dat_len);
+      s.dat = d ? d : s.local_buf;
+    }
+  size_type l = dat_len; dat_len = s.dat_len; s.dat_len = l;
 }
 
 template <class charT, class traits, class Allocator>
@@ -132,19 +174,19 @@ replace (size_type pos1, size_type n1,
 }
 
 template <class charT, class traits, class Allocator>
-inline void basic_string <charT, traits, Allocator>::Rep::
-copy (size_t pos, const charT *s, size_t n)
+inline void basic_string <charT, traits, Allocator>::
+_copy (charT *d, const charT *s, size_type n)
 {
   if (n)
-    traits::copy (data () + pos, s, n);
+    traits::copy (d, s, n);
 }
 
 template <class charT, class traits, class Allocator>
-inline void basic_string <charT, traits, Allocator>::Rep::
-move (size_t pos, const charT *s, size_t n)
+inline void basic_string <charT, traits, Allocator>::
+_move (charT *d, const charT *s, size_type n)
 {
   if (n)
-    traits::move (data () + pos, s, n);
+    traits::move (d, s, n);
 }
 
 template <class charT, class traits, class Allocator>
@@ -161,29 +203,25 @@ replace (size_type pos, size_type n1, const charT* s, size_type n2)
 
   if (check_realloc (newlen))
     {
-      Rep *p = Rep::create (newlen);
-      p->copy (0, data (), pos);
-      p->copy (pos + n2, data () + pos + n1, len - (pos + n1));
-      p->copy (pos, s, n2);
-      repup (p);
+      charT *p = new_storage (newlen);
+      _copy (p, data (), pos);
+      _copy (p + pos + n2, data () + pos + n1, len - (pos + n1));
+      _copy (p + pos, s, n2);
+      install (p);
     }
+  else if (n2 && s < dat + len && dat < s + n2)
+    // S is part of this string and would be overwritten as we go.
+    return replace (pos, n1, basic_string (s, n2));
   else
     {
-      rep ()->move (pos + n2, data () + pos + n1, len - (pos + n1));
-      rep ()->copy (pos, s, n2);
+      _move (dat + pos + n2, data () + pos + n1, len - (pos + n1));
+      _copy (dat + pos, s, n2);
     }
-  rep ()->len = newlen;
+  dat_len = newlen;
 
   return *this;
 }
 
-template <class charT, class traits, class Allocator>
-inline void basic_string <charT, traits, Allocator>::Rep::
-set (size_t pos, const charT c, size_t n)
-{
-  traits::set  (data () + pos, c, n);
-}
-
 template <class charT, class traits, class Allocator>
 basic_string <charT, traits, Allocator>& basic_string <charT, traits, Allocator>::
 replace (size_type pos, size_type n1, size_type n2, charT c)
@@ -197,18 +235,18 @@ replace (size_type pos, size_type n1, size_type n2, charT c)
 
   if (check_realloc (newlen))
     {
-      Rep *p = Rep::create (newlen);
-      p->copy (0, data (), pos);
-      p->copy (pos + n2, data () + pos + n1, len - (pos + n1));
-      p->set  (pos, c, n2);
-      repup (p);
+      charT *p = new_storage (newlen);
+      _copy (p, data (), pos);
+      _copy (p + pos + n2, data () + pos + n1, len - (pos + n1));
+      traits::set (p + pos, c, n2);
+      install (p);
     }
   else
     {
-      rep ()->move (pos + n2, data () + pos + n1, len - (pos + n1));
-      rep ()->set  (pos, c, n2);
+      _move (dat + pos + n2, data () + pos + n1, len - (pos + n1));
+      traits::set (dat + pos, c, n2);
     }
-  rep ()->len = newlen;
+  dat_len = newlen;
 
   return *this;
 }
@@ -239,159 +277,6 @@ copy (charT* s, size_type n, size_type pos) const
   return n;
 }
 
-template <class charT, class traits, class Allocator>
-basic_string <charT, traits, Allocator>::size_type
-basic_string <charT, traits, Allocator>::
-find (const charT* s, size_type pos, size_type n) const
-{
-  size_t xpos = pos;
-  for (; xpos + n <= length (); ++xpos)
-    if (traits::eq (data () [xpos], *s)
-	&& traits::compare (data () + xpos, s, n) == 0)
-      return xpos;
-  return npos;
-}
-
-template <class charT, class traits, class Allocator>
-inline basic_string <charT, traits, Allocator>::size_type
-basic_string <charT, traits, Allocator>::
-_find (const charT* ptr, charT c, size_type xpos, size_type len)
-{
-  for (; xpos < len; ++xpos)
-    if (traits::eq (ptr [xpos], c))
-      return xpos;
-  return npos;
-}
-
-template <class charT, class traits, class Allocator>
-basic_string <charT, traits, Allocator>::size_type
-basic_string <charT, traits, Allocator>::
-find (charT c, size_type pos) const
-{
-  return _find (data (), c, pos, length ());
-}
-
-template <class charT, class traits, class Allocator>
-basic_string <charT, traits, Allocator>::size_type
-basic_string <charT, traits, Allocator>::
-rfind (const charT* s, size_type pos, size_type n) const
-{
-  if (n > length ())
-    return npos;
-
-  size_t xpos = length () - n;
-  if (xpos > pos)
-    xpos = pos;
-
-  for (++xpos; xpos-- > 0; )
-    if (traits::eq (data () [xpos], *s)
-	&& traits::compare (data () + xpos, s, n) == 0)
-      return xpos;
-  return npos;
-}
-
-template <class charT, class traits, class Allocator>
-basic_string <charT, traits, Allocator>::size_type
-basic_string <charT, traits, Allocator>::
-rfind (charT c, size_type pos) const
-{
-  if (1 > length ())
-    return npos;
-
-  size_t xpos = length () - 1;
-  if (xpos > pos)
-    xpos = pos;
-
-  for (++xpos; xpos-- > 0; )
-    if (traits::eq (data () [xpos], c))
-      return xpos;
-  return npos;
-}
-
-template <class charT, class traits, class Allocator>
-basic_string <charT, traits, Allocator>::size_type
-basic_string <charT, traits, Allocator>::
-find_first_of (const charT* s, size_type pos, size_type n) const
-{
-  size_t xpos = pos;
-  for (; xpos < length (); ++xpos)
-    if (_find (s, data () [xpos], 0, n) != npos)
-      return xpos;
-  return npos;
-}
-
-template <class charT, class traits, class Allocator>
-basic_string <charT, traits, Allocator>::size_type
-basic_string <charT, traits, Allocator>::
-find_last_of (const charT* s, size_type pos, size_type n) const
-{
-  if (length() == 0)
-    return npos;
-  size_t xpos = length () - 1;
-  if (xpos > pos)
-    xpos = pos;
-  for (++xpos; xpos-- > 0;)
-    if (_find (s, data () [xpos], 0, n) != npos)
-      return xpos;
-  return npos;
-}
-
-template <class charT, class traits, class Allocator>
-basic_string <charT, traits, Allocator>::size_type
-basic_string <charT, traits, Allocator>::
-find_first_not_of (const charT* s, size_type pos, size_type n) const
-{
-  size_t xpos = pos;
-  for (; xpos < length (); ++xpos)
-    if (_find (s, data () [xpos], 0, n) == npos)
-      return xpos;
-  return npos;
-}
-
-template <class charT, class traits, class Allocator>
-basic_string <charT, traits, Allocator>::size_type
-basic_string <charT, traits, Allocator>::
-find_first_not_of (charT c, size_type pos) const
-{
-  size_t xpos = pos;
-  for (; xpos < length (); ++xpos)
-    if (traits::ne (data () [xpos], c))
-      return xpos;
-  return npos;
-}
-
-template <class charT, class traits, class Allocator>
-basic_string <charT, traits, Allocator>::size_type
-basic_string <charT, traits, Allocator>::
-find_last_not_of (const charT* s, size_type pos, size_type n) const
-{
-  if (length() == 0)
-    return npos;
-  size_t xpos = length () - 1;
-  if (xpos > pos)
-    xpos = pos;
-  for (++xpos; xpos-- > 0;)
-    if (_find (s, data () [xpos], 0, n) == npos)
-      return xpos;
-  return npos;
-}
-
-template <class charT, class traits, class Allocator>
-basic_string <charT, traits, Allocator>::size_type
-basic_string <charT, traits, Allocator>::
-find_last_not_of (charT c, size_type pos) const
-{
-  if (length() == 0)
-    return npos;
-  size_t xpos = length () - 1;
-  if (xpos > pos)
-    xpos = pos;
-  for (++xpos; xpos-- > 0;)
-    if (traits::ne (data () [xpos], c))
-      return xpos;
-  return npos;
-}
-
 template <class charT, class traits, class Allocator>
 int basic_string <charT, traits, Allocator>::
 compare (const basic_string& str, size_type pos, size_type n) const
@@ -437,23 +322,59 @@ operator>> (istream &is, basic_string <charT, traits, Allocator> &s)
     {
       register streambuf *sb = is.rdbuf ();
       s.resize (0);
-      while (1)
+      if (__string_bytewise <traits>::value)
 	{
-	  int ch = sb->sbumpc ();
-	  if (ch == EOF)
-	    {
-	      is.setstate (ios::eofbit);
-	      break;
-	    }
-	  else if (traits::is_del (ch))
+	  // Take the word a buffer at a time, straight from the get area,
+	  // leaving the delimiter there as sungetc would.  Characters put
+	  // back into the backup area are taken one at a time.
+	  const size_t limit = w > 1 ? w - 1 : s.npos;
+	  while (s.length () < limit)
 	    {
-	      sb->sungetc ();
-	      break;
+	      int ch = sb->sgetc ();
+	      if (ch == EOF)
+		{
+		  is.setstate (ios::eofbit);
+		  break;
+		}
+	      if (sb->in_backup ())
+		{
+		  if (traits::is_del (ch))
+		    break;
+		  s += charT (ch);
+		  sb->stossc ();
+		  continue;
+		}
+	      const char *p = sb->gptr ();
+	      const char *e = sb->egptr ();
+	      if (size_t (e - p) > limit - s.length ())
+		e = p + (limit - s.length ());
+	      const char *q = p;
+	      while (q < e && ! traits::is_del (*q))
+		++q;
+	      s.append ((const charT *) p, q - p);
+	      sb->gbump (q - p);
+	      if (q < e)
+		break;
 	    }
-	  s += ch;
-	  if (--w == 1)
-	    break;
 	}
+      else
+	while (1)
+	  {
+	    int ch = sb->sbumpc ();
+	    if (ch == EOF)
+	      {
+		is.setstate (ios::eofbit);
+		break;
+	      }
+	    else if (traits::is_del (ch))
+	      {
+		sb->sungetc ();
+		break;
+	      }
+	    s += ch;
+	    if (--w == 1)
+	      break;
+	  }
     }
 
   is.isfx ();
@@ -480,30 +401,72 @@ getline (istream &is, basic_string <charT, traits, Allocator>& s, charT delim)
       streambuf *sb = is.rdbuf ();
       s.resize (0);
 
-      while (1)
+      if (__string_bytewise <traits>::value)
 	{
-	  int ch = sb->sbumpc ();
-	  if (ch == EOF)
+	  // Look for the delimiter in the get area with memchr and append
+	  // everything before it at once, refilling the buffer as needed.
+	  // Characters put back into the backup area are taken one at a
+	  // time.
+	  while (1)
 	    {
-	      is.setstate (count == 0
-			   ? (ios::failbit|ios::eofbit)
-			   : ios::eofbit);
-	      break;
+	      int ch = sb->sgetc ();
+	      if (ch == EOF)
+		{
+		  is.setstate (count == 0
+			       ? (ios::failbit|ios::eofbit)
+			       : ios::eofbit);
+		  break;
+		}
+	      if (sb->in_backup ())
+		{
+		  sb->stossc ();
+		  ++count;
+		  if (ch == (unsigned char) delim)
+		    break;
+		  s += charT (ch);
+		  continue;
+		}
+
+	      const char *p = sb->gptr ();
+	      size_t avail = sb->egptr () - p;
+	      const char *e = (const char *) memchr (p, (char) delim, avail);
+	      size_t n = e ? e - p : avail;
+
+	      s.append ((const charT *) p, n);
+	      if (e)
+		++n;
+	      sb->gbump (n);
+	      count += n;
+
+	      if (e)
+		break;
 	    }
+	}
+      else
+	while (1)
+	  {
+	    int ch = sb->sbumpc ();
+	    if (ch == EOF)
+	      {
+		is.setstate (count == 0
+			     ? (ios::failbit|ios::eofbit)
+			     : ios::eofbit);
+		break;
+	      }
+
+	    ++count;
+
+	    if (ch == delim)
+	      break;
 
-	  ++count;
-
-	  if (ch == delim)
-	    break;
-
-	  s += ch;
+	    s += ch;
 
-	  if (s.length () == s.npos - 1)
-	    {
-	      is.setstate (ios::failbit);
-	      break;
-	    }
-	}
+	    if (s.length () == s.npos - 1)
+	      {
+		is.setstate (ios::failbit);
+		break;
+	      }
+	  }
     }
 
   // We need to be friends with istream to do this.
@@ -513,10 +476,6 @@ getline (istream &is, basic_string <charT, traits, Allocator>& s, charT delim)
   return is;
 }
 
-template <class charT, class traits, class Allocator>
-basic_string <charT, traits, Allocator>::Rep
-basic_string<charT, traits, Allocator>::nilRep = { 0, 0, 1, false };
-
 template <class charT, class traits, class Allocator>
 const basic_string <charT, traits, Allocator>::size_type
 basic_string <charT, traits, Allocator>::npos;
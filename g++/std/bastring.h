@@ -37,6 +37,7 @@
 
 // NOTE : This does NOT conform to the draft standard and is likely to change
 #include <alloc.h>
+#include <stl_hash_fun.h>
 
 extern "C++" {
 class istream; class ostream;
@@ -61,30 +62,68 @@ extern void __length_error (const char *);
 
 #endif
 
+#include <std/strview.h>
+
 template <class charT, class traits = string_char_traits<charT>,
 	  class Allocator = alloc >
 class basic_string
 {
 private:
+  // A string shorter than local_size characters is kept in local_buf,
+  // inside the string object, and is copied when the string is.  A
+  // longer one lives in a reference-counted Rep on the heap, which
+  // copies share until one of them is changed.  Either way dat points
+  // at the characters and dat_len holds the length.
   struct Rep {
-    size_t len, res, ref;
+    size_t res, ref;
     bool selfish;
 
     charT* data () { return reinterpret_cast<charT *>(this + 1); }
     charT& operator[] (size_t s) { return data () [s]; }
-    charT* grab () { if (selfish) return clone (); ++ref; return data (); }
-    void release () { if (--ref == 0) delete this; }
+    charT* grab (size_t len)
+      { if (selfish) return clone (len); incr_ref (); return data (); }
+    void release () { if (decr_ref () == 0) delete this; }
+
+#if defined (__STL_PTHREADS) && defined (__STL_ATOMIC_BUILTINS)
+    // Copies of a string may be made and dropped on different threads,
+    // so the count is changed with the GCC atomic builtins, unless the
+    // allocator says the string stays on one thread.  A count of 1
+    // belongs to the caller alone, since nobody else holds the Rep to
+    // copy it, so the last release needs no locked instruction.
+    void incr_ref ()
+      {
+	if (__alloc_single_client <Allocator>::value)
+	  ++ref;
+	else
+	  __sync_add_and_fetch (&ref, 1);
+      }
+    size_t decr_ref ()
+      {
+	if (__alloc_single_client <Allocator>::value)
+	  return --ref;
+	return count () == 1 ? 0 : __sync_sub_and_fetch (&ref, 1);
+      }
+    size_t count () const
+      {
+	if (__alloc_single_client <Allocator>::value)
+	  return ref;
+#  ifdef __ATOMIC_ACQUIRE
+	return __atomic_load_n (&ref, __ATOMIC_ACQUIRE);
+#  else
+	return *(const volatile size_t *) &ref;
+#  endif
+      }
+#else
+    void incr_ref () { ++ref; }
+    size_t decr_ref () { return --ref; }
+    size_t count () const { return ref; }
+#endif
 
     inline static void * operator new (size_t, size_t);
     inline static void operator delete (void *);
     inline static Rep* create (size_t);
-    charT* clone ();
+    charT* clone (size_t);
 
-    inline void copy (size_t, const charT *, size_t);
-    inline void move (size_t, const charT *, size_t);
-    inline void set  (size_t, const charT,   size_t);
-
-    inline static bool excess_slop (size_t, size_t);
     inline static size_t frob_size (size_t);
 
   private:
@@ -108,54 +147,94 @@ public:
   typedef ::reverse_iterator<iterator> reverse_iterator;
   typedef ::reverse_iterator<const_iterator> const_reverse_iterator;
   static const size_type npos = static_cast<size_type>(-1);
+  typedef basic_string_view <charT, traits> view_type;
 
 private:
+  enum { local_size = 16 / sizeof (charT) > 1 ? 16 / sizeof (charT) : 2 };
+
+  bool is_local () const { return dat == local_buf; }
   Rep *rep () const { return reinterpret_cast<Rep *>(dat) - 1; }
-  void repup (Rep *p) { rep ()->release (); dat = p->data (); }
+  // Storage for n characters and a terminator, which must differ from
+  // the current storage: the local buffer when n is short enough.  A
+  // string that outgrows its capacity at least doubles it, so that a
+  // run of appends copies each character a bounded number of times.
+  charT *new_storage (size_type n)
+    {
+      if (n < local_size)
+	return local_buf;
+      if (n > capacity () && n < 2 * capacity ())
+	n = 2 * capacity ();
+      return Rep::create (n)->data ();
+    }
+  void install (charT *p)
+    { if (! is_local ()) rep ()->release (); dat = p; }
+  view_type view () const
+    { return view_type (dat, dat_len); }
 
 public:
   const charT* data () const
-    { return rep ()->data(); }
+    { return dat; }
   size_type length () const
-    { return rep ()->len; }
+    { return dat_len; }
   size_type size () const
-    { return rep ()->len; }
+    { return dat_len; }
   size_type capacity () const
-    { return rep ()->res; }
+    { return (is_local () ? size_type (local_size) : rep ()->res) - 1; }
   size_type max_size () const
     { return (npos - 1)/sizeof (charT); }		// XXX
   bool empty () const
     { return size () == 0; }
+  operator view_type () const
+    { return view (); }
 
 // _lib.string.cons_ construct/copy/destroy:
   basic_string& operator= (const basic_string& str)
     {
-      if (&str != this) { rep ()->release (); dat = str.rep ()->grab (); }
+      if (&str != this)
+	{
+	  if (str.is_local ())
+	    {
+	      install (local_buf);
+	      _copy (local_buf, str.local_buf, str.dat_len);
+	    }
+	  else
+	    install (str.rep ()->grab (str.dat_len));
+	  dat_len = str.dat_len;
+	}
       return *this;
     }
 
-  explicit basic_string (): dat (nilRep.grab ()) { }
-  basic_string (const basic_string& str): dat (str.rep ()->grab ()) { }
+  explicit basic_string (): dat (local_buf), dat_len (0) { }
+  basic_string (const basic_string& str)
+    : dat (local_buf), dat_len (str.dat_len)
+    {
+      if (str.is_local ())
+	_copy (local_buf, str.local_buf, dat_len);
+      else
+	dat = str.rep ()->grab (dat_len);
+    }
   basic_string (const basic_string& str, size_type pos, size_type n = npos)
-    : dat (nilRep.grab ()) { assign (str, pos, n); }
+    : dat (local_buf), dat_len (0) { assign (str, pos, n); }
   basic_string (const charT* s, size_type n)
-    : dat (nilRep.grab ()) { assign (s, n); }
+    : dat (local_buf), dat_len (0) { assign (s, n); }
   basic_string (const charT* s)
-    : dat (nilRep.grab ()) { assign (s); }
+    : dat (local_buf), dat_len (0) { assign (s); }
   basic_string (size_type n, charT c)
-    : dat (nilRep.grab ()) { assign (n, c); }
+    : dat (local_buf), dat_len (0) { assign (n, c); }
+  explicit basic_string (view_type v)
+    : dat (local_buf), dat_len (0) { assign (v); }
 #ifdef __STL_MEMBER_TEMPLATES
   template<class InputIterator>
     basic_string(InputIterator begin, InputIterator end)
 #else
   basic_string(const_iterator begin, const_iterator end)
 #endif
-    : dat (nilRep.grab ()) { assign (begin, end); }
+    : dat (local_buf), dat_len (0) { assign (begin, end); }
 
   ~basic_string ()
-    { rep ()->release (); }
+    { if (! is_local ()) rep ()->release (); }
 
-  void swap (basic_string &s) { charT *d = dat; dat = s.dat; s.dat = d; }
+  void swap (basic_string &s);
 
   basic_string& append (const basic_string& str, size_type pos = 0,
 			size_type n = npos)
@@ -166,6 +245,8 @@ public:
     { return append (s, traits::length (s)); }
   basic_string& append (size_type n, charT c)
     { return replace (length (), 0, n, c); }
+  basic_string& append (view_type v)
+    { return append (v.data (), v.length ()); }
 #ifdef __STL_MEMBER_TEMPLATES
   template<class InputIterator>
     basic_string& append(InputIterator first, InputIterator last)
@@ -183,6 +264,8 @@ public:
     { return assign (s, traits::length (s)); }
   basic_string& assign (size_type n, charT c)
     { return replace (0, npos, n, c); }
+  basic_string& assign (view_type v)
+    { return assign (v.data (), v.length ()); }
 #ifdef __STL_MEMBER_TEMPLATES
   template<class InputIterator>
     basic_string& assign(InputIterator first, InputIterator last)
@@ -202,6 +285,8 @@ public:
     { return append (s); }
   basic_string& operator+= (charT c)
     { return append (1, c); }
+  basic_string& operator+= (view_type v)
+    { return append (v); }
 
   basic_string& insert (size_type pos1, const basic_string& str,
 			size_type pos2 = 0, size_type n = npos)
@@ -267,8 +352,9 @@ public:
 
 private:
   static charT eos () { return traits::eos (); }
-  void unique () { if (rep ()->ref > 1) alloc (length (), true); }
-  void selfish () { unique (); rep ()->selfish = true; }
+  void unique ()
+    { if (! is_local () && rep ()->count () > 1) alloc (length (), true); }
+  void selfish () { unique (); if (! is_local ()) rep ()->selfish = true; }
 
 public:
   charT operator[] (size_type pos) const
@@ -279,7 +365,7 @@ public:
     }
 
   reference operator[] (size_type pos)
-    { selfish (); return (*rep ())[pos]; }
+    { selfish (); return dat[pos]; }
 
   reference at (size_type pos)
     {
@@ -294,35 +380,56 @@ public:
 
 private:
   void terminate () const
-    { traits::assign ((*rep ())[length ()], eos ()); }
+    { traits::assign (dat[length ()], eos ()); }
 
 public:
   const charT* c_str () const
-    { if (length () == 0) return ""; terminate (); return data (); }
+    {
+      static const charT nul = charT ();
+      if (length () == 0)
+	return &nul;
+      terminate ();
+      return data ();
+    }
   void resize (size_type n, charT c);
   void resize (size_type n)
     { resize (n, eos ()); }
-  void reserve (size_type) { }
+  // Capacity only shrinks when asked: reserve (n) makes room for n
+  // characters, and shrink_to_fit gives back what the string does not
+  // use.
+  void reserve (size_type n = 0);
+  void shrink_to_fit ();
 
   size_type copy (charT* s, size_type n, size_type pos = 0) const;
 
   size_type find (const basic_string& str, size_type pos = 0) const
     { return find (str.data(), pos, str.length()); }
-  size_type find (const charT* s, size_type pos, size_type n) const;
+  size_type find (view_type v, size_type pos = 0) const
+    { return view ().find (v, pos); }
+  size_type find (const charT* s, size_type pos, size_type n) const
+    { return view ().find (s, pos, n); }
   size_type find (const charT* s, size_type pos = 0) const
     { return find (s, pos, traits::length (s)); }
-  size_type find (charT c, size_type pos = 0) const;
+  size_type find (charT c, size_type pos = 0) const
+    { return view ().find (c, pos); }
 
   size_type rfind (const basic_string& str, size_type pos = npos) const
     { return rfind (str.data(), pos, str.length()); }
-  size_type rfind (const charT* s, size_type pos, size_type n) const;
+  size_type rfind (view_type v, size_type pos = npos) const
+    { return view ().rfind (v, pos); }
+  size_type rfind (const charT* s, size_type pos, size_type n) const
+    { return view ().rfind (s, pos, n); }
   size_type rfind (const charT* s, size_type pos = npos) const
     { return rfind (s, pos, traits::length (s)); }
-  size_type rfind (charT c, size_type pos = npos) const;
+  size_type rfind (charT c, size_type pos = npos) const
+    { return view ().rfind (c, pos); }
 
   size_type find_first_of (const basic_string& str, size_type pos = 0) const
     { return find_first_of (str.data(), pos, str.length()); }
-  size_type find_first_of (const charT* s, size_type pos, size_type n) const;
+  size_type find_first_of (view_type v, size_type pos = 0) const
+    { return view ().find_first_of (v, pos); }
+  size_type find_first_of (const charT* s, size_type pos, size_type n) const
+    { return view ().find_first_of (s, pos, n); }
   size_type find_first_of (const charT* s, size_type pos = 0) const
     { return find_first_of (s, pos, traits::length (s)); }
   size_type find_first_of (charT c, size_type pos = 0) const
@@ -330,7 +437,10 @@ public:
 
   size_type find_last_of (const basic_string& str, size_type pos = npos) const
     { return find_last_of (str.data(), pos, str.length()); }
-  size_type find_last_of (const charT* s, size_type pos, size_type n) const;
+  size_type find_last_of (view_type v, size_type pos = npos) const
+    { return view ().find_last_of (v, pos); }
+  size_type find_last_of (const charT* s, size_type pos, size_type n) const
+    { return view ().find_last_of (s, pos, n); }
   size_type find_last_of (const charT* s, size_type pos = npos) const
     { return find_last_of (s, pos, traits::length (s)); }
   size_type find_last_of (charT c, size_type pos = npos) const
@@ -338,17 +448,25 @@ public:
 
   size_type find_first_not_of (const basic_string& str, size_type pos = 0) const
     { return find_first_not_of (str.data(), pos, str.length()); }
-  size_type find_first_not_of (const charT* s, size_type pos, size_type n) const;
+  size_type find_first_not_of (view_type v, size_type pos = 0) const
+    { return view ().find_first_not_of (v, pos); }
+  size_type find_first_not_of (const charT* s, size_type pos, size_type n) const
+    { return view ().find_first_not_of (s, pos, n); }
   size_type find_first_not_of (const charT* s, size_type pos = 0) const
     { return find_first_not_of (s, pos, traits::length (s)); }
-  size_type find_first_not_of (charT c, size_type pos = 0) const;
+  size_type find_first_not_of (charT c, size_type pos = 0) const
+    { return view ().find_first_not_of (c, pos); }
 
   size_type find_last_not_of (const basic_string& str, size_type pos = npos) const
     { return find_last_not_of (str.data(), pos, str.length()); }
-  size_type find_last_not_of (const charT* s, size_type pos, size_type n) const;
+  size_type find_last_not_of (view_type v, size_type pos = npos) const
+    { return view ().find_last_not_of (v, pos); }
+  size_type find_last_not_of (const charT* s, size_type pos, size_type n) const
+    { return view ().find_last_not_of (s, pos, n); }
   size_type find_last_not_of (const charT* s, size_type pos = npos) const
     { return find_last_not_of (s, pos, traits::length (s)); }
-  size_type find_last_not_of (charT c, size_type pos = npos) const;
+  size_type find_last_not_of (charT c, size_type pos = npos) const
+    { return view ().find_last_not_of (c, pos); }
 
   basic_string substr (size_type pos = 0, size_type n = npos) const
     { return basic_string (*this, pos, n); }
@@ -358,13 +476,15 @@ public:
   int compare (const charT* s, size_type pos, size_type n) const;
   int compare (const charT* s, size_type pos = 0) const
     { return compare (s, pos, traits::length (s)); }
+  int compare (view_type v) const
+    { return view ().compare (v); }
 
   iterator begin () { selfish (); return &(*this)[0]; }
   iterator end () { selfish (); return &(*this)[length ()]; }
 
 private:
-  iterator ibegin () const { return &(*rep ())[0]; }
-  iterator iend () const { return &(*rep ())[length ()]; }
+  iterator ibegin () const { return dat; }
+  iterator iend () const { return dat + length (); }
 
 public:
   const_iterator begin () const { return ibegin (); }
@@ -379,11 +499,13 @@ public:
 
 private:
   void alloc (size_type size, bool save);
-  static size_type _find (const charT* ptr, charT c, size_type xpos, size_type len);
   inline bool check_realloc (size_type s) const;
+  inline static void _copy (charT *, const charT *, size_type);
+  inline static void _move (charT *, const charT *, size_type);
 
-  static Rep nilRep;
   charT *dat;
+  size_type dat_len;
+  charT local_buf[local_size];
 };
 
 #ifdef __STL_MEMBER_TEMPLATES
@@ -409,20 +531,20 @@ replace (iterator i1, iterator i2, const_iterator j1, const_iterator j2)
 
   if (check_realloc (newlen))
     {
-      Rep *p = Rep::create (newlen);
-      p->copy (0, data (), pos);
-      p->copy (pos + n2, data () + pos + n1, len - (pos + n1));
+      charT *p = new_storage (newlen);
+      _copy (p, data (), pos);
+      _copy (p + pos + n2, data () + pos + n1, len - (pos + n1));
       for (; j1 != j2; ++j1, ++pos)
-	traits::assign ((*p)[pos], *j1);
-      repup (p);
+	traits::assign (p[pos], *j1);
+      install (p);
     }
   else
     {
-      rep ()->move (pos + n2, data () + pos + n1, len - (pos + n1));
+      _move (dat + pos + n2, data () + pos + n1, len - (pos + n1));
       for (; j1 != j2; ++j1, ++pos)
-	traits::assign ((*rep ())[pos], *j1);
+	traits::assign (dat[pos], *j1);
     }
-  rep ()->len = newlen;
+  dat_len = newlen;
 
   return *this;
 }
@@ -605,13 +727,154 @@ operator>= (const basic_string <charT, traits, Allocator>& lhs,
   return (lhs.compare (rhs) >= 0);
 }
 
+// Comparisons with views, so that equal_to<void> and less<void> can
+// look up a string key by a view.
+template <class charT, class traits, class Allocator>
+inline bool
+operator== (const basic_string <charT, traits, Allocator>& lhs,
+	    basic_string_view <charT, traits> rhs)
+{
+  return (basic_string_view <charT, traits> (lhs) == rhs);
+}
+
+template <class charT, class traits, class Allocator>
+inline bool
+operator== (basic_string_view <charT, traits> lhs,
+	    const basic_string <charT, traits, Allocator>& rhs)
+{
+  return (lhs == basic_string_view <charT, traits> (rhs));
+}
+
+template <class charT, class traits, class Allocator>
+inline bool
+operator!= (const basic_string <charT, traits, Allocator>& lhs,
+	    basic_string_view <charT, traits> rhs)
+{
+  return (basic_string_view <charT, traits> (lhs) != rhs);
+}
+
+template <class charT, class traits, class Allocator>
+inline bool
+operator!= (basic_string_view <charT, traits> lhs,
+	    const basic_string <charT, traits, Allocator>& rhs)
+{
+  return (lhs != basic_string_view <charT, traits> (rhs));
+}
+
+template <class charT, class traits, class Allocator>
+inline bool
+operator< (const basic_string <charT, traits, Allocator>& lhs,
+	   basic_string_view <charT, traits> rhs)
+{
+  return (basic_string_view <charT, traits> (lhs) < rhs);
+}
+
+template <class charT, class traits, class Allocator>
+inline bool
+operator< (basic_string_view <charT, traits> lhs,
+	   const basic_string <charT, traits, Allocator>& rhs)
+{
+  return (lhs < basic_string_view <charT, traits> (rhs));
+}
+
+template <class charT, class traits, class Allocator>
+inline bool
+operator> (const basic_string <charT, traits, Allocator>& lhs,
+	   basic_string_view <charT, traits> rhs)
+{
+  return (basic_string_view <charT, traits> (lhs) > rhs);
+}
+
+template <class charT, class traits, class Allocator>
+inline bool
+operator> (basic_string_view <charT, traits> lhs,
+	   const basic_string <charT, traits, Allocator>& rhs)
+{
+  return (lhs > basic_string_view <charT, traits> (rhs));
+}
+
+template <class charT, class traits, class Allocator>
+inline bool
+operator<= (const basic_string <charT, traits, Allocator>& lhs,
+	    basic_string_view <charT, traits> rhs)
+{
+  return (basic_string_view <charT, traits> (lhs) <= rhs);
+}
+
+template <class charT, class traits, class Allocator>
+inline bool
+operator<= (basic_string_view <charT, traits> lhs,
+	    const basic_string <charT, traits, Allocator>& rhs)
+{
+  return (lhs <= basic_string_view <charT, traits> (rhs));
+}
+
+template <class charT, class traits, class Allocator>
+inline bool
+operator>= (const basic_string <charT, traits, Allocator>& lhs,
+	    basic_string_view <charT, traits> rhs)
+{
+  return (basic_string_view <charT, traits> (lhs) >= rhs);
+}
+
+template <class charT, class traits, class Allocator>
+inline bool
+operator>= (basic_string_view <charT, traits> lhs,
+	    const basic_string <charT, traits, Allocator>& rhs)
+{
+  return (lhs >= basic_string_view <charT, traits> (rhs));
+}
+
 class istream; class ostream;
 template <class charT, class traits, class Allocator> istream&
 operator>> (istream&, basic_string <charT, traits, Allocator>&);
 template <class charT, class traits, class Allocator> ostream&
 operator<< (ostream&, const basic_string <charT, traits, Allocator>&);
 template <class charT, class traits, class Allocator> istream&
-getline (istream&, basic_string <charT, traits, Allocator>&, charT delim = '\n');
+getline (istream&, basic_string <charT, traits, Allocator>&, charT delim);
+
+// An overload rather than a default argument, since streambuf names the
+// three-argument getline as a friend before this declaration is seen.
+template <class charT, class traits, class Allocator> inline istream&
+getline (istream& is, basic_string <charT, traits, Allocator>& s)
+{
+  return getline (is, s, charT ('\n'));
+}
+
+__STL_BEGIN_NAMESPACE
+
+// The hash of a string equals the hash of its characters as a C string,
+// so a container keyed on strings may be probed with a charT* or a view
+// when its key equality is transparent as well, e.g. equal_to<void>.
+#ifdef __STL_CLASS_PARTIAL_SPECIALIZATION
+template <class charT, class traits, class Allocator>
+struct hash <basic_string <charT, traits, Allocator> >
+{
+  typedef void is_transparent;
+  size_t operator() (const basic_string <charT, traits, Allocator>& s) const
+    { return __stl_hash_string ((const char *) s.data (),
+				s.length () * sizeof (charT)); }
+  size_t operator() (basic_string_view <charT, traits> s) const
+    { return __stl_hash_string ((const char *) s.data (),
+				s.length () * sizeof (charT)); }
+  size_t operator() (const charT* s) const
+    { return __stl_hash_string ((const char *) s,
+				traits::length (s) * sizeof (charT)); }
+};
+#else
+__STL_TEMPLATE_NULL struct hash <basic_string <char> >
+{
+  typedef void is_transparent;
+  size_t operator() (const basic_string <char>& s) const
+    { return __stl_hash_string (s.data (), s.length ()); }
+  size_t operator() (basic_string_view <char> s) const
+    { return __stl_hash_string (s.data (), s.length ()); }
+  size_t operator() (const char* s) const
+    { return __stl_hash_string (s); }
+};
+#endif
+
+__STL_END_NAMESPACE
 
 } // extern "C++"
 
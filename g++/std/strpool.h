@@ -0,0 +1,329 @@
+// Interned strings for the -*- C++ -*- string classes.
+// Copyright (C) 1998 Free Software Foundation
+
+// This file is part of the GNU ANSI C++ Library.  This library is free
+// software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the
+// Free Software Foundation; either version 2, or (at your option)
+// any later version.
+
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this library; see the file COPYING.  If not, write to the Free
+// Software Foundation, 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+// As a special exception, if you link this library with files
+// compiled with a GNU compiler to produce an executable, this does not cause
+// the resulting executable to be covered by the GNU General Public License.
+// This exception does not however invalidate any other reasons why
+// the executable file might be covered by the GNU General Public License.
+
+// NOTE: This is an internal header file, included by string_pool.
+
+#ifndef __STRING_POOL_IMPL__
+#define __STRING_POOL_IMPL__
+
+extern "C++" {
+
+template <class charT, class traits, class Allocator>
+class basic_string_pool;
+
+// One string in a pool: its characters, kept as an ordinary
+// basic_string so that a long one sits in a Rep that copies may share,
+// and the hash of those characters.
+template <class charT, class traits, class Allocator>
+struct __interned_rep
+{
+  size_t hash;
+  basic_string <charT, traits, Allocator> str;
+
+  __interned_rep (size_t h, basic_string_view <charT, traits> s)
+    : hash (h), str (s) { }
+};
+
+// A handle to a string in a basic_string_pool: one pointer, which stays
+// valid as long as the pool does.  A pool holds each distinct string
+// once, so two handles from the same pool are equal exactly when they
+// point at the same place, and their hash was computed when the string
+// was interned.  The characters can not be changed through a handle.
+//
+// The default handle, and the handle of the empty string from any pool,
+// is the empty string.  Handles from different pools compare unequal
+// even when their strings do not.
+template <class charT, class traits = string_char_traits<charT>,
+	  class Allocator = alloc >
+class basic_interned_string
+{
+  typedef __interned_rep <charT, traits, Allocator> rep_type;
+  friend class basic_string_pool <charT, traits, Allocator>;
+
+public:
+  typedef	   traits		traits_type;
+  typedef typename traits::char_type	value_type;
+  typedef size_t size_type;
+  typedef const charT* const_iterator;
+  typedef basic_string <charT, traits, Allocator> string_type;
+  typedef basic_string_view <charT, traits> view_type;
+
+  basic_interned_string (): p (0) { }
+
+  const charT* data () const
+    { return p ? p->str.data () : nul (); }
+  // The pool terminates each string when it is interned.
+  const charT* c_str () const
+    { return data (); }
+  size_type length () const
+    { return p ? p->str.length () : 0; }
+  size_type size () const
+    { return length (); }
+  bool empty () const
+    { return p == 0; }
+  const_iterator begin () const { return data (); }
+  const_iterator end () const { return data () + length (); }
+
+  // The hash of the characters, equal to what hash<string_type> gives.
+  size_t hash () const
+    { return p ? p->hash : __stl_hash_string ((const char *) nul (), 0); }
+
+  operator view_type () const
+    { return view_type (data (), length ()); }
+  // A long string shares its Rep with the copy instead of being copied.
+  string_type str () const
+    { return p ? p->str : string_type (); }
+
+  bool operator== (basic_interned_string x) const
+    { return p == x.p; }
+  bool operator!= (basic_interned_string x) const
+    { return p != x.p; }
+
+private:
+  explicit basic_interned_string (const rep_type *r): p (r) { }
+  static const charT* nul ()
+    { static const charT c = charT (); return &c; }
+
+  const rep_type *p;
+};
+
+// A set of strings that may be shared by several threads, each string
+// held once and named by a basic_interned_string handle.  Like
+// concurrent_hash_map, the strings are spread over shards by the high
+// bits of their mixed hash, and each shard is a hashtable behind its
+// own readers/writer lock; a string already in the pool is found under
+// the read lock alone.
+//
+// Strings are never removed: a handle is good until the pool is
+// destroyed.
+template <class charT, class traits = string_char_traits<charT>,
+	  class Allocator = alloc >
+class basic_string_pool
+{
+public:
+  typedef basic_interned_string <charT, traits, Allocator> handle;
+  typedef basic_string_view <charT, traits> view_type;
+  typedef size_t size_type;
+
+private:
+  typedef __interned_rep <charT, traits, Allocator> rep_type;
+
+  // The tables are keyed on the hash and the characters together, so
+  // that a lookup hashes the string once, a resize not at all, and a
+  // comparison starts with the hashes.
+  struct key
+  {
+    size_t hash;
+    view_type str;
+    key (size_t h, view_type s): hash (h), str (s) { }
+  };
+  struct get_key
+  {
+    key operator() (const rep_type& r) const
+      { return key (r.hash, view_type (r.str)); }
+  };
+  struct key_hash
+  {
+    size_t operator() (const key& k) const
+      { return k.hash; }
+  };
+  struct key_equal
+  {
+    bool operator() (const key& x, const key& y) const
+      { return x.hash == y.hash && x.str == y.str; }
+  };
+  typedef hashtable <rep_type, key, key_hash, get_key, key_equal,
+		     Allocator, hash_pow2_policy> table_type;
+
+  struct shard
+  {
+    __stl_rw_lock lock;
+    table_type table;
+    explicit shard (size_type n)
+      : table (n, key_hash (), key_equal ()) { }
+  };
+  typedef simple_alloc <shard, Allocator> shard_allocator;
+  typedef simple_alloc <shard*, Allocator> shard_ptr_allocator;
+
+public:
+  explicit basic_string_pool (size_type shards_hint = 64)
+    { initialize_shards (shards_hint); }
+  ~basic_string_pool ()
+    { destroy_shards (num_shards); }
+
+  // The handle of s, adding s to the pool if it is not there yet.
+  handle intern (view_type s);
+  // Sets result to the handle of s and returns true if s is in the
+  // pool, without adding it.
+  bool find (view_type s, handle& result) const;
+
+  // size () locks one shard at a time, so under concurrent interning
+  // it is only a snapshot.
+  size_type size () const;
+  size_type shard_count () const
+    { return num_shards; }
+
+private:
+  static size_t hash_of (view_type s)
+    { return __stl_hash_string ((const char *) s.data (),
+				s.length () * sizeof (charT)); }
+  shard& shard_for (size_t h) const
+    { return *shards[__stl_hash_mix (h) >> shard_shift]; }
+
+  void initialize_shards (size_type shards_hint);
+  void destroy_shards (size_type n);
+
+  shard **shards;
+  size_type num_shards;
+  int shard_shift;
+
+  // Handles point into the shards, so a pool can not be copied.
+  basic_string_pool (const basic_string_pool&);
+  void operator= (const basic_string_pool&);
+};
+
+template <class charT, class traits, class Allocator>
+typename basic_string_pool <charT, traits, Allocator>::handle
+basic_string_pool <charT, traits, Allocator>::
+intern (view_type s)
+{
+  if (s.empty ())
+    return handle ();
+  const size_t h = hash_of (s);
+  shard& sh = shard_for (h);
+  {
+    __stl_read_guard guard (sh.lock);
+    typename table_type::const_iterator it = sh.table.find (key (h, s));
+    if (it != sh.table.end ())
+      return handle (&*it);
+  }
+  __stl_write_guard guard (sh.lock);
+  pair <typename table_type::iterator, bool> p
+    = sh.table.insert_unique (rep_type (h, s));
+  // Terminate the pooled copy now, while it is write-locked, so that
+  // c_str () through a handle never writes.
+  if (p.second)
+    (*p.first).str.c_str ();
+  return handle (&*p.first);
+}
+
+template <class charT, class traits, class Allocator>
+bool basic_string_pool <charT, traits, Allocator>::
+find (view_type s, handle& result) const
+{
+  if (s.empty ())
+    {
+      result = handle ();
+      return true;
+    }
+  const size_t h = hash_of (s);
+  shard& sh = shard_for (h);
+  __stl_read_guard guard (sh.lock);
+  typename table_type::const_iterator it = sh.table.find (key (h, s));
+  if (it == sh.table.end ())
+    return false;
+  result = handle (&*it);
+  return true;
+}
+
+template <class charT, class traits, class Allocator>
+typename basic_string_pool <charT, traits, Allocator>::size_type
+basic_string_pool <charT, traits, Allocator>::
+size () const
+{
+  size_type result = 0;
+  for (size_type i = 0; i < num_shards; ++i)
+    {
+      __stl_read_guard guard (shards[i]->lock);
+      result += shards[i]->table.size ();
+    }
+  return result;
+}
+
+// At least two shards, so that the shard index is never a shift by the
+// full width of size_t.
+template <class charT, class traits, class Allocator>
+void basic_string_pool <charT, traits, Allocator>::
+initialize_shards (size_type shards_hint)
+{
+  int bits = 1;
+  while (bits < int (sizeof (size_t) * 8 - 1)
+	 && (size_type (1) << bits) < shards_hint)
+    ++bits;
+  num_shards = size_type (1) << bits;
+  shard_shift = sizeof (size_t) * 8 - bits;
+
+  shards = shard_ptr_allocator::allocate (num_shards);
+  size_type i = 0;
+  __STL_TRY {
+    for (; i < num_shards; ++i)
+      {
+	shard *p = shard_allocator::allocate ();
+	__STL_TRY {
+	  new (p) shard (16);
+	}
+	__STL_UNWIND (shard_allocator::deallocate (p));
+	shards[i] = p;
+      }
+  }
+  __STL_UNWIND (destroy_shards (i));
+}
+
+template <class charT, class traits, class Allocator>
+void basic_string_pool <charT, traits, Allocator>::
+destroy_shards (size_type n)
+{
+  for (size_type i = 0; i < n; ++i)
+    {
+      shards[i]->~shard ();
+      shard_allocator::deallocate (shards[i]);
+    }
+  shard_ptr_allocator::deallocate (shards, num_shards);
+}
+
+__STL_BEGIN_NAMESPACE
+
+// A handle hashes to its string's hash without looking at the string,
+// so a hash_map keyed on handles hashes and compares keys in constant
+// time.
+#ifdef __STL_CLASS_PARTIAL_SPECIALIZATION
+template <class charT, class traits, class Allocator>
+struct hash <basic_interned_string <charT, traits, Allocator> >
+{
+  size_t operator() (basic_interned_string <charT, traits, Allocator> s) const
+    { return s.hash (); }
+};
+#else
+__STL_TEMPLATE_NULL struct hash <basic_interned_string <char> >
+{
+  size_t operator() (basic_interned_string <char> s) const
+    { return s.hash (); }
+};
+#endif
+
+__STL_END_NAMESPACE
+
+} // extern "C++"
+
+#endif
@@ -0,0 +1,224 @@
+// Byte searches for the -*- C++ -*- string classes.
+// Copyright (C) 1998 Free Software Foundation
+
+// This file is part of the GNU ANSI C++ Library.  This library is free
+// software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the
+// Free Software Foundation; either version 2, or (at your option)
+// any later version.
+
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this library; see the file COPYING.  If not, write to the Free
+// Software Foundation, 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+// As a special exception, if you link this library with files
+// compiled with a GNU compiler to produce an executable, this does not cause
+// the resulting executable to be covered by the GNU General Public License.
+// This exception does not however invalidate any other reasons why
+// the executable file might be covered by the GNU General Public License.
+
+// The searches that basic_string uses when its characters are compared
+// as plain bytes.  Each returns a pointer to what it found, or 0.
+
+#ifndef __STRING_SEARCH__
+#define __STRING_SEARCH__
+
+#include <cstddef>
+#include <cstring>
+#include <std/straits.h>
+
+#ifdef __STL_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+extern "C++" {
+
+// True when traits compares characters as bytes, so that the searches
+// below give the same answers as traits::eq.
+template <class traits>
+struct __string_bytewise
+{
+  enum { value = false };
+};
+
+__STL_TEMPLATE_NULL struct __string_bytewise <string_char_traits <char> >
+{
+  enum { value = true };
+};
+
+// Needles at least this long are searched for with Horspool's skip
+// table, when the text is long enough to pay for building it.
+#ifndef __STRING_HORSPOOL_MIN
+#define __STRING_HORSPOOL_MIN 32
+#endif
+
+inline int __str_lowest_bit (unsigned int mask)
+{
+#ifdef __GNUC__
+  return __builtin_ctz (mask);
+#else
+  int n = 0;
+  for (; ! (mask & 1); mask >>= 1)
+    ++n;
+  return n;
+#endif
+}
+
+inline int __str_highest_bit (unsigned int mask)
+{
+#ifdef __GNUC__
+  return 31 - __builtin_clz (mask);
+#else
+  int n = 0;
+  for (; mask >>= 1; )
+    ++n;
+  return n;
+#endif
+}
+
+// The last c among the n bytes at s.
+inline const char *
+__str_memrchr (const char *s, char c, size_t n)
+{
+#ifdef __STL_USE_SSE2
+  const __m128i v = _mm_set1_epi8 (c);
+  for (; n >= 16; n -= 16)
+    {
+      unsigned int mask = _mm_movemask_epi8
+	(_mm_cmpeq_epi8 (v, _mm_loadu_si128 ((const __m128i *) (s + n - 16))));
+      if (mask)
+	return s + n - 16 + __str_highest_bit (mask);
+    }
+#endif
+  while (n-- > 0)
+    if (s[n] == c)
+      return s + n;
+  return 0;
+}
+
+// Horspool's algorithm: on a mismatch, shift the window so that its
+// last byte lines up with the last place that byte occurs in the
+// needle.  For 0 < n <= hn.
+inline const char *
+__str_horspool (const char *h, size_t hn, const char *s, size_t n)
+{
+  size_t skip[256];
+  size_t i;
+  for (i = 0; i < 256; ++i)
+    skip[i] = n;
+  for (i = 0; i + 1 < n; ++i)
+    skip[(unsigned char) s[i]] = n - 1 - i;
+
+  const char last = s[n - 1];
+  for (i = 0; i <= hn - n; i += skip[(unsigned char) h[i + n - 1]])
+    if (h[i + n - 1] == last && memcmp (h + i, s, n - 1) == 0)
+      return h + i;
+  return 0;
+}
+
+// The first of the n bytes at s among the hn bytes at h, for
+// 0 < n <= hn.  Short needles are found by looking for their first
+// and last bytes sixteen positions at a time, and comparing the rest
+// only where both match.
+inline const char *
+__str_search (const char *h, size_t hn, const char *s, size_t n)
+{
+  if (n == 1)
+    return (const char *) memchr (h, *s, hn);
+  if (n >= __STRING_HORSPOOL_MIN && hn >= 8 * n)
+    return __str_horspool (h, hn, s, n);
+
+  const size_t starts = hn - n + 1;
+  size_t i = 0;
+#ifdef __STL_USE_SSE2
+  const __m128i first = _mm_set1_epi8 (s[0]);
+  const __m128i last = _mm_set1_epi8 (s[n - 1]);
+  for (; i + 16 <= starts; i += 16)
+    {
+      unsigned int mask = _mm_movemask_epi8 (_mm_and_si128
+	(_mm_cmpeq_epi8 (first, _mm_loadu_si128 ((const __m128i *) (h + i))),
+	 _mm_cmpeq_epi8 (last,
+			 _mm_loadu_si128 ((const __m128i *) (h + i + n - 1)))));
+      for (; mask; mask &= mask - 1)
+	{
+	  const char *p = h + i + __str_lowest_bit (mask);
+	  if (memcmp (p + 1, s + 1, n - 2) == 0)
+	    return p;
+	}
+    }
+#endif
+  while (i < starts)
+    {
+      const char *p = (const char *) memchr (h + i, s[0], starts - i);
+      if (p == 0)
+	return 0;
+      if (p[n - 1] == s[n - 1] && memcmp (p + 1, s + 1, n - 2) == 0)
+	return p;
+      i = p - h + 1;
+    }
+  return 0;
+}
+
+// The last of the n bytes at s among the hn bytes at h, for
+// 0 < n <= hn.
+inline const char *
+__str_rsearch (const char *h, size_t hn, const char *s, size_t n)
+{
+  if (n == 1)
+    return __str_memrchr (h, *s, hn);
+
+  size_t starts = hn - n + 1;
+#ifdef __STL_USE_SSE2
+  const __m128i first = _mm_set1_epi8 (s[0]);
+  const __m128i last = _mm_set1_epi8 (s[n - 1]);
+  for (; starts >= 16; starts -= 16)
+    {
+      const char *b = h + starts - 16;
+      unsigned int mask = _mm_movemask_epi8 (_mm_and_si128
+	(_mm_cmpeq_epi8 (first, _mm_loadu_si128 ((const __m128i *) b)),
+	 _mm_cmpeq_epi8 (last, _mm_loadu_si128 ((const __m128i *) (b + n - 1)))));
+      while (mask)
+	{
+	  int bit = __str_highest_bit (mask);
+	  if (memcmp (b + bit + 1, s + 1, n - 2) == 0)
+	    return b + bit;
+	  mask &= ~(1u << bit);
+	}
+    }
+#endif
+  while (starts-- > 0)
+    if (h[starts] == s[0] && h[starts + n - 1] == s[n - 1]
+	&& memcmp (h + starts + 1, s + 1, n - 2) == 0)
+      return h + starts;
+  return 0;
+}
+
+// A set of bytes as a 256-bit table, for the find_*_of family.
+struct __str_byte_set
+{
+  unsigned int bits[256 / 32];
+
+  __str_byte_set (const char *s, size_t n)
+    {
+      memset (bits, 0, sizeof (bits));
+      for (size_t i = 0; i < n; ++i)
+	{
+	  unsigned char c = s[i];
+	  bits[c >> 5] |= 1u << (c & 31);
+	}
+    }
+  bool contains (char x) const
+    {
+      unsigned char c = x;
+      return (bits[c >> 5] >> (c & 31)) & 1;
+    }
+};
+
+} // extern "C++"
+
+#endif
@@ -0,0 +1,297 @@
+// Member templates for the -*- C++ -*- string view class.
+// Copyright (C) 1998 Free Software Foundation
+
+// This file is part of the GNU ANSI C++ Library.  This library is free
+// software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the
+// Free Software Foundation; either version 2, or (at your option)
+// any later version.
+
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this library; see the file COPYING.  If not, write to the Free
+// Software Foundation, 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+// As a special exception, if you link this library with files
+// compiled with a GNU compiler to produce an executable, this does not cause
+// the resulting executable to be covered by the GNU General Public License.
+// This exception does not however invalidate any other reasons why
+// the executable file might be covered by the GNU General Public License.
+
+extern "C++" {
+template <class charT, class traits>
+basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+copy (charT* s, size_type n, size_type pos) const
+{
+  OUTOFRANGE (pos > length ());
+
+  if (n > length () - pos)
+    n = length () - pos;
+
+  traits::copy (s, data () + pos, n);
+  return n;
+}
+
+template <class charT, class traits>
+int basic_string_view <charT, traits>::
+compare (basic_string_view x) const
+{
+  size_t rlen = length () < x.length () ? length () : x.length ();
+  int r = traits::compare (data (), x.data (), rlen);
+  if (r != 0)
+    return r;
+  return length () < x.length () ? -1 : length () > x.length ();
+}
+
+template <class charT, class traits>
+basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+find (const charT* s, size_type pos, size_type n) const
+{
+  if (n == 0)
+    return pos <= length () ? pos : npos;
+  if (__string_bytewise <traits>::value)
+    {
+      if (pos >= length () || n > length () - pos)
+	return npos;
+      const char *p = __str_search ((const char *) data () + pos,
+				    length () - pos, (const char *) s, n);
+      return p ? p - (const char *) data () : npos;
+    }
+
+  size_t xpos = pos;
+  for (; xpos < length () && n <= length () - xpos; ++xpos)
+    if (traits::eq (data () [xpos], *s)
+	&& traits::compare (data () + xpos, s, n) == 0)
+      return xpos;
+  return npos;
+}
+
+template <class charT, class traits>
+inline basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+_find (const charT* ptr, charT c, size_type xpos, size_type len)
+{
+  if (__string_bytewise <traits>::value)
+    {
+      if (xpos >= len)
+	return npos;
+      const char *p = (const char *) memchr ((const char *) ptr + xpos,
+					     (char) c, len - xpos);
+      return p ? p - (const char *) ptr : npos;
+    }
+
+  for (; xpos < len; ++xpos)
+    if (traits::eq (ptr [xpos], c))
+      return xpos;
+  return npos;
+}
+
+template <class charT, class traits>
+basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+find (charT c, size_type pos) const
+{
+  return _find (data (), c, pos, length ());
+}
+
+template <class charT, class traits>
+basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+rfind (const charT* s, size_type pos, size_type n) const
+{
+  if (n > length ())
+    return npos;
+
+  size_t xpos = length () - n;
+  if (xpos > pos)
+    xpos = pos;
+
+  if (n == 0)
+    return xpos;
+  if (__string_bytewise <traits>::value)
+    {
+      const char *p = __str_rsearch ((const char *) data (), xpos + n,
+				     (const char *) s, n);
+      return p ? p - (const char *) data () : npos;
+    }
+
+  for (++xpos; xpos-- > 0; )
+    if (traits::eq (data () [xpos], *s)
+	&& traits::compare (data () + xpos, s, n) == 0)
+      return xpos;
+  return npos;
+}
+
+template <class charT, class traits>
+basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+rfind (charT c, size_type pos) const
+{
+  if (1 > length ())
+    return npos;
+
+  size_t xpos = length () - 1;
+  if (xpos > pos)
+    xpos = pos;
+
+  if (__string_bytewise <traits>::value)
+    {
+      const char *p = __str_memrchr ((const char *) data (),
+				     (char) c, xpos + 1);
+      return p ? p - (const char *) data () : npos;
+    }
+
+  for (++xpos; xpos-- > 0; )
+    if (traits::eq (data () [xpos], c))
+      return xpos;
+  return npos;
+}
+
+template <class charT, class traits>
+basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+find_first_of (const charT* s, size_type pos, size_type n) const
+{
+  if (n == 1)
+    return find (*s, pos);
+  size_t xpos = pos;
+  if (__string_bytewise <traits>::value)
+    {
+      const __str_byte_set set ((const char *) s, n);
+      const char *p = (const char *) data ();
+      for (; xpos < length (); ++xpos)
+	if (set.contains (p[xpos]))
+	  return xpos;
+      return npos;
+    }
+  for (; xpos < length (); ++xpos)
+    if (_find (s, data () [xpos], 0, n) != npos)
+      return xpos;
+  return npos;
+}
+
+template <class charT, class traits>
+basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+find_last_of (const charT* s, size_type pos, size_type n) const
+{
+  if (n == 1)
+    return rfind (*s, pos);
+  if (length() == 0)
+    return npos;
+  size_t xpos = length () - 1;
+  if (xpos > pos)
+    xpos = pos;
+  if (__string_bytewise <traits>::value)
+    {
+      const __str_byte_set set ((const char *) s, n);
+      const char *p = (const char *) data ();
+      for (++xpos; xpos-- > 0;)
+	if (set.contains (p[xpos]))
+	  return xpos;
+      return npos;
+    }
+  for (++xpos; xpos-- > 0;)
+    if (_find (s, data () [xpos], 0, n) != npos)
+      return xpos;
+  return npos;
+}
+
+template <class charT, class traits>
+basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+find_first_not_of (const charT* s, size_type pos, size_type n) const
+{
+  if (n == 1)
+    return find_first_not_of (*s, pos);
+  size_t xpos = pos;
+  if (__string_bytewise <traits>::value)
+    {
+      const __str_byte_set set ((const char *) s, n);
+      const char *p = (const char *) data ();
+      for (; xpos < length (); ++xpos)
+	if (! set.contains (p[xpos]))
+	  return xpos;
+      return npos;
+    }
+  for (; xpos < length (); ++xpos)
+    if (_find (s, data () [xpos], 0, n) == npos)
+      return xpos;
+  return npos;
+}
+
+template <class charT, class traits>
+basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+find_first_not_of (charT c, size_type pos) const
+{
+  size_t xpos = pos;
+  for (; xpos < length (); ++xpos)
+    if (traits::ne (data () [xpos], c))
+      return xpos;
+  return npos;
+}
+
+template <class charT, class traits>
+basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+find_last_not_of (const charT* s, size_type pos, size_type n) const
+{
+  if (n == 1)
+    return find_last_not_of (*s, pos);
+  if (length() == 0)
+    return npos;
+  size_t xpos = length () - 1;
+  if (xpos > pos)
+    xpos = pos;
+  if (__string_bytewise <traits>::value)
+    {
+      const __str_byte_set set ((const char *) s, n);
+      const char *p = (const char *) data ();
+      for (++xpos; xpos-- > 0;)
+	if (! set.contains (p[xpos]))
+	  return xpos;
+      return npos;
+    }
+  for (++xpos; xpos-- > 0;)
+    if (_find (s, data () [xpos], 0, n) == npos)
+      return xpos;
+  return npos;
+}
+
+template <class charT, class traits>
+basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::
+find_last_not_of (charT c, size_type pos) const
+{
+  if (length() == 0)
+    return npos;
+  size_t xpos = length () - 1;
+  if (xpos > pos)
+    xpos = pos;
+  for (++xpos; xpos-- > 0;)
+    if (traits::ne (data () [xpos], c))
+      return xpos;
+  return npos;
+}
+
+#include <iostream.h>
+
+template <class charT, class traits>
+ostream &
+operator<< (ostream &o, basic_string_view <charT, traits> s)
+{
+  return o.write (s.data (), s.length ());
+}
+
+template <class charT, class traits>
+const basic_string_view <charT, traits>::size_type
+basic_string_view <charT, traits>::npos;
+
+} // extern "C++"
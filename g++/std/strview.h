@@ -0,0 +1,339 @@
+// Main templates for the -*- C++ -*- string view class.
+// Copyright (C) 1998 Free Software Foundation
+
+// This file is part of the GNU ANSI C++ Library.  This library is free
+// software; you can redistribute it and/or modify it under the
+// terms of the GNU General Public License as published by the
+// Free Software Foundation; either version 2, or (at your option)
+// any later version.
+
+// This library is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with this library; see the file COPYING.  If not, write to the Free
+// Software Foundation, 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+
+// As a special exception, if you link this library with files
+// compiled with a GNU compiler to produce an executable, this does not cause
+// the resulting executable to be covered by the GNU General Public License.
+// This exception does not however invalidate any other reasons why
+// the executable file might be covered by the GNU General Public License.
+
+// NOTE: This is an internal header file, included by std/bastring.h.
+
+#ifndef __STRING_VIEW__
+#define __STRING_VIEW__
+
+#include <std/strsearch.h>
+
+extern "C++" {
+
+// A range of characters owned by somebody else: a pointer and a length.
+// Copying a view or taking its substr copies no characters, so a buffer
+// may be cut into views without allocating.  The characters must
+// outlive the view, and a view of a basic_string is invalidated by
+// anything that would invalidate the string's iterators.
+//
+// basic_string converts to a view implicitly, and forwards its searches
+// here, so the two always find the same things.
+template <class charT, class traits = string_char_traits<charT> >
+class basic_string_view
+{
+public:
+  typedef	   traits		traits_type;
+  typedef typename traits::char_type	value_type;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+  typedef const charT& reference;
+  typedef const charT& const_reference;
+  typedef const charT* pointer;
+  typedef const charT* const_pointer;
+  typedef const_pointer iterator;
+  typedef const_pointer const_iterator;
+  typedef ::reverse_iterator<const_iterator> reverse_iterator;
+  typedef ::reverse_iterator<const_iterator> const_reverse_iterator;
+  static const size_type npos = static_cast<size_type>(-1);
+
+  basic_string_view (): dat (0), dat_len (0) { }
+  basic_string_view (const charT* s, size_type n): dat (s), dat_len (n) { }
+  basic_string_view (const charT* s): dat (s), dat_len (traits::length (s)) { }
+
+  const charT* data () const
+    { return dat; }
+  size_type length () const
+    { return dat_len; }
+  size_type size () const
+    { return dat_len; }
+  size_type max_size () const
+    { return (npos - 1)/sizeof (charT); }
+  bool empty () const
+    { return dat_len == 0; }
+
+  const_iterator begin () const { return dat; }
+  const_iterator end () const { return dat + dat_len; }
+  const_reverse_iterator rbegin () const
+    { return const_reverse_iterator (end ()); }
+  const_reverse_iterator rend () const
+    { return const_reverse_iterator (begin ()); }
+
+  const_reference operator[] (size_type pos) const
+    { return dat[pos]; }
+  const_reference at (size_type pos) const
+    {
+      OUTOFRANGE (pos >= length ());
+      return dat[pos];
+    }
+  const_reference front () const
+    { return dat[0]; }
+  const_reference back () const
+    { return dat[dat_len - 1]; }
+
+  void remove_prefix (size_type n)
+    { dat += n; dat_len -= n; }
+  void remove_suffix (size_type n)
+    { dat_len -= n; }
+  void swap (basic_string_view& x)
+    {
+      const charT *d = dat; dat = x.dat; x.dat = d;
+      size_type l = dat_len; dat_len = x.dat_len; x.dat_len = l;
+    }
+
+  size_type copy (charT* s, size_type n, size_type pos = 0) const;
+  basic_string_view substr (size_type pos = 0, size_type n = npos) const
+    {
+      OUTOFRANGE (pos > length ());
+      if (n > length () - pos)
+	n = length () - pos;
+      return basic_string_view (dat + pos, n);
+    }
+
+  int compare (basic_string_view x) const;
+  int compare (size_type pos, size_type n, basic_string_view x) const
+    { return substr (pos, n).compare (x); }
+  int compare (const charT* s) const
+    { return compare (basic_string_view (s)); }
+
+  size_type find (basic_string_view x, size_type pos = 0) const
+    { return find (x.data (), pos, x.length ()); }
+  size_type find (const charT* s, size_type pos, size_type n) const;
+  size_type find (const charT* s, size_type pos = 0) const
+    { return find (s, pos, traits::length (s)); }
+  size_type find (charT c, size_type pos = 0) const;
+
+  size_type rfind (basic_string_view x, size_type pos = npos) const
+    { return rfind (x.data (), pos, x.length ()); }
+  size_type rfind (const charT* s, size_type pos, size_type n) const;
+  size_type rfind (const charT* s, size_type pos = npos) const
+    { return rfind (s, pos, traits::length (s)); }
+  size_type rfind (charT c, size_type pos = npos) const;
+
+  size_type find_first_of (basic_string_view x, size_type pos = 0) const
+    { return find_first_of (x.data (), pos, x.length ()); }
+  size_type find_first_of (const charT* s, size_type pos, size_type n) const;
+  size_type find_first_of (const charT* s, size_type pos = 0) const
+    { return find_first_of (s, pos, traits::length (s)); }
+  size_type find_first_of (charT c, size_type pos = 0) const
+    { return find (c, pos); }
+
+  size_type find_last_of (basic_string_view x, size_type pos = npos) const
+    { return find_last_of (x.data (), pos, x.length ()); }
+  size_type find_last_of (const charT* s, size_type pos, size_type n) const;
+  size_type find_last_of (const charT* s, size_type pos = npos) const
+    { return find_last_of (s, pos, traits::length (s)); }
+  size_type find_last_of (charT c, size_type pos = npos) const
+    { return rfind (c, pos); }
+
+  size_type find_first_not_of (basic_string_view x, size_type pos = 0) const
+    { return find_first_not_of (x.data (), pos, x.length ()); }
+  size_type find_first_not_of (const charT* s, size_type pos, size_type n) const;
+  size_type find_first_not_of (const charT* s, size_type pos = 0) const
+    { return find_first_not_of (s, pos, traits::length (s)); }
+  size_type find_first_not_of (charT c, size_type pos = 0) const;
+
+  size_type find_last_not_of (basic_string_view x, size_type pos = npos) const
+    { return find_last_not_of (x.data (), pos, x.length ()); }
+  size_type find_last_not_of (const charT* s, size_type pos, size_type n) const;
+  size_type find_last_not_of (const charT* s, size_type pos = npos) const
+    { return find_last_not_of (s, pos, traits::length (s)); }
+  size_type find_last_not_of (charT c, size_type pos = npos) const;
+
+private:
+  static size_type _find (const charT* ptr, charT c, size_type xpos, size_type len);
+
+  const charT *dat;
+  size_type dat_len;
+};
+
+template <class charT, class traits>
+inline bool
+operator== (basic_string_view <charT, traits> lhs,
+	    basic_string_view <charT, traits> rhs)
+{
+  return (lhs.length () == rhs.length () && lhs.compare (rhs) == 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator== (const charT* lhs, basic_string_view <charT, traits> rhs)
+{
+  return (rhs.compare (lhs) == 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator== (basic_string_view <charT, traits> lhs, const charT* rhs)
+{
+  return (lhs.compare (rhs) == 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator!= (basic_string_view <charT, traits> lhs,
+	    basic_string_view <charT, traits> rhs)
+{
+  return ! (lhs == rhs);
+}
+
+template <class charT, class traits>
+inline bool
+operator!= (const charT* lhs, basic_string_view <charT, traits> rhs)
+{
+  return (rhs.compare (lhs) != 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator!= (basic_string_view <charT, traits> lhs, const charT* rhs)
+{
+  return (lhs.compare (rhs) != 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator< (basic_string_view <charT, traits> lhs,
+	   basic_string_view <charT, traits> rhs)
+{
+  return (lhs.compare (rhs) < 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator< (const charT* lhs, basic_string_view <charT, traits> rhs)
+{
+  return (rhs.compare (lhs) > 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator< (basic_string_view <charT, traits> lhs, const charT* rhs)
+{
+  return (lhs.compare (rhs) < 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator> (basic_string_view <charT, traits> lhs,
+	   basic_string_view <charT, traits> rhs)
+{
+  return (lhs.compare (rhs) > 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator> (const charT* lhs, basic_string_view <charT, traits> rhs)
+{
+  return (rhs.compare (lhs) < 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator> (basic_string_view <charT, traits> lhs, const charT* rhs)
+{
+  return (lhs.compare (rhs) > 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator<= (basic_string_view <charT, traits> lhs,
+	    basic_string_view <charT, traits> rhs)
+{
+  return (lhs.compare (rhs) <= 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator<= (const charT* lhs, basic_string_view <charT, traits> rhs)
+{
+  return (rhs.compare (lhs) >= 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator<= (basic_string_view <charT, traits> lhs, const charT* rhs)
+{
+  return (lhs.compare (rhs) <= 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator>= (basic_string_view <charT, traits> lhs,
+	    basic_string_view <charT, traits> rhs)
+{
+  return (lhs.compare (rhs) >= 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator>= (const charT* lhs, basic_string_view <charT, traits> rhs)
+{
+  return (rhs.compare (lhs) <= 0);
+}
+
+template <class charT, class traits>
+inline bool
+operator>= (basic_string_view <charT, traits> lhs, const charT* rhs)
+{
+  return (lhs.compare (rhs) >= 0);
+}
+
+class ostream;
+template <class charT, class traits> ostream&
+operator<< (ostream&, basic_string_view <charT, traits>);
+
+__STL_BEGIN_NAMESPACE
+
+// Views hash like strings, so either may probe a container keyed on the
+// other when its key equality is transparent, e.g. equal_to<void>.
+#ifdef __STL_CLASS_PARTIAL_SPECIALIZATION
+template <class charT, class traits>
+struct hash <basic_string_view <charT, traits> >
+{
+  typedef void is_transparent;
+  size_t operator() (basic_string_view <charT, traits> s) const
+    { return __stl_hash_string ((const char *) s.data (),
+				s.length () * sizeof (charT)); }
+  size_t operator() (const charT* s) const
+    { return __stl_hash_string ((const char *) s,
+				traits::length (s) * sizeof (charT)); }
+};
+#else
+__STL_TEMPLATE_NULL struct hash <basic_string_view <char> >
+{
+  typedef void is_transparent;
+  size_t operator() (basic_string_view <char> s) const
+    { return __stl_hash_string (s.data (), s.length ()); }
+  size_t operator() (const char* s) const
+    { return __stl_hash_string (s); }
+};
+#endif
+
+__STL_END_NAMESPACE
+
+} // extern "C++"
+
+#include <std/strview.cc>
+
+#endif
@@ -32,6 +32,10 @@
 #define __SGI_STL_INTERNAL_ALGO_H
 
 #include <stl_heap.h>
+#include <stl_threads.h>
+#ifdef __STL_EXCEPTION_PTR
+#include <exception>
+#endif
 
 __STL_BEGIN_NAMESPACE
 
@@ -1062,6 +1066,258 @@ inline void sort(RandomAccessIterator first, RandomAccessIterator last,
   }
 }
 
+// Parallel sort.  sort(parallel_policy(n), first, last) sorts like
+// sort(first, last) on up to n threads: 0 asks for one per processor,
+// and n is capped at the number of processors.  The policy is a type of
+// its own so that the overloads cannot be mistaken for sort(first,
+// last, comp).
+//
+// Each thread keeps a stack of ranges still to be sorted.  A thread
+// partitions a range with the same median-of-three __unguarded_partition
+// as __introsort_loop, pushes the upper part, and goes on with the lower
+// part, until what is left is at most __stl_parallel_sort_grain elements;
+// that it sorts with __introsort_loop and __final_insertion_sort.  It
+// then pops its newest range, and a thread whose stack is empty steals
+// the oldest, and so largest, range of another; a thread with nothing
+// to take sleeps until a range is pushed or the sort is over.  The
+// introsort depth limit is carried with each range, so the worst case
+// stays N log N.  The first partitions run on one thread, which bounds
+// the speedup by about lg(N) / 2.
+//
+// If comp throws, the threads stop taking ranges, and once all have
+// finished the exception is rethrown on the calling thread, leaving the
+// range in some order, as with sort.  Carrying the exception across
+// threads needs std::exception_ptr (see __STL_EXCEPTION_PTR).  Without
+// it, and unlike sort, the whole range is sorted again on the calling
+// thread instead: the exception reaches the caller only if comp throws
+// again, and otherwise the range ends up sorted.
+
+struct parallel_policy {
+  size_t n_threads;
+  explicit parallel_policy(size_t n = 0) : n_threads(n) {}
+};
+
+// Each range a thread sorts by itself should be big enough that taking
+// it from the shared stacks costs little next to sorting it.
+static const size_t __stl_parallel_sort_grain = 32768;
+
+template <class T>
+struct __stl_less_than {
+  bool operator()(const T& x, const T& y) const { return x < y; }
+};
+
+template <class RandomAccessIterator, class Compare>
+struct __parallel_sort_pool {
+  struct range {
+    RandomAccessIterator first, last;
+    int depth_limit;
+  };
+
+  // One monitor guards every stack.  Thread t's stack is
+  // stacks[t * depth, t * depth + top[t]), and bottom[t] is the oldest
+  // entry that has not been stolen.  A thread pushes ranges of strictly
+  // increasing depth above whatever it popped, so no stack holds more
+  // than depth entries.
+  __stl_monitor monitor;
+  range* stacks;
+  size_t* top;
+  size_t* bottom;
+  size_t depth;
+  size_t n_threads;
+  size_t pending;                       // Ranges pushed and not yet sorted.
+  bool aborted;
+#ifdef __STL_EXCEPTION_PTR
+  std::exception_ptr error;             // The first exception thrown.
+#endif
+  Compare comp;
+
+  __parallel_sort_pool(Compare c) : comp(c) {}
+
+  void push(size_t t, const range& r)
+  {
+    __stl_monitor_guard guard(monitor);
+    stacks[t * depth + top[t]++] = r;
+    ++pending;
+    monitor.notify_one();
+  }
+
+  // Pops thread t's newest range, or steals another thread's oldest,
+  // waiting while there is neither.  Returns false once the sort is
+  // over.
+  bool take(size_t t, range& r)
+  {
+    __stl_monitor_guard guard(monitor);
+    for (;;) {
+      if (aborted || pending == 0)
+        return false;
+      if (top[t] > bottom[t]) {
+        r = stacks[t * depth + --top[t]];
+        if (top[t] == bottom[t])
+          top[t] = bottom[t] = 0;
+        return true;
+      }
+      for (size_t i = 1; i < n_threads; ++i) {
+        const size_t v = (t + i) % n_threads;
+        if (top[v] > bottom[v]) {
+          r = stacks[v * depth + bottom[v]++];
+          if (top[v] == bottom[v])
+            top[v] = bottom[v] = 0;
+          return true;
+        }
+      }
+      monitor.wait();
+    }
+  }
+
+  void finish()
+  {
+    __stl_monitor_guard guard(monitor);
+    if (--pending == 0)
+      monitor.notify_all();
+  }
+
+  void abort()
+  {
+    __stl_monitor_guard guard(monitor);
+    aborted = true;
+    monitor.notify_all();
+  }
+
+#ifdef __STL_EXCEPTION_PTR
+  void abort(std::exception_ptr e)
+  {
+    __stl_monitor_guard guard(monitor);
+    if (!error)
+      error = e;
+    aborted = true;
+    monitor.notify_all();
+  }
+#endif
+};
+
+template <class RandomAccessIterator, class Compare, class T>
+void __parallel_sort_range(__parallel_sort_pool<RandomAccessIterator,
+                                                Compare>& pool,
+                           size_t t, RandomAccessIterator first,
+                           RandomAccessIterator last, int depth_limit, T*)
+{
+  typedef typename __parallel_sort_pool<RandomAccessIterator,
+                                        Compare>::range range;
+  Compare comp = pool.comp;
+  while (size_t(last - first) > __stl_parallel_sort_grain) {
+    if (depth_limit == 0) {
+      partial_sort(first, last, last, comp);
+      return;
+    }
+    --depth_limit;
+    RandomAccessIterator cut = __unguarded_partition
+      (first, last, T(__median(*first, *(first + (last - first)/2),
+                               *(last - 1), comp)), comp);
+    range r;
+    r.first = cut;
+    r.last = last;
+    r.depth_limit = depth_limit;
+    pool.push(t, r);
+    last = cut;
+  }
+  __introsort_loop(first, last, (T*) 0, depth_limit, comp);
+  __final_insertion_sort(first, last, comp);
+}
+
+template <class RandomAccessIterator, class Compare>
+void __parallel_sort_task(void* p, size_t t)
+{
+  __parallel_sort_pool<RandomAccessIterator, Compare>& pool =
+    *(__parallel_sort_pool<RandomAccessIterator, Compare>*) p;
+  typename __parallel_sort_pool<RandomAccessIterator, Compare>::range r;
+  while (pool.take(t, r)) {
+#ifdef __STL_EXCEPTION_PTR
+    try {
+      __parallel_sort_range(pool, t, r.first, r.last, r.depth_limit,
+                            value_type(r.first));
+    }
+    catch (...) {
+      pool.abort(std::current_exception());
+      return;
+    }
+#else
+    __STL_TRY {
+      __parallel_sort_range(pool, t, r.first, r.last, r.depth_limit,
+                            value_type(r.first));
+    }
+    __STL_UNWIND(pool.abort());
+#endif
+    pool.finish();
+  }
+}
+
+template <class RandomAccessIterator, class Compare>
+void sort(parallel_policy policy, RandomAccessIterator first,
+          RandomAccessIterator last, Compare comp)
+{
+  const size_t n = last - first;
+  size_t n_threads = policy.n_threads;
+  const size_t cpus = __stl_processor_count();
+  if (n_threads == 0 || (cpus != 0 && n_threads > cpus))
+    n_threads = cpus;
+  if (n_threads > n / __stl_parallel_sort_grain)
+    n_threads = n / __stl_parallel_sort_grain;
+  if (n_threads <= 1) {
+    sort(first, last, comp);
+    return;
+  }
+
+  typedef __parallel_sort_pool<RandomAccessIterator, Compare> pool_type;
+  pool_type pool(comp);
+  pool.depth = __lg(n) * 2 + 1;
+  pool.n_threads = n_threads;
+  pool.stacks = new typename pool_type::range[n_threads * pool.depth];
+  __STL_TRY {
+    pool.top = new size_t[2 * n_threads];
+  }
+  __STL_UNWIND(delete [] pool.stacks);
+  pool.bottom = pool.top + n_threads;
+  fill(pool.top, pool.top + 2 * n_threads, size_t(0));
+  pool.pending = 0;
+  pool.aborted = false;
+
+  typename pool_type::range all;
+  all.first = first;
+  all.last = last;
+  all.depth_limit = int(pool.depth) - 1;
+  pool.push(0, all);
+
+  __STL_TRY {
+    __stl_run_tasks(n_threads, &__parallel_sort_task<RandomAccessIterator,
+                                                     Compare>, &pool);
+  }
+  __STL_UNWIND(delete [] pool.top; delete [] pool.stacks);
+  delete [] pool.top;
+  delete [] pool.stacks;
+#ifdef __STL_EXCEPTION_PTR
+  if (pool.error)
+    std::rethrow_exception(pool.error);
+#else
+  if (pool.aborted)
+    sort(first, last, comp);
+#endif
+}
+
+template <class RandomAccessIterator, class T>
+inline void __parallel_sort_aux(parallel_policy policy,
+                                RandomAccessIterator first,
+                                RandomAccessIterator last, T*)
+{
+  sort(policy, first, last, __stl_less_than<T>());
+}
+
+template <class RandomAccessIterator>
+inline void sort(parallel_policy policy, RandomAccessIterator first,
+                 RandomAccessIterator last)
+{
+  __parallel_sort_aux(policy, first, last, value_type(first));
+}
+
 
 template <class RandomAccessIterator>
 void __inplace_stable_sort(RandomAccessIterator first,
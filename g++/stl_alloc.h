@@ -871,6 +871,22 @@ static alloc __node_allocator_dummy_instance;
 
 #endif /* ! __USE_MALLOC */
 
+// An object whose allocator is an instance of the node allocator
+// without thread support, such as single_client_alloc, may only be
+// used by one thread at a time.  The reference-counted containers
+// update its counts without atomic instructions or locks.
+template <class Alloc>
+struct __alloc_single_client {
+    enum { value = false };
+};
+
+#if defined(__STL_CLASS_PARTIAL_SPECIALIZATION) && !defined(__USE_MALLOC)
+template <int inst>
+struct __alloc_single_client<__default_alloc_template<false, inst> > {
+    enum { value = true };
+};
+#endif
+
 #if defined(__sgi) && !defined(__GNUC__) && (_MIPS_SIM != _MIPS_SIM_ABI32)
 #pragma reset woff 1174
 #endif
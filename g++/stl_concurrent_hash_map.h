@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 1996
+ * Silicon Graphics Computer Systems, Inc.
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Silicon Graphics makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ *
+ * Copyright (c) 1994
+ * Hewlett-Packard Company
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Hewlett-Packard Company makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ */
+
+/* NOTE: This is an internal header file, included by other STL headers.
+ *   You should not attempt to use it directly.
+ */
+
+#ifndef __SGI_STL_INTERNAL_CONCURRENT_HASH_MAP_H
+#define __SGI_STL_INTERNAL_CONCURRENT_HASH_MAP_H
+
+#include <stl_threads.h>
+
+__STL_BEGIN_NAMESPACE
+
+#if defined(__sgi) && !defined(__GNUC__) && (_MIPS_SIM != _MIPS_SIM_ABI32)
+#pragma set woff 1174
+#endif
+
+// A hash map that may be used from several threads at once.  Elements
+// are spread over a power-of-two number of shards by the high bits of
+// the mixed hash code; each shard is a hashtable behind its own
+// readers/writer lock, so threads that touch different shards do not
+// contend.
+//
+// There are no iterators and no references into the map, since either
+// could outlive the lock that protects the element.  Lookups copy the
+// mapped value out instead, and the visitor functions call a functor on
+// an element while its shard is locked.  A visitor must not call back
+// into the same map.
+
+#ifndef __STL_LIMITED_DEFAULT_TEMPLATES
+template <class Key, class T, class HashFcn = hash<Key>,
+          class EqualKey = equal_to<Key>,
+          class Alloc = alloc,
+          class Policy = hash_prime_policy>
+#else
+template <class Key, class T, class HashFcn, class EqualKey,
+          class Alloc = alloc, class Policy = hash_prime_policy>
+#endif
+class concurrent_hash_map
+{
+private:
+  typedef hashtable<pair<const Key, T>, Key, HashFcn,
+                    select1st<pair<const Key, T> >, EqualKey, Alloc,
+                    Policy> ht;
+
+public:
+  typedef typename ht::key_type key_type;
+  typedef T data_type;
+  typedef T mapped_type;
+  typedef typename ht::value_type value_type;
+  typedef typename ht::hasher hasher;
+  typedef typename ht::key_equal key_equal;
+
+  typedef typename ht::size_type size_type;
+  typedef typename ht::difference_type difference_type;
+
+private:
+  struct shard {
+    __stl_rw_lock lock;
+    ht table;
+    shard(size_type n, const hasher& hf, const key_equal& eql)
+      : table(n, hf, eql) {}
+  };
+  typedef simple_alloc<shard, Alloc> shard_allocator;
+  typedef simple_alloc<shard*, Alloc> shard_ptr_allocator;
+
+  hasher hash;
+  shard** shards;
+  size_type num_shards;
+  int shard_shift;
+
+public:
+  hasher hash_funct() const { return hash; }
+  key_equal key_eq() const { return shards[0]->table.key_eq(); }
+
+public:
+  concurrent_hash_map() : hash(hasher())
+    { initialize_shards(64, 100, key_equal()); }
+  explicit concurrent_hash_map(size_type shards_hint) : hash(hasher())
+    { initialize_shards(shards_hint, 100, key_equal()); }
+  concurrent_hash_map(size_type shards_hint, size_type n) : hash(hasher())
+    { initialize_shards(shards_hint, n, key_equal()); }
+  concurrent_hash_map(size_type shards_hint, size_type n, const hasher& hf)
+    : hash(hf) { initialize_shards(shards_hint, n, key_equal()); }
+  concurrent_hash_map(size_type shards_hint, size_type n, const hasher& hf,
+                      const key_equal& eql)
+    : hash(hf) { initialize_shards(shards_hint, n, eql); }
+
+  ~concurrent_hash_map() { destroy_shards(num_shards); }
+
+public:
+  // size() locks one shard at a time, so under concurrent updates it is
+  // only a snapshot.
+  size_type size() const;
+  bool empty() const { return size() == 0; }
+  size_type shard_count() const { return num_shards; }
+
+  bool find(const key_type& key, data_type& result) const
+  {
+    shard& s = shard_for(key);
+    __stl_read_guard guard(s.lock);
+    typename ht::const_iterator it = s.table.find(key);
+    if (it == s.table.end())
+      return false;
+    result = it->second;
+    return true;
+  }
+
+  size_type count(const key_type& key) const
+  {
+    shard& s = shard_for(key);
+    __stl_read_guard guard(s.lock);
+    return s.table.count(key);
+  }
+
+  bool insert(const value_type& obj)
+  {
+    shard& s = shard_for(obj.first);
+    __stl_write_guard guard(s.lock);
+    return s.table.insert_unique(obj).second;
+  }
+
+  // Returns the mapped value for obj.first, inserting obj if the key is
+  // not present.
+  data_type find_or_insert(const value_type& obj)
+  {
+    shard& s = shard_for(obj.first);
+    __stl_write_guard guard(s.lock);
+    return s.table.find_or_insert(obj).second;
+  }
+
+  size_type erase(const key_type& key)
+  {
+    shard& s = shard_for(key);
+    __stl_write_guard guard(s.lock);
+    return s.table.erase(key);
+  }
+
+  void clear();
+  void reserve(size_type n);
+
+#ifdef __STL_MEMBER_TEMPLATES
+  // Calls f(const value_type&) on the element with this key, if any,
+  // while its shard is read-locked.
+  template <class Visitor>
+  bool visit(const key_type& key, Visitor f) const
+  {
+    shard& s = shard_for(key);
+    __stl_read_guard guard(s.lock);
+    typename ht::const_iterator it = s.table.find(key);
+    if (it == s.table.end())
+      return false;
+    f(*it);
+    return true;
+  }
+
+  // Calls f(value_type&) on the element with this key, if any, while
+  // its shard is write-locked.
+  template <class Visitor>
+  bool update(const key_type& key, Visitor f)
+  {
+    shard& s = shard_for(key);
+    __stl_write_guard guard(s.lock);
+    typename ht::iterator it = s.table.find(key);
+    if (it == s.table.end())
+      return false;
+    f(*it);
+    return true;
+  }
+
+  // Calls f(value_type&) on the element with key obj.first, inserting
+  // obj first if there is none.  Returns true if obj was inserted.
+  template <class Visitor>
+  bool insert_or_update(const value_type& obj, Visitor f)
+  {
+    shard& s = shard_for(obj.first);
+    __stl_write_guard guard(s.lock);
+    pair<typename ht::iterator, bool> p = s.table.insert_unique(obj);
+    f(*p.first);
+    return p.second;
+  }
+
+  // Calls f(const value_type&) on every element.  Shards are locked one
+  // at a time, so elements inserted or erased meanwhile may or may not
+  // be seen.
+  template <class Visitor>
+  void for_each(Visitor f) const
+  {
+    for (size_type i = 0; i < num_shards; ++i) {
+      __stl_read_guard guard(shards[i]->lock);
+      const ht& table = shards[i]->table;
+      for (typename ht::const_iterator it = table.begin();
+           it != table.end(); ++it)
+        f(*it);
+    }
+  }
+#endif /* __STL_MEMBER_TEMPLATES */
+
+private:
+  shard& shard_for(const key_type& key) const
+    { return *shards[__stl_hash_mix(hash(key)) >> shard_shift]; }
+
+  void initialize_shards(size_type shards_hint, size_type n,
+                         const key_equal& eql);
+  void destroy_shards(size_type n);
+
+  // Shared state and locks cannot be copied.
+  concurrent_hash_map(const concurrent_hash_map&);
+  void operator=(const concurrent_hash_map&);
+};
+
+// At least two shards, so that the shard index is never a shift by the
+// full width of size_t.
+template <class Key, class T, class HF, class EqK, class A, class P>
+void concurrent_hash_map<Key, T, HF, EqK, A, P>
+  ::initialize_shards(size_type shards_hint, size_type n,
+                      const key_equal& eql)
+{
+  int bits = 1;
+  while (bits < int(sizeof(size_t) * 8 - 1)
+         && (size_type(1) << bits) < shards_hint)
+    ++bits;
+  num_shards = size_type(1) << bits;
+  shard_shift = sizeof(size_t) * 8 - bits;
+
+  shards = shard_ptr_allocator::allocate(num_shards);
+  size_type i = 0;
+  __STL_TRY {
+    for ( ; i < num_shards; ++i) {
+      shard* p = shard_allocator::allocate();
+      __STL_TRY {
+        new (p) shard(n / num_shards + 1, hash, eql);
+      }
+      __STL_UNWIND(shard_allocator::deallocate(p));
+      shards[i] = p;
+    }
+  }
+  __STL_UNWIND(destroy_shards(i));
+}
+
+template <class Key, class T, class HF, class EqK, class A, class P>
+void concurrent_hash_map<Key, T, HF, EqK, A, P>::destroy_shards(size_type n)
+{
+  for (size_type i = 0; i < n; ++i) {
+    shards[i]->~shard();
+    shard_allocator::deallocate(shards[i]);
+  }
+  shard_ptr_allocator::deallocate(shards, num_shards);
+}
+
+template <class Key, class T, class HF, class EqK, class A, class P>
+typename concurrent_hash_map<Key, T, HF, EqK, A, P>::size_type
+concurrent_hash_map<Key, T, HF, EqK, A, P>::size() const
+{
+  size_type result = 0;
+  for (size_type i = 0; i < num_shards; ++i) {
+    __stl_read_guard guard(shards[i]->lock);
+    result += shards[i]->table.size();
+  }
+  return result;
+}
+
+template <class Key, class T, class HF, class EqK, class A, class P>
+void concurrent_hash_map<Key, T, HF, EqK, A, P>::clear()
+{
+  for (size_type i = 0; i < num_shards; ++i) {
+    __stl_write_guard guard(shards[i]->lock);
+    shards[i]->table.clear();
+  }
+}
+
+template <class Key, class T, class HF, class EqK, class A, class P>
+void concurrent_hash_map<Key, T, HF, EqK, A, P>::reserve(size_type n)
+{
+  const size_type per_shard = n / num_shards + 1;
+  for (size_type i = 0; i < num_shards; ++i) {
+    __stl_write_guard guard(shards[i]->lock);
+    shards[i]->table.reserve(per_shard);
+  }
+}
+
+#if defined(__sgi) && !defined(__GNUC__) && (_MIPS_SIM != _MIPS_SIM_ABI32)
+#pragma reset woff 1174
+#endif
+
+__STL_END_NAMESPACE
+
+#endif /* __SGI_STL_INTERNAL_CONCURRENT_HASH_MAP_H */
+
+// Local Variables:
+// mode:C++
+// End:
@@ -70,6 +70,19 @@
 //       appropriately.
 //  (19) Defines __stl_assert either as a test or as a null macro,
 //       depending on whether or not __STL_ASSERTIONS is defined.
+//  (20) Defines __STL_USE_SSE2 if the target supports the SSE2 instruction
+//       set, unless the user has defined __STL_NO_SSE2.
+//  (21) Defines __STL_USE_MMAP if the system provides mmap in <sys/mman.h>,
+//       unless the user has defined __STL_NO_MMAP.
+//  (22) Defines __STL_ATOMIC_BUILTINS if the compiler provides the GCC
+//       __sync atomic builtins, unless the user has defined
+//       __STL_NO_ATOMIC_BUILTINS.
+//  (23) Defines __STL_USE_WRITEV if the system provides writev in
+//       <sys/uio.h>, unless the user has defined __STL_NO_WRITEV.
+//  (24) Defines __STL_EXCEPTION_PTR if exceptions are enabled and the
+//       library provides std::exception_ptr, so that an exception may
+//       be carried from one thread to another, unless the user has
+//       defined __STL_NO_EXCEPTION_PTR.
 
 #ifdef _PTHREADS
 #   define __STL_PTHREADS
@@ -234,6 +247,33 @@
 #   define __STL_UNWIND(action) 
 # endif
 
+# if (defined(__SSE2__) || defined(_M_X64) || \
+      (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(__STL_NO_SSE2)
+#   define __STL_USE_SSE2
+# endif
+
+# if (defined(__unix) || defined(__unix__) || defined(__sgi) || \
+      defined(__APPLE__)) && !defined(__STL_NO_MMAP)
+#   define __STL_USE_MMAP
+# endif
+
+# if defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 1)) && \
+     !defined(__STL_NO_ATOMIC_BUILTINS)
+#   define __STL_ATOMIC_BUILTINS
+# endif
+
+# if (defined(__unix) || defined(__unix__) || defined(__sgi) || \
+      defined(__APPLE__)) && !defined(__STL_NO_WRITEV)
+#   define __STL_USE_WRITEV
+# endif
+
+# if defined(__STL_USE_EXCEPTIONS) && \
+     (__cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600)) && \
+     !defined(__STL_NO_EXCEPTION_PTR)
+#   define __STL_EXCEPTION_PTR
+# endif
+
 #ifdef __STL_ASSERTIONS
 # include <stdio.h>
 # define __stl_assert(expr) \
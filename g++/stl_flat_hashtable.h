@@ -0,0 +1,785 @@
+/*
+ * Copyright (c) 1996,1997
+ * Silicon Graphics Computer Systems, Inc.
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Silicon Graphics makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ *
+ * Copyright (c) 1994
+ * Hewlett-Packard Company
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Hewlett-Packard Company makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ */
+
+/* NOTE: This is an internal header file, included by other STL headers.
+ *   You should not attempt to use it directly.
+ */
+
+#ifndef __SGI_STL_INTERNAL_FLAT_HASHTABLE_H
+#define __SGI_STL_INTERNAL_FLAT_HASHTABLE_H
+
+// Open-addressing hash table, used to implement flat_hash_set and
+// flat_hash_map.  It takes the same HashFcn, ExtractKey and EqualKey
+// functors as hashtable, but keeps the elements in one array of slots
+// instead of chaining separately allocated nodes off the buckets.
+//
+// Every slot has a one-byte control code.  A full slot stores the low
+// seven bits of its hash code (h2); the rest of the hash (h1) picks where
+// probing starts.  Probing examines a group of sixteen control bytes at a
+// time, with SSE2 when __STL_USE_SSE2 is defined, so a lookup usually
+// touches one control group and compares keys only on h2 matches.
+//
+// The number of slots is always 2^k - 1.  The control array holds one
+// byte per slot, then a sentinel, then a copy of the first fifteen bytes
+// so that a group may be loaded at any slot without wrapping.
+
+#include <stl_algobase.h>
+#include <stl_alloc.h>
+#include <stl_construct.h>
+#include <stl_function.h>
+#include <stl_hash_fun.h>
+
+#ifdef __STL_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef __STL_USE_EXCEPTIONS
+extern void __length_error (const char *);
+#define __STL_FLAT_LENGTH_ERROR(cond) \
+  do { if (cond) __length_error (#cond); } while (0)
+#else
+#include <assert.h>
+#define __STL_FLAT_LENGTH_ERROR(cond) assert (!(cond))
+#endif
+
+__STL_BEGIN_NAMESPACE
+
+// Control codes.  Full slots hold a value in [0, 127].
+static const signed char __flat_ctrl_empty = -128;
+static const signed char __flat_ctrl_deleted = -2;
+static const signed char __flat_ctrl_sentinel = -1;
+
+static const int __flat_group_width = 16;
+
+inline int __flat_trailing_zeros(unsigned int mask)
+{
+# ifdef __GNUC__
+  return __builtin_ctz(mask);
+# else
+  int n = 0;
+  for ( ; !(mask & 1); mask >>= 1)
+    ++n;
+  return n;
+# endif
+}
+
+// Leading zeros within a group mask of __flat_group_width bits.
+inline int __flat_leading_zeros(unsigned int mask)
+{
+  int n = 0;
+  for (unsigned int bit = 1u << (__flat_group_width - 1);
+       bit && !(mask & bit); bit >>= 1)
+    ++n;
+  return n;
+}
+
+// A group of __flat_group_width control bytes.  The match functions
+// return a bit mask with bit i set if byte i satisfies the test.
+struct __flat_group {
+#ifdef __STL_USE_SSE2
+  __m128i ctrl;
+
+  explicit __flat_group(const signed char* p)
+    : ctrl(_mm_loadu_si128((const __m128i*) p)) {}
+
+  unsigned int match(signed char h2) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
+  }
+  unsigned int match_empty() const { return match(__flat_ctrl_empty); }
+  unsigned int match_empty_or_deleted() const {
+    return _mm_movemask_epi8(
+      _mm_cmpgt_epi8(_mm_set1_epi8(__flat_ctrl_sentinel), ctrl));
+  }
+#else /* __STL_USE_SSE2 */
+  const signed char* ctrl;
+
+  explicit __flat_group(const signed char* p) : ctrl(p) {}
+
+  unsigned int match(signed char h2) const {
+    unsigned int result = 0;
+    for (int i = 0; i < __flat_group_width; ++i)
+      if (ctrl[i] == h2)
+        result |= 1u << i;
+    return result;
+  }
+  unsigned int match_empty() const { return match(__flat_ctrl_empty); }
+  unsigned int match_empty_or_deleted() const {
+    unsigned int result = 0;
+    for (int i = 0; i < __flat_group_width; ++i)
+      if (ctrl[i] < __flat_ctrl_sentinel)
+        result |= 1u << i;
+    return result;
+  }
+#endif /* __STL_USE_SSE2 */
+};
+
+template <class Value, class Key, class HashFcn,
+          class ExtractKey, class EqualKey, class Alloc = alloc>
+class flat_hashtable;
+
+template <class Value, class Key, class HashFcn,
+          class ExtractKey, class EqualKey, class Alloc>
+struct __flat_hashtable_iterator;
+
+template <class Value, class Key, class HashFcn,
+          class ExtractKey, class EqualKey, class Alloc>
+struct __flat_hashtable_const_iterator;
+
+// Iterators walk the control array in step with the slot array.  The
+// sentinel byte stops the walk, so they need no pointer to the table.
+template <class Value, class Key, class HashFcn,
+          class ExtractKey, class EqualKey, class Alloc>
+struct __flat_hashtable_iterator {
+  typedef __flat_hashtable_iterator<Value, Key, HashFcn,
+                                    ExtractKey, EqualKey, Alloc>
+          iterator;
+  typedef __flat_hashtable_const_iterator<Value, Key, HashFcn,
+                                          ExtractKey, EqualKey, Alloc>
+          const_iterator;
+
+  typedef forward_iterator_tag iterator_category;
+  typedef Value value_type;
+  typedef ptrdiff_t difference_type;
+  typedef size_t size_type;
+  typedef Value& reference;
+  typedef Value* pointer;
+
+  signed char* ctrl;
+  Value* slot;
+
+  __flat_hashtable_iterator(signed char* c, Value* s) : ctrl(c), slot(s) {}
+  __flat_hashtable_iterator() {}
+  reference operator*() const { return *slot; }
+#ifndef __SGI_STL_NO_ARROW_OPERATOR
+  pointer operator->() const { return &(operator*()); }
+#endif /* __SGI_STL_NO_ARROW_OPERATOR */
+  iterator& operator++() {
+    ++ctrl;
+    ++slot;
+    skip_empty_slots();
+    return *this;
+  }
+  iterator operator++(int) {
+    iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  bool operator==(const iterator& it) const { return slot == it.slot; }
+  bool operator!=(const iterator& it) const { return slot != it.slot; }
+
+  void skip_empty_slots() {
+    while (*ctrl < __flat_ctrl_sentinel) {
+      ++ctrl;
+      ++slot;
+    }
+  }
+};
+
+template <class Value, class Key, class HashFcn,
+          class ExtractKey, class EqualKey, class Alloc>
+struct __flat_hashtable_const_iterator {
+  typedef __flat_hashtable_iterator<Value, Key, HashFcn,
+                                    ExtractKey, EqualKey, Alloc>
+          iterator;
+  typedef __flat_hashtable_const_iterator<Value, Key, HashFcn,
+                                          ExtractKey, EqualKey, Alloc>
+          const_iterator;
+
+  typedef forward_iterator_tag iterator_category;
+  typedef Value value_type;
+  typedef ptrdiff_t difference_type;
+  typedef size_t size_type;
+  typedef const Value& reference;
+  typedef const Value* pointer;
+
+  const signed char* ctrl;
+  const Value* slot;
+
+  __flat_hashtable_const_iterator(const signed char* c, const Value* s)
+    : ctrl(c), slot(s) {}
+  __flat_hashtable_const_iterator() {}
+  __flat_hashtable_const_iterator(const iterator& it)
+    : ctrl(it.ctrl), slot(it.slot) {}
+  reference operator*() const { return *slot; }
+#ifndef __SGI_STL_NO_ARROW_OPERATOR
+  pointer operator->() const { return &(operator*()); }
+#endif /* __SGI_STL_NO_ARROW_OPERATOR */
+  const_iterator& operator++() {
+    ++ctrl;
+    ++slot;
+    skip_empty_slots();
+    return *this;
+  }
+  const_iterator operator++(int) {
+    const_iterator tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  bool operator==(const const_iterator& it) const { return slot == it.slot; }
+  bool operator!=(const const_iterator& it) const { return slot != it.slot; }
+
+  void skip_empty_slots() {
+    while (*ctrl < __flat_ctrl_sentinel) {
+      ++ctrl;
+      ++slot;
+    }
+  }
+};
+
+template <class Value, class Key, class HashFcn,
+          class ExtractKey, class EqualKey,
+          class Alloc>
+class flat_hashtable {
+public:
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef HashFcn hasher;
+  typedef EqualKey key_equal;
+
+  typedef size_t            size_type;
+  typedef ptrdiff_t         difference_type;
+  typedef value_type*       pointer;
+  typedef const value_type* const_pointer;
+  typedef value_type&       reference;
+  typedef const value_type& const_reference;
+
+  hasher hash_funct() const { return hash; }
+  key_equal key_eq() const { return equals; }
+
+private:
+  hasher hash;
+  key_equal equals;
+  ExtractKey get_key;
+
+  typedef simple_alloc<Value, Alloc> slot_allocator;
+  typedef simple_alloc<signed char, Alloc> ctrl_allocator;
+
+  signed char* ctrl;
+  Value* slots;
+  size_type capacity;           // Always 2^k - 1; also the probe mask.
+  size_type num_elements;
+  size_type growth_left;        // Empty slots we may still fill.
+
+public:
+  typedef __flat_hashtable_iterator<Value, Key, HashFcn, ExtractKey,
+                                    EqualKey, Alloc>
+  iterator;
+
+  typedef __flat_hashtable_const_iterator<Value, Key, HashFcn, ExtractKey,
+                                          EqualKey, Alloc>
+  const_iterator;
+
+public:
+  flat_hashtable(size_type n,
+                 const HashFcn&    hf,
+                 const EqualKey&   eql,
+                 const ExtractKey& ext)
+    : hash(hf), equals(eql), get_key(ext)
+  {
+    initialize_slots(n);
+  }
+
+  flat_hashtable(size_type n,
+                 const HashFcn&    hf,
+                 const EqualKey&   eql)
+    : hash(hf), equals(eql), get_key(ExtractKey())
+  {
+    initialize_slots(n);
+  }
+
+  flat_hashtable(const flat_hashtable& ht)
+    : hash(ht.hash), equals(ht.equals), get_key(ht.get_key)
+  {
+    initialize_slots(ht.num_elements);
+    __STL_TRY {
+      insert_unique(ht.begin(), ht.end());
+    }
+    __STL_UNWIND((clear(), deallocate_slots()));
+  }
+
+  flat_hashtable& operator= (const flat_hashtable& ht)
+  {
+    if (&ht != this) {
+      clear();
+      hash = ht.hash;
+      equals = ht.equals;
+      get_key = ht.get_key;
+      resize(ht.num_elements);
+      insert_unique(ht.begin(), ht.end());
+    }
+    return *this;
+  }
+
+  ~flat_hashtable() { clear(); deallocate_slots(); }
+
+  size_type size() const { return num_elements; }
+  size_type max_size() const { return size_type(-1) / sizeof(Value); }
+  bool empty() const { return size() == 0; }
+
+  void swap(flat_hashtable& ht)
+  {
+    __STD::swap(hash, ht.hash);
+    __STD::swap(equals, ht.equals);
+    __STD::swap(get_key, ht.get_key);
+    __STD::swap(ctrl, ht.ctrl);
+    __STD::swap(slots, ht.slots);
+    __STD::swap(capacity, ht.capacity);
+    __STD::swap(num_elements, ht.num_elements);
+    __STD::swap(growth_left, ht.growth_left);
+  }
+
+  iterator begin()
+  {
+    iterator it(ctrl, slots);
+    it.skip_empty_slots();
+    return it;
+  }
+
+  iterator end() { return iterator(ctrl + capacity, slots + capacity); }
+
+  const_iterator begin() const
+  {
+    const_iterator it(ctrl, slots);
+    it.skip_empty_slots();
+    return it;
+  }
+
+  const_iterator end() const
+    { return const_iterator(ctrl + capacity, slots + capacity); }
+
+public:
+
+  size_type bucket_count() const { return capacity; }
+
+  size_type max_bucket_count() const { return max_size(); }
+
+  pair<iterator, bool> insert_unique(const value_type& obj);
+
+#ifdef __STL_MEMBER_TEMPLATES
+  template <class InputIterator>
+  void insert_unique(InputIterator f, InputIterator l)
+  {
+    insert_unique(f, l, iterator_category(f));
+  }
+
+  template <class InputIterator>
+  void insert_unique(InputIterator f, InputIterator l,
+                     input_iterator_tag)
+  {
+    for ( ; f != l; ++f)
+      insert_unique(*f);
+  }
+
+  template <class ForwardIterator>
+  void insert_unique(ForwardIterator f, ForwardIterator l,
+                     forward_iterator_tag)
+  {
+    size_type n = 0;
+    distance(f, l, n);
+    resize(num_elements + n);
+    for ( ; n > 0; --n, ++f)
+      insert_unique(*f);
+  }
+
+#else /* __STL_MEMBER_TEMPLATES */
+  void insert_unique(const value_type* f, const value_type* l)
+  {
+    resize(num_elements + (l - f));
+    for ( ; f != l; ++f)
+      insert_unique(*f);
+  }
+
+  void insert_unique(const_iterator f, const_iterator l)
+  {
+    size_type n = 0;
+    distance(f, l, n);
+    resize(num_elements + n);
+    for ( ; n > 0; --n, ++f)
+      insert_unique(*f);
+  }
+#endif /*__STL_MEMBER_TEMPLATES */
+
+  reference find_or_insert(const value_type& obj)
+  {
+    return *insert_unique(obj).first;
+  }
+
+  iterator find(const key_type& key)
+  {
+    size_type i = find_slot(key);
+    return i == capacity ? end() : iterator(ctrl + i, slots + i);
+  }
+
+  const_iterator find(const key_type& key) const
+  {
+    size_type i = find_slot(key);
+    return i == capacity ? end() : const_iterator(ctrl + i, slots + i);
+  }
+
+  size_type count(const key_type& key) const
+  {
+    return find_slot(key) == capacity ? 0 : 1;
+  }
+
+  pair<iterator, iterator> equal_range(const key_type& key)
+  {
+    iterator first = find(key);
+    iterator last = first;
+    if (first != end())
+      ++last;
+    return pair<iterator, iterator>(first, last);
+  }
+
+  pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+  {
+    const_iterator first = find(key);
+    const_iterator last = first;
+    if (first != end())
+      ++last;
+    return pair<const_iterator, const_iterator>(first, last);
+  }
+
+  size_type erase(const key_type& key)
+  {
+    size_type i = find_slot(key);
+    if (i == capacity)
+      return 0;
+    erase_slot(i);
+    return 1;
+  }
+
+  void erase(const iterator& it) { erase_slot(it.slot - slots); }
+  void erase(iterator first, iterator last)
+  {
+    for ( ; first != last; ++first)
+      erase_slot(first.slot - slots);
+  }
+
+  void erase(const const_iterator& it) { erase_slot(it.slot - slots); }
+  void erase(const_iterator first, const_iterator last)
+  {
+    for ( ; first != last; ++first)
+      erase_slot(first.slot - slots);
+  }
+
+  void resize(size_type num_elements_hint);
+  void clear();
+
+private:
+  static size_type h1(size_t h) { return h >> 7; }
+  static signed char h2(size_t h) { return (signed char) (h & 0x7f); }
+
+  size_t hash_code(const key_type& key) const
+    { return __stl_hash_mix(hash(key)); }
+
+  // Slots we may fill before growing: seven eighths of the capacity.
+  static size_type max_load(size_type cap) { return cap - cap / 8; }
+
+  // The smallest 2^k - 1 that holds n elements within max_load.  As
+  // with basic_string, asking for more slots than max_size () is a
+  // length error.
+  static size_type capacity_for(size_type n)
+  {
+    const size_type max_cap = size_type(-1) / sizeof(Value);
+    size_type cap = __flat_group_width - 1;
+    while (max_load(cap) < n) {
+      __STL_FLAT_LENGTH_ERROR(cap > (max_cap - 1) / 2);
+      cap = cap * 2 + 1;
+    }
+    return cap;
+  }
+
+  void initialize_slots(size_type n)
+  {
+    num_elements = 0;
+    allocate_slots(capacity_for(n));
+  }
+
+  void allocate_slots(size_type cap);
+  void deallocate_slots()
+  {
+    ctrl_allocator::deallocate(ctrl, capacity + __flat_group_width);
+    slot_allocator::deallocate(slots, capacity);
+  }
+
+  // Writes a control byte, keeping the cloned group after the sentinel
+  // in step with the first slots.
+  void set_ctrl(size_type i, signed char c)
+  {
+    ctrl[i] = c;
+    ctrl[((i - (__flat_group_width - 1)) & capacity)
+         + (__flat_group_width - 1)] = c;
+  }
+
+  size_type find_slot(const key_type& key) const
+    { return find_slot(key, hash_code(key)); }
+  size_type find_slot(const key_type& key, size_t h) const;
+  size_type find_insert_slot(size_t h) const;
+  void erase_slot(size_type i);
+  void rehash(size_type new_capacity);
+};
+
+template <class V, class K, class HF, class Ex, class Eq, class A>
+void flat_hashtable<V, K, HF, Ex, Eq, A>::allocate_slots(size_type cap)
+{
+  // The table is not touched until both arrays are allocated, so that
+  // rehash leaves it as it was if either allocation throws.
+  signed char* new_ctrl = ctrl_allocator::allocate(cap + __flat_group_width);
+  V* new_slots;
+  __STL_TRY {
+    new_slots = slot_allocator::allocate(cap);
+  }
+  __STL_UNWIND(ctrl_allocator::deallocate(new_ctrl, cap + __flat_group_width));
+  fill(new_ctrl, new_ctrl + cap + __flat_group_width, __flat_ctrl_empty);
+  new_ctrl[cap] = __flat_ctrl_sentinel;
+  ctrl = new_ctrl;
+  slots = new_slots;
+  capacity = cap;
+  growth_left = max_load(cap) - num_elements;
+}
+
+// Probes groups in triangular order: 0, 1, 3, 6, ... groups past the
+// start.  With 2^k slots' worth of positions that visits every group.
+template <class V, class K, class HF, class Ex, class Eq, class A>
+typename flat_hashtable<V, K, HF, Ex, Eq, A>::size_type
+flat_hashtable<V, K, HF, Ex, Eq, A>::find_slot(const key_type& key,
+                                               size_t h) const
+{
+  const signed char tag = h2(h);
+  size_type pos = h1(h) & capacity;
+  for (size_type step = __flat_group_width; ; step += __flat_group_width) {
+    __flat_group g(ctrl + pos);
+    for (unsigned int m = g.match(tag); m; m &= m - 1) {
+      size_type i = (pos + __flat_trailing_zeros(m)) & capacity;
+      if (equals(get_key(slots[i]), key))
+        return i;
+    }
+    if (g.match_empty())
+      return capacity;
+    pos = (pos + step) & capacity;
+  }
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class A>
+typename flat_hashtable<V, K, HF, Ex, Eq, A>::size_type
+flat_hashtable<V, K, HF, Ex, Eq, A>::find_insert_slot(size_t h) const
+{
+  size_type pos = h1(h) & capacity;
+  for (size_type step = __flat_group_width; ; step += __flat_group_width) {
+    unsigned int m = __flat_group(ctrl + pos).match_empty_or_deleted();
+    if (m)
+      return (pos + __flat_trailing_zeros(m)) & capacity;
+    pos = (pos + step) & capacity;
+  }
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class A>
+pair<typename flat_hashtable<V, K, HF, Ex, Eq, A>::iterator, bool>
+flat_hashtable<V, K, HF, Ex, Eq, A>::insert_unique(const value_type& obj)
+{
+  const size_t h = hash_code(get_key(obj));
+  size_type i = find_slot(get_key(obj), h);
+  if (i != capacity)
+    return pair<iterator, bool>(iterator(ctrl + i, slots + i), false);
+
+  i = find_insert_slot(h);
+  if (growth_left == 0 && ctrl[i] == __flat_ctrl_empty) {
+    // Tombstones count against the load.  Rebuild at the same size if
+    // dropping them frees enough room, otherwise double.
+    rehash(capacity_for(num_elements + 1 + num_elements / 2));
+    i = find_insert_slot(h);
+  }
+  construct(slots + i, obj);
+  if (ctrl[i] == __flat_ctrl_empty)
+    --growth_left;
+  set_ctrl(i, h2(h));
+  ++num_elements;
+  return pair<iterator, bool>(iterator(ctrl + i, slots + i), true);
+}
+
+// A slot may go back to empty, rather than become a tombstone, if no
+// probe sequence can have passed over it: that is, if the run of full
+// or deleted slots around it is shorter than a group.
+template <class V, class K, class HF, class Ex, class Eq, class A>
+void flat_hashtable<V, K, HF, Ex, Eq, A>::erase_slot(size_type i)
+{
+  destroy(slots + i);
+  --num_elements;
+  const size_type before = (i - __flat_group_width) & capacity;
+  unsigned int empty_before = __flat_group(ctrl + before).match_empty();
+  unsigned int empty_after = __flat_group(ctrl + i).match_empty();
+  if (empty_before && empty_after
+      && __flat_trailing_zeros(empty_after)
+         + __flat_leading_zeros(empty_before) < __flat_group_width) {
+    set_ctrl(i, __flat_ctrl_empty);
+    ++growth_left;
+  }
+  else
+    set_ctrl(i, __flat_ctrl_deleted);
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class A>
+void flat_hashtable<V, K, HF, Ex, Eq, A>::resize(size_type num_elements_hint)
+{
+  if (num_elements_hint > max_load(capacity))
+    rehash(capacity_for(num_elements_hint));
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class A>
+void flat_hashtable<V, K, HF, Ex, Eq, A>::rehash(size_type new_capacity)
+{
+  signed char* old_ctrl = ctrl;
+  V* old_slots = slots;
+  const size_type old_capacity = capacity;
+
+  allocate_slots(new_capacity);
+  size_type i = 0;
+  __STL_TRY {
+    for ( ; i < old_capacity; ++i) {
+      if (old_ctrl[i] >= 0) {
+        const size_t h = hash_code(get_key(old_slots[i]));
+        const size_type j = find_insert_slot(h);
+        construct(slots + j, old_slots[i]);
+        set_ctrl(j, h2(h));
+        destroy(old_slots + i);
+      }
+    }
+  }
+#   ifdef __STL_USE_EXCEPTIONS
+  catch(...) {
+    // Elements before i now live only in the new table.  Moving them
+    // back would need more copies that may throw, so keep the new table
+    // and drop the rest.
+    for ( ; i < old_capacity; ++i)
+      if (old_ctrl[i] >= 0) {
+        destroy(old_slots + i);
+        --num_elements;
+      }
+    growth_left = max_load(capacity) - num_elements;
+    ctrl_allocator::deallocate(old_ctrl, old_capacity + __flat_group_width);
+    slot_allocator::deallocate(old_slots, old_capacity);
+    throw;
+  }
+#   endif /* __STL_USE_EXCEPTIONS */
+  ctrl_allocator::deallocate(old_ctrl, old_capacity + __flat_group_width);
+  slot_allocator::deallocate(old_slots, old_capacity);
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class A>
+void flat_hashtable<V, K, HF, Ex, Eq, A>::clear()
+{
+  for (size_type i = 0; i < capacity; ++i)
+    if (ctrl[i] >= 0)
+      destroy(slots + i);
+  fill(ctrl, ctrl + capacity + __flat_group_width, __flat_ctrl_empty);
+  ctrl[capacity] = __flat_ctrl_sentinel;
+  num_elements = 0;
+  growth_left = max_load(capacity);
+}
+
+#ifndef __STL_CLASS_PARTIAL_SPECIALIZATION
+
+template <class V, class K, class HF, class ExK, class EqK, class All>
+inline forward_iterator_tag
+iterator_category(const __flat_hashtable_iterator<V, K, HF, ExK, EqK, All>&)
+{
+  return forward_iterator_tag();
+}
+
+template <class V, class K, class HF, class ExK, class EqK, class All>
+inline V*
+value_type(const __flat_hashtable_iterator<V, K, HF, ExK, EqK, All>&)
+{
+  return (V*) 0;
+}
+
+template <class V, class K, class HF, class ExK, class EqK, class All>
+inline ptrdiff_t*
+distance_type(const __flat_hashtable_iterator<V, K, HF, ExK, EqK, All>&)
+{
+  return (ptrdiff_t*) 0;
+}
+
+template <class V, class K, class HF, class ExK, class EqK, class All>
+inline forward_iterator_tag
+iterator_category(
+  const __flat_hashtable_const_iterator<V, K, HF, ExK, EqK, All>&)
+{
+  return forward_iterator_tag();
+}
+
+template <class V, class K, class HF, class ExK, class EqK, class All>
+inline V*
+value_type(const __flat_hashtable_const_iterator<V, K, HF, ExK, EqK, All>&)
+{
+  return (V*) 0;
+}
+
+template <class V, class K, class HF, class ExK, class EqK, class All>
+inline ptrdiff_t*
+distance_type(
+  const __flat_hashtable_const_iterator<V, K, HF, ExK, EqK, All>&)
+{
+  return (ptrdiff_t*) 0;
+}
+
+#endif /* __STL_CLASS_PARTIAL_SPECIALIZATION */
+
+// Slot order depends on insertion history, so compare by lookup.
+template <class V, class K, class HF, class Ex, class Eq, class A>
+bool operator==(const flat_hashtable<V, K, HF, Ex, Eq, A>& ht1,
+                const flat_hashtable<V, K, HF, Ex, Eq, A>& ht2)
+{
+  typedef typename flat_hashtable<V, K, HF, Ex, Eq, A>::const_iterator
+          const_iterator;
+  if (ht1.size() != ht2.size())
+    return false;
+  Ex get_key;
+  for (const_iterator it = ht1.begin(); it != ht1.end(); ++it) {
+    const_iterator other = ht2.find(get_key(*it));
+    if (other == ht2.end() || !(*other == *it))
+      return false;
+  }
+  return true;
+}
+
+#ifdef __STL_FUNCTION_TMPL_PARTIAL_ORDER
+
+template <class Val, class Key, class HF, class Extract, class EqKey, class A>
+inline void swap(flat_hashtable<Val, Key, HF, Extract, EqKey, A>& ht1,
+                 flat_hashtable<Val, Key, HF, Extract, EqKey, A>& ht2) {
+  ht1.swap(ht2);
+}
+
+#endif /* __STL_FUNCTION_TMPL_PARTIAL_ORDER */
+
+__STL_END_NAMESPACE
+
+#endif /* __SGI_STL_INTERNAL_FLAT_HASHTABLE_H */
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 1996
+ * Silicon Graphics Computer Systems, Inc.
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Silicon Graphics makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ *
+ * Copyright (c) 1994
+ * Hewlett-Packard Company
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Hewlett-Packard Company makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ */
+
+
+/* NOTE: This is an internal header file, included by other STL headers.
+ *   You should not attempt to use it directly.
+ */
+
+#ifndef __SGI_STL_INTERNAL_FROZEN_MAP_H
+#define __SGI_STL_INTERNAL_FROZEN_MAP_H
+
+__STL_BEGIN_NAMESPACE
+
+#if defined(__sgi) && !defined(__GNUC__) && (_MIPS_SIM != _MIPS_SIM_ABI32)
+#pragma set woff 1174
+#endif
+
+// frozen_hash_map and frozen_map are read-only maps loaded from a file
+// written by their static write() function, typically from a hash_map
+// or a map.  Lookups have the interface of the const members of hash_map
+// and map; iterators are pointers into the loaded image and stay valid
+// until the map is closed or destroyed.  Both key and data types must be
+// plain old data.
+
+#ifndef __STL_LIMITED_DEFAULT_TEMPLATES
+template <class Key, class T, class HashFcn = hash<Key>,
+          class EqualKey = equal_to<Key> >
+#else
+template <class Key, class T, class HashFcn, class EqualKey>
+#endif
+class frozen_hash_map
+{
+private:
+  typedef __frozen_hashtable<pair<const Key, T>, Key, HashFcn,
+                             select1st<pair<const Key, T> >, EqualKey> ht;
+  ht rep;
+
+public:
+  typedef typename ht::key_type key_type;
+  typedef T data_type;
+  typedef T mapped_type;
+  typedef typename ht::value_type value_type;
+  typedef typename ht::hasher hasher;
+  typedef typename ht::key_equal key_equal;
+
+  typedef typename ht::size_type size_type;
+  typedef typename ht::difference_type difference_type;
+  typedef typename ht::const_pointer const_pointer;
+  typedef typename ht::const_reference const_reference;
+  typedef typename ht::const_iterator const_iterator;
+
+  hasher hash_funct() const { return rep.hash_funct(); }
+  key_equal key_eq() const { return rep.key_eq(); }
+
+public:
+  frozen_hash_map() : rep(hasher(), key_equal()) {}
+  explicit frozen_hash_map(const hasher& hf) : rep(hf, key_equal()) {}
+  frozen_hash_map(const hasher& hf, const key_equal& eql) : rep(hf, eql) {}
+
+  // Loads the map from a file.  verify checks the checksum, which reads
+  // every page of the file; without it the pages are read on demand.
+  bool open(const char* path, bool verify = true)
+  {
+    __frozen_require_pod(typename __type_traits<T>::is_POD_type());
+    return rep.open(path, verify);
+  }
+  // Uses a table already in memory, which must outlive the map.
+  bool attach(const void* data, size_type len, bool verify = true)
+  {
+    __frozen_require_pod(typename __type_traits<T>::is_POD_type());
+    return rep.attach(data, len, verify);
+  }
+  void close() { rep.detach(); }
+
+#ifdef __STL_MEMBER_TEMPLATES
+  template <class ForwardIterator>
+  static bool write(FILE* f, ForwardIterator first, ForwardIterator last,
+                    const hasher& hf = hasher())
+  {
+    __frozen_require_pod(typename __type_traits<T>::is_POD_type());
+    return ht::write(f, first, last, hf);
+  }
+#else /* __STL_MEMBER_TEMPLATES */
+  static bool write(FILE* f, const value_type* first, const value_type* last,
+                    const hasher& hf = hasher())
+  {
+    __frozen_require_pod(typename __type_traits<T>::is_POD_type());
+    return ht::write(f, first, last, hf);
+  }
+#endif /* __STL_MEMBER_TEMPLATES */
+
+public:
+  size_type size() const { return rep.size(); }
+  size_type max_size() const { return rep.max_size(); }
+  bool empty() const { return rep.empty(); }
+
+  const_iterator begin() const { return rep.begin(); }
+  const_iterator end() const { return rep.end(); }
+
+  const_iterator find(const key_type& key) const { return rep.find(key); }
+  size_type count(const key_type& key) const { return rep.count(key); }
+  pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+    { return rep.equal_range(key); }
+
+  size_type bucket_count() const { return rep.bucket_count(); }
+};
+
+#ifndef __STL_LIMITED_DEFAULT_TEMPLATES
+template <class Key, class T, class Compare = less<Key> >
+#else
+template <class Key, class T, class Compare>
+#endif
+class frozen_map
+{
+private:
+  typedef __frozen_sorted_table<pair<const Key, T>, Key,
+                                select1st<pair<const Key, T> >,
+                                Compare> rep_type;
+  rep_type t;
+
+public:
+  typedef Key key_type;
+  typedef T data_type;
+  typedef T mapped_type;
+  typedef typename rep_type::value_type value_type;
+  typedef Compare key_compare;
+
+  typedef typename rep_type::size_type size_type;
+  typedef typename rep_type::difference_type difference_type;
+  typedef typename rep_type::const_pointer const_pointer;
+  typedef typename rep_type::const_reference const_reference;
+  typedef typename rep_type::const_iterator const_iterator;
+
+  key_compare key_comp() const { return t.key_comp(); }
+
+public:
+  frozen_map() : t(Compare()) {}
+  explicit frozen_map(const Compare& comp) : t(comp) {}
+
+  bool open(const char* path, bool verify = true)
+  {
+    __frozen_require_pod(typename __type_traits<T>::is_POD_type());
+    return t.open(path, verify);
+  }
+  bool attach(const void* data, size_type len, bool verify = true)
+  {
+    __frozen_require_pod(typename __type_traits<T>::is_POD_type());
+    return t.attach(data, len, verify);
+  }
+  void close() { t.detach(); }
+
+  // [first, last) must be sorted by key.
+#ifdef __STL_MEMBER_TEMPLATES
+  template <class ForwardIterator>
+  static bool write(FILE* f, ForwardIterator first, ForwardIterator last,
+                    const Compare& comp = Compare())
+  {
+    __frozen_require_pod(typename __type_traits<T>::is_POD_type());
+    return rep_type::write(f, first, last, comp);
+  }
+#else /* __STL_MEMBER_TEMPLATES */
+  static bool write(FILE* f, const value_type* first, const value_type* last,
+                    const Compare& comp = Compare())
+  {
+    __frozen_require_pod(typename __type_traits<T>::is_POD_type());
+    return rep_type::write(f, first, last, comp);
+  }
+#endif /* __STL_MEMBER_TEMPLATES */
+
+public:
+  size_type size() const { return t.size(); }
+  size_type max_size() const { return t.max_size(); }
+  bool empty() const { return t.empty(); }
+
+  const_iterator begin() const { return t.begin(); }
+  const_iterator end() const { return t.end(); }
+
+  const_iterator find(const key_type& x) const { return t.find(x); }
+  size_type count(const key_type& x) const { return t.count(x); }
+  const_iterator lower_bound(const key_type& x) const
+    { return t.lower_bound(x); }
+  const_iterator upper_bound(const key_type& x) const
+    { return t.upper_bound(x); }
+  pair<const_iterator, const_iterator> equal_range(const key_type& x) const
+    { return t.equal_range(x); }
+};
+
+#if defined(__sgi) && !defined(__GNUC__) && (_MIPS_SIM != _MIPS_SIM_ABI32)
+#pragma reset woff 1174
+#endif
+
+__STL_END_NAMESPACE
+
+#endif /* __SGI_STL_INTERNAL_FROZEN_MAP_H */
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,537 @@
+/*
+ * Copyright (c) 1996
+ * Silicon Graphics Computer Systems, Inc.
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Silicon Graphics makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ *
+ * Copyright (c) 1994
+ * Hewlett-Packard Company
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Hewlett-Packard Company makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ */
+
+/* NOTE: This is an internal header file, included by other STL headers.
+ *   You should not attempt to use it directly.
+ */
+
+#ifndef __SGI_STL_INTERNAL_FROZEN_TABLE_H
+#define __SGI_STL_INTERNAL_FROZEN_TABLE_H
+
+// Frozen tables, used to implement frozen_hash_map and frozen_map.  A
+// frozen table is a read-only associative table laid out in one block
+// of memory.  write() stores a table in a file; open() maps the file
+// back in, and lookups then run directly on the mapped bytes without
+// building any nodes.
+//
+// Layout, in the writer's byte order and word size:
+//   header          __frozen_header
+//   bucket starts   size_t[bucket_count + 1], hashed tables only
+//   elements        value_type[count], at data_offset
+//
+// A hashed table groups its elements by bucket: bucket b holds elements
+// starts[b] through starts[b + 1] - 1.  A sorted table keeps them in key
+// order.  The checksum covers everything after the header.
+//
+// Elements are written as raw bytes, so the key and data types must be
+// plain old data, as reported by __type_traits, and must not hold
+// pointers.  A hashed table must be read with the hash function that
+// wrote it.
+
+#include <stdio.h>
+#include <stl_algobase.h>
+#include <stl_alloc.h>
+#include <stl_function.h>
+#include <stl_vector.h>
+#include <stl_hash_fun.h>
+#include <stl_mapped_file.h>
+
+__STL_BEGIN_NAMESPACE
+
+struct __frozen_header {
+  char magic[8];
+  size_t version;
+  size_t byte_order;
+  size_t kind;
+  size_t value_size;
+  size_t count;
+  size_t bucket_count;
+  size_t data_offset;
+  size_t checksum;
+};
+
+enum { __frozen_version = 1, __frozen_hashed = 1, __frozen_sorted = 2 };
+
+// The last byte of the magic number is the word size, so a table
+// written with a different size_t is rejected before its header is
+// misread.
+inline void __frozen_magic(char* magic)
+{
+  memcpy(magic, "SGIFROZ", 7);
+  magic[7] = char(sizeof(size_t));
+}
+
+inline size_t __frozen_byte_order() { return 0x01020304ul; }
+
+// Element arrays start on a 16-byte boundary.
+inline size_t __frozen_align(size_t n) { return (n + 15) & ~size_t(15); }
+
+// Only plain old data may be copied as raw bytes.  There is deliberately
+// no overload for __false_type; specialize __type_traits for a struct
+// type to store it in a frozen table.
+inline void __frozen_require_pod(__true_type) {}
+
+inline void __frozen_fill_header(__frozen_header& h, size_t kind,
+                                 size_t value_size, size_t count,
+                                 size_t bucket_count, size_t data_offset)
+{
+  __frozen_magic(h.magic);
+  h.version = __frozen_version;
+  h.byte_order = __frozen_byte_order();
+  h.kind = kind;
+  h.value_size = value_size;
+  h.count = count;
+  h.bucket_count = bucket_count;
+  h.data_offset = data_offset;
+  h.checksum = 0;
+}
+
+// Writes the header and the body that follows it.
+inline bool __frozen_write(FILE* f, __frozen_header& h,
+                           const char* body, size_t body_len)
+{
+  h.checksum = __stl_hash_string(body, body_len);
+  return fwrite(&h, sizeof(h), 1, f) == 1
+         && (body_len == 0 || fwrite(body, body_len, 1, f) == 1);
+}
+
+// Returns the header of the table in [data, data + len), or 0 if the
+// block does not hold a table of this kind and element size.  verify
+// also checks the checksum, which reads the whole block.
+inline const __frozen_header*
+__frozen_validate(const void* data, size_t len, size_t kind,
+                  size_t value_size, bool verify)
+{
+  const __frozen_header* h = (const __frozen_header*) data;
+  char magic[8];
+  __frozen_magic(magic);
+  if (len < sizeof(__frozen_header)
+      || memcmp(h->magic, magic, sizeof(magic)) != 0
+      || h->version != __frozen_version
+      || h->byte_order != __frozen_byte_order()
+      || h->kind != kind || h->value_size != value_size)
+    return 0;
+
+  size_t min_offset = sizeof(__frozen_header);
+  if (kind == __frozen_hashed) {
+    if (h->bucket_count == 0 || h->bucket_count >= len / sizeof(size_t))
+      return 0;
+    min_offset += (h->bucket_count + 1) * sizeof(size_t);
+  }
+  if (h->data_offset < min_offset || h->data_offset > len
+      || (len - h->data_offset) / value_size < h->count)
+    return 0;
+
+  const size_t total = h->data_offset + h->count * value_size;
+  if (verify
+      && __stl_hash_string((const char*) data + sizeof(__frozen_header),
+                           total - sizeof(__frozen_header)) != h->checksum)
+    return 0;
+  return h;
+}
+
+template <class Value, class Key, class HashFcn,
+          class ExtractKey, class EqualKey>
+class __frozen_hashtable {
+public:
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef HashFcn hasher;
+  typedef EqualKey key_equal;
+
+  typedef size_t            size_type;
+  typedef ptrdiff_t         difference_type;
+  typedef const value_type* const_pointer;
+  typedef const value_type& const_reference;
+  typedef const value_type* const_iterator;
+
+  hasher hash_funct() const { return hash; }
+  key_equal key_eq() const { return equals; }
+
+private:
+  hasher hash;
+  key_equal equals;
+  ExtractKey get_key;
+
+  const size_type* starts;
+  const value_type* elems;
+  size_type num_elements;
+  size_type num_buckets;
+  __stl_mapped_file file;
+
+public:
+  __frozen_hashtable(const HashFcn& hf, const EqualKey& eql)
+    : hash(hf), equals(eql), get_key(ExtractKey())
+  {
+    detach();
+  }
+
+  // Uses the table in [data, data + len) in place; the block must stay
+  // valid, and suitably aligned, for as long as it is attached.
+  bool attach(const void* data, size_type len, bool verify = true);
+
+  // Maps the file at path and attaches to it.
+  bool open(const char* path, bool verify = true)
+  {
+    detach();
+    if (file.open(path) && attach(file.data(), file.size(), verify))
+      return true;
+    file.close();
+    return false;
+  }
+
+  void detach()
+  {
+    static const size_type no_starts[2] = { 0, 0 };
+    starts = no_starts;
+    elems = 0;
+    num_elements = 0;
+    num_buckets = 1;
+    file.close();
+  }
+
+  size_type size() const { return num_elements; }
+  size_type max_size() const { return num_elements; }
+  bool empty() const { return num_elements == 0; }
+  size_type bucket_count() const { return num_buckets; }
+
+  const_iterator begin() const { return elems; }
+  const_iterator end() const { return elems + num_elements; }
+
+  const_iterator find(const key_type& key) const
+  {
+    const size_type n = bkt_num_key(key);
+    const value_type* last = elems + starts[n + 1];
+    for (const value_type* cur = elems + starts[n]; cur != last; ++cur)
+      if (equals(get_key(*cur), key))
+        return cur;
+    return end();
+  }
+
+  size_type count(const key_type& key) const
+  {
+    const size_type n = bkt_num_key(key);
+    const value_type* last = elems + starts[n + 1];
+    size_type result = 0;
+    for (const value_type* cur = elems + starts[n]; cur != last; ++cur)
+      if (equals(get_key(*cur), key))
+        ++result;
+    return result;
+  }
+
+  // Equal keys are adjacent within a bucket.
+  pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+  {
+    typedef pair<const_iterator, const_iterator> pii;
+    const value_type* first = find(key);
+    if (first == end())
+      return pii(end(), end());
+    const value_type* last = elems + starts[bkt_num_key(key) + 1];
+    const value_type* cur = first + 1;
+    while (cur != last && equals(get_key(*cur), key))
+      ++cur;
+    return pii(first, cur);
+  }
+
+#ifdef __STL_MEMBER_TEMPLATES
+  template <class ForwardIterator>
+  static bool write(FILE* f, ForwardIterator first, ForwardIterator last,
+                    const HashFcn& hf = HashFcn())
+  {
+    size_type n = 0;
+    distance(first, last, n);
+    return write_n(f, first, n, hf);
+  }
+#else /* __STL_MEMBER_TEMPLATES */
+  static bool write(FILE* f, const value_type* first, const value_type* last,
+                    const HashFcn& hf = HashFcn())
+  {
+    return write_n(f, first, size_type(last - first), hf);
+  }
+#endif /* __STL_MEMBER_TEMPLATES */
+
+private:
+  static size_type bucket(size_type h, size_type n)
+  {
+    return __stl_hash_mix(h) & (n - 1);
+  }
+
+  size_type bkt_num_key(const key_type& key) const
+  {
+    return bucket(hash(key), num_buckets);
+  }
+
+#ifdef __STL_MEMBER_TEMPLATES
+  template <class ForwardIterator>
+  static bool write_n(FILE* f, ForwardIterator first, size_type n,
+                      const HashFcn& hf);
+#else /* __STL_MEMBER_TEMPLATES */
+  static bool write_n(FILE* f, const value_type* first, size_type n,
+                      const HashFcn& hf);
+#endif /* __STL_MEMBER_TEMPLATES */
+
+  __frozen_hashtable(const __frozen_hashtable&);
+  void operator=(const __frozen_hashtable&);
+};
+
+template <class V, class K, class HF, class Ex, class Eq>
+bool __frozen_hashtable<V, K, HF, Ex, Eq>::attach(const void* data,
+                                                  size_type len, bool verify)
+{
+  __frozen_require_pod(typename __type_traits<K>::is_POD_type());
+  const __frozen_header* h =
+    __frozen_validate(data, len, __frozen_hashed, sizeof(V), verify);
+  if (!h)
+    return false;
+
+  const size_type* s =
+    (const size_type*) ((const char*) data + sizeof(__frozen_header));
+  const size_type nb = h->bucket_count;
+  if ((nb & (nb - 1)) != 0 || s[0] != 0 || s[nb] != h->count)
+    return false;
+  if (verify)
+    for (size_type i = 0; i < nb; ++i)
+      if (s[i] > s[i + 1])
+        return false;
+
+  starts = s;
+  elems = (const V*) ((const char*) data + h->data_offset);
+  num_elements = h->count;
+  num_buckets = nb;
+  return true;
+}
+
+// Two passes over the input: the first counts the elements of each
+// bucket, the second copies each element to its place.
+template <class V, class K, class HF, class Ex, class Eq>
+#ifdef __STL_MEMBER_TEMPLATES
+template <class ForwardIterator>
+bool __frozen_hashtable<V, K, HF, Ex, Eq>::write_n(FILE* f,
+                                                   ForwardIterator first,
+                                                   size_type n, const HF& hf)
+#else /* __STL_MEMBER_TEMPLATES */
+bool __frozen_hashtable<V, K, HF, Ex, Eq>::write_n(FILE* f, const V* first,
+                                                   size_type n, const HF& hf)
+#endif /* __STL_MEMBER_TEMPLATES */
+{
+  __frozen_require_pod(typename __type_traits<K>::is_POD_type());
+  Ex get_key;
+  size_type nb = 1;
+  while (nb < n)
+    nb <<= 1;
+
+  const size_type data_offset =
+    __frozen_align(sizeof(__frozen_header) + (nb + 1) * sizeof(size_type));
+  const size_type body_len =
+    data_offset - sizeof(__frozen_header) + n * sizeof(V);
+  vector<char, alloc> body(body_len, char(0));
+  size_type* s = (size_type*) &body[0];
+  char* out = &body[0] + (data_offset - sizeof(__frozen_header));
+
+  vector<size_type, alloc> bkt(n);
+  size_type i;
+#ifdef __STL_MEMBER_TEMPLATES
+  ForwardIterator cur = first;
+#else
+  const V* cur = first;
+#endif
+  for (i = 0; i < n; ++i, ++cur) {
+    bkt[i] = bucket(hf(get_key(*cur)), nb);
+    ++s[bkt[i] + 1];
+  }
+  for (i = 1; i <= nb; ++i)
+    s[i] += s[i - 1];
+
+  vector<size_type, alloc> next(s, s + nb);
+  for (cur = first, i = 0; i < n; ++i, ++cur)
+    memcpy(out + next[bkt[i]]++ * sizeof(V), &*cur, sizeof(V));
+
+  __frozen_header h;
+  __frozen_fill_header(h, __frozen_hashed, sizeof(V), n, nb, data_offset);
+  return __frozen_write(f, h, &body[0], body_len);
+}
+
+template <class Value, class Key, class ExtractKey, class Compare>
+class __frozen_sorted_table {
+public:
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef Compare key_compare;
+
+  typedef size_t            size_type;
+  typedef ptrdiff_t         difference_type;
+  typedef const value_type* const_pointer;
+  typedef const value_type& const_reference;
+  typedef const value_type* const_iterator;
+
+  key_compare key_comp() const { return comp; }
+
+private:
+  key_compare comp;
+  ExtractKey get_key;
+
+  const value_type* elems;
+  size_type num_elements;
+  __stl_mapped_file file;
+
+public:
+  explicit __frozen_sorted_table(const Compare& c)
+    : comp(c), get_key(ExtractKey()), elems(0), num_elements(0) {}
+
+  bool attach(const void* data, size_type len, bool verify = true)
+  {
+    __frozen_require_pod(typename __type_traits<Key>::is_POD_type());
+    const __frozen_header* h =
+      __frozen_validate(data, len, __frozen_sorted, sizeof(Value), verify);
+    if (!h)
+      return false;
+    elems = (const Value*) ((const char*) data + h->data_offset);
+    num_elements = h->count;
+    return true;
+  }
+
+  bool open(const char* path, bool verify = true)
+  {
+    detach();
+    if (file.open(path) && attach(file.data(), file.size(), verify))
+      return true;
+    file.close();
+    return false;
+  }
+
+  void detach()
+  {
+    elems = 0;
+    num_elements = 0;
+    file.close();
+  }
+
+  size_type size() const { return num_elements; }
+  size_type max_size() const { return num_elements; }
+  bool empty() const { return num_elements == 0; }
+
+  const_iterator begin() const { return elems; }
+  const_iterator end() const { return elems + num_elements; }
+
+  const_iterator lower_bound(const key_type& key) const
+  {
+    const value_type* first = elems;
+    size_type len = num_elements;
+    while (len > 0) {
+      const size_type half = len >> 1;
+      const value_type* middle = first + half;
+      if (comp(get_key(*middle), key)) {
+        first = middle + 1;
+        len = len - half - 1;
+      }
+      else
+        len = half;
+    }
+    return first;
+  }
+
+  const_iterator upper_bound(const key_type& key) const
+  {
+    const value_type* first = elems;
+    size_type len = num_elements;
+    while (len > 0) {
+      const size_type half = len >> 1;
+      const value_type* middle = first + half;
+      if (comp(key, get_key(*middle)))
+        len = half;
+      else {
+        first = middle + 1;
+        len = len - half - 1;
+      }
+    }
+    return first;
+  }
+
+  const_iterator find(const key_type& key) const
+  {
+    const value_type* j = lower_bound(key);
+    return (j == end() || comp(key, get_key(*j))) ? end() : j;
+  }
+
+  size_type count(const key_type& key) const
+  {
+    return upper_bound(key) - lower_bound(key);
+  }
+
+  pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+  {
+    return pair<const_iterator, const_iterator>(lower_bound(key),
+                                                upper_bound(key));
+  }
+
+  // The input must already be in key order, as a map's is; write()
+  // returns false without writing anything otherwise.
+#ifdef __STL_MEMBER_TEMPLATES
+  template <class ForwardIterator>
+  static bool write(FILE* f, ForwardIterator first, ForwardIterator last,
+                    const Compare& c = Compare())
+#else /* __STL_MEMBER_TEMPLATES */
+  static bool write(FILE* f, const value_type* first, const value_type* last,
+                    const Compare& c = Compare())
+#endif /* __STL_MEMBER_TEMPLATES */
+  {
+    __frozen_require_pod(typename __type_traits<Key>::is_POD_type());
+    ExtractKey get_key;
+    size_type n = 0;
+    distance(first, last, n);
+
+    const size_type data_offset = __frozen_align(sizeof(__frozen_header));
+    const size_type body_len =
+      data_offset - sizeof(__frozen_header) + n * sizeof(Value);
+    vector<char, alloc> body(body_len + 1, char(0));
+    char* out = &body[0] + (data_offset - sizeof(__frozen_header));
+
+    for (size_type i = 0; first != last; ++i, ++first) {
+      if (i > 0 && c(get_key(*first),
+                     get_key(*(const Value*) (out - sizeof(Value)))))
+        return false;
+      memcpy(out, &*first, sizeof(Value));
+      out += sizeof(Value);
+    }
+
+    __frozen_header h;
+    __frozen_fill_header(h, __frozen_sorted, sizeof(Value), n, 0,
+                         data_offset);
+    return __frozen_write(f, h, &body[0], body_len);
+  }
+
+private:
+  __frozen_sorted_table(const __frozen_sorted_table&);
+  void operator=(const __frozen_sorted_table&);
+};
+
+__STL_END_NAMESPACE
+
+#endif /* __SGI_STL_INTERNAL_FROZEN_TABLE_H */
+
+// Local Variables:
+// mode:C++
+// End:
@@ -126,6 +126,41 @@ struct less_equal : public binary_function<T, T, bool>
   bool operator()(const T &x, const T &y) const { return x <= y; }
 };
 
+#ifdef __STL_MEMBER_TEMPLATES
+
+// Comparisons that accept any pair of argument types.  They declare
+// is_transparent, which lets the associative containers look up a key
+// by a value of another type, such as a string key by a const char*,
+// without constructing a key_type.
+__STL_TEMPLATE_NULL struct equal_to<void>
+{
+  typedef void is_transparent;
+  template <class T, class U>
+  bool operator()(const T &x, const U &y) const { return x == y; }
+};
+
+__STL_TEMPLATE_NULL struct less<void>
+{
+  typedef void is_transparent;
+  template <class T, class U>
+  bool operator()(const T &x, const U &y) const { return x < y; }
+};
+
+// The containers' heterogeneous lookup members take a defaulted argument
+// of this type, so that a member drops out of overload resolution unless
+// Fn declares is_transparent.  Naming K makes the check part of template
+// argument deduction.
+template <class Fn, class K>
+struct __stl_transparent
+{
+  typedef Fn type;
+};
+
+#define __STL_IF_TRANSPARENT(Fn, K) \
+  typename __stl_transparent<Fn, K>::type::is_transparent * = 0
+
+#endif /* __STL_MEMBER_TEMPLATES */
+
 template <class T>
 struct logical_and : public binary_function<T, T, bool>
 {
@@ -32,18 +32,74 @@
 #define __SGI_STL_HASH_FUN_H
 
 #include <stddef.h>
+#include <string.h>
 
 __STL_BEGIN_NAMESPACE
 
 template <class Key> struct hash { };
 
+// Finalizer for containers that take their bucket or probe position from
+// the high bits of a hash code.  The functors below return the key itself
+// for integral types, so the multiply folds the low bits upward and the
+// shift brings the result back down.
+inline size_t __stl_hash_mix(size_t h)
+{
+  const size_t mul = (size_t(0x9E3779B9ul) << 16 << 16) | 0x7F4A7C15ul;
+  h *= mul;
+  return h ^ (h >> (sizeof(size_t) * 4));
+}
+
+// Stronger finalizer for hash codes built up from many words, so that
+// every bit of the input reaches every bit of the result.  The shifts
+// and multipliers are those of splitmix64, scaled to the width of size_t.
+inline size_t __stl_hash_finish(size_t h)
+{
+  const int half = sizeof(size_t) * 4;
+  h ^= h >> (half - 2);
+  h *= (size_t(0xBF58476Dul) << 16 << 16) | 0x1CE4E5B9ul;
+  h ^= h >> (half - 5);
+  h *= (size_t(0x94D049BBul) << 16 << 16) | 0x133111EBul;
+  return h ^ (h >> (half - 1));
+}
+
+// Hashes n bytes a machine word at a time.  Each word is mixed before it
+// is folded into the running value, so keys that differ only near the
+// end (as URLs and path names tend to) still differ in every bit of the
+// result.
+inline size_t __stl_hash_string(const char* s, size_t n)
+{
+  size_t h = __stl_hash_mix(n);
+  size_t w;
+  if (n >= 4 * sizeof(size_t)) {
+    // Two independent chains, so that long keys are not limited by the
+    // latency of one multiply per word.
+    size_t h2 = ~h;
+    size_t w2;
+    do {
+      memcpy(&w, s, sizeof(size_t));
+      memcpy(&w2, s + sizeof(size_t), sizeof(size_t));
+      h = __stl_hash_mix(h ^ w);
+      h2 = __stl_hash_mix(h2 ^ w2);
+      s += 2 * sizeof(size_t);
+      n -= 2 * sizeof(size_t);
+    } while (n >= 2 * sizeof(size_t));
+    h = __stl_hash_mix(h ^ __stl_hash_finish(h2));
+  }
+  for ( ; n >= sizeof(size_t); s += sizeof(size_t), n -= sizeof(size_t)) {
+    memcpy(&w, s, sizeof(size_t));
+    h = __stl_hash_mix(h ^ w);
+  }
+  if (n > 0) {
+    w = 0;
+    memcpy(&w, s, n);
+    h = __stl_hash_mix(h ^ w);
+  }
+  return __stl_hash_finish(h);
+}
+
 inline size_t __stl_hash_string(const char* s)
 {
-  unsigned long h = 0; 
-  for ( ; *s; ++s)
-    h = 5*h + *s;
-  
-  return size_t(h);
+  return __stl_hash_string(s, strlen(s));
 }
 
 __STL_TEMPLATE_NULL struct hash<char*>
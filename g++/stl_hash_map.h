@@ -41,16 +41,18 @@ __STL_BEGIN_NAMESPACE
 #ifndef __STL_LIMITED_DEFAULT_TEMPLATES
 template <class Key, class T, class HashFcn = hash<Key>,
           class EqualKey = equal_to<Key>,
-          class Alloc = alloc>
+          class Alloc = alloc,
+          class Policy = hash_prime_policy>
 #else
 template <class Key, class T, class HashFcn, class EqualKey, 
-          class Alloc = alloc>
+          class Alloc = alloc, class Policy = hash_prime_policy>
 #endif
 class hash_map
 {
 private:
   typedef hashtable<pair<const Key, T>, Key, HashFcn,
-                    select1st<pair<const Key, T> >, EqualKey, Alloc> ht;
+                    select1st<pair<const Key, T> >, EqualKey, Alloc,
+                    Policy> ht;
   ht rep;
 
 public:
@@ -140,6 +142,10 @@ public:
 #ifdef __STL_MEMBER_TEMPLATES
   template <class InputIterator>
   void insert(InputIterator f, InputIterator l) { rep.insert_unique(f,l); }
+  template <class RandomAccessIterator>
+  void insert_parallel(RandomAccessIterator f, RandomAccessIterator l,
+                       size_type n_threads)
+    { rep.insert_unique_parallel(f, l, n_threads); }
 #else
   void insert(const value_type* f, const value_type* l) {
     rep.insert_unique(f,l);
@@ -163,6 +169,32 @@ public:
   pair<const_iterator, const_iterator> equal_range(const key_type& key) const
     { return rep.equal_range(key); }
 
+#ifdef __STL_MEMBER_TEMPLATES
+  // Lookup by another type; see hashtable.
+  template <class K>
+  iterator find(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                __STL_IF_TRANSPARENT(EqualKey, K))
+    { return rep.find(key); }
+  template <class K>
+  const_iterator find(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                      __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.find(key); }
+  template <class K>
+  size_type count(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                  __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.count(key); }
+  template <class K>
+  pair<iterator, iterator>
+  equal_range(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+              __STL_IF_TRANSPARENT(EqualKey, K))
+    { return rep.equal_range(key); }
+  template <class K>
+  pair<const_iterator, const_iterator>
+  equal_range(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+              __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.equal_range(key); }
+#endif /* __STL_MEMBER_TEMPLATES */
+
   size_type erase(const key_type& key) {return rep.erase(key); }
   void erase(iterator it) { rep.erase(it); }
   void erase(iterator f, iterator l) { rep.erase(f, l); }
@@ -174,20 +206,29 @@ public:
   size_type max_bucket_count() const { return rep.max_bucket_count(); }
   size_type elems_in_bucket(size_type n) const
     { return rep.elems_in_bucket(n); }
+
+  float load_factor() const { return rep.load_factor(); }
+  float max_load_factor() const { return rep.max_load_factor(); }
+  void max_load_factor(float z) { rep.max_load_factor(z); }
+  void reserve(size_type n) { rep.reserve(n); }
+  void rehash(size_type n) { rep.rehash(n); }
 };
 
-template <class Key, class T, class HashFcn, class EqualKey, class Alloc>
-inline bool operator==(const hash_map<Key, T, HashFcn, EqualKey, Alloc>& hm1,
-                       const hash_map<Key, T, HashFcn, EqualKey, Alloc>& hm2)
+template <class Key, class T, class HashFcn, class EqualKey, class Alloc,
+          class Policy>
+inline bool
+operator==(const hash_map<Key, T, HashFcn, EqualKey, Alloc, Policy>& hm1,
+           const hash_map<Key, T, HashFcn, EqualKey, Alloc, Policy>& hm2)
 {
   return hm1.rep == hm2.rep;
 }
 
 #ifdef __STL_FUNCTION_TMPL_PARTIAL_ORDER
 
-template <class Key, class T, class HashFcn, class EqualKey, class Alloc>
-inline void swap(hash_map<Key, T, HashFcn, EqualKey, Alloc>& hm1,
-                 hash_map<Key, T, HashFcn, EqualKey, Alloc>& hm2)
+template <class Key, class T, class HashFcn, class EqualKey, class Alloc,
+          class Policy>
+inline void swap(hash_map<Key, T, HashFcn, EqualKey, Alloc, Policy>& hm1,
+                 hash_map<Key, T, HashFcn, EqualKey, Alloc, Policy>& hm2)
 {
   hm1.swap(hm2);
 }
@@ -197,16 +238,18 @@ inline void swap(hash_map<Key, T, HashFcn, EqualKey, Alloc>& hm1,
 #ifndef __STL_LIMITED_DEFAULT_TEMPLATES
 template <class Key, class T, class HashFcn = hash<Key>,
           class EqualKey = equal_to<Key>,
-          class Alloc = alloc>
+          class Alloc = alloc,
+          class Policy = hash_prime_policy>
 #else
 template <class Key, class T, class HashFcn, class EqualKey,
-          class Alloc = alloc>
+          class Alloc = alloc, class Policy = hash_prime_policy>
 #endif
 class hash_multimap
 {
 private:
   typedef hashtable<pair<const Key, T>, Key, HashFcn,
-                    select1st<pair<const Key, T> >, EqualKey, Alloc> ht;
+                    select1st<pair<const Key, T> >, EqualKey, Alloc,
+                    Policy> ht;
   ht rep;
 
 public:
@@ -295,6 +338,10 @@ public:
 #ifdef __STL_MEMBER_TEMPLATES
   template <class InputIterator>
   void insert(InputIterator f, InputIterator l) { rep.insert_equal(f,l); }
+  template <class RandomAccessIterator>
+  void insert_parallel(RandomAccessIterator f, RandomAccessIterator l,
+                       size_type n_threads)
+    { rep.insert_equal_parallel(f, l, n_threads); }
 #else
   void insert(const value_type* f, const value_type* l) {
     rep.insert_equal(f,l);
@@ -314,6 +361,32 @@ public:
   pair<const_iterator, const_iterator> equal_range(const key_type& key) const
     { return rep.equal_range(key); }
 
+#ifdef __STL_MEMBER_TEMPLATES
+  // Lookup by another type; see hashtable.
+  template <class K>
+  iterator find(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                __STL_IF_TRANSPARENT(EqualKey, K))
+    { return rep.find(key); }
+  template <class K>
+  const_iterator find(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                      __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.find(key); }
+  template <class K>
+  size_type count(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                  __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.count(key); }
+  template <class K>
+  pair<iterator, iterator>
+  equal_range(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+              __STL_IF_TRANSPARENT(EqualKey, K))
+    { return rep.equal_range(key); }
+  template <class K>
+  pair<const_iterator, const_iterator>
+  equal_range(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+              __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.equal_range(key); }
+#endif /* __STL_MEMBER_TEMPLATES */
+
   size_type erase(const key_type& key) {return rep.erase(key); }
   void erase(iterator it) { rep.erase(it); }
   void erase(iterator f, iterator l) { rep.erase(f, l); }
@@ -325,20 +398,29 @@ public:
   size_type max_bucket_count() const { return rep.max_bucket_count(); }
   size_type elems_in_bucket(size_type n) const
     { return rep.elems_in_bucket(n); }
+
+  float load_factor() const { return rep.load_factor(); }
+  float max_load_factor() const { return rep.max_load_factor(); }
+  void max_load_factor(float z) { rep.max_load_factor(z); }
+  void reserve(size_type n) { rep.reserve(n); }
+  void rehash(size_type n) { rep.rehash(n); }
 };
 
-template <class Key, class T, class HF, class EqKey, class Alloc>
-inline bool operator==(const hash_multimap<Key, T, HF, EqKey, Alloc>& hm1,
-                       const hash_multimap<Key, T, HF, EqKey, Alloc>& hm2)
+template <class Key, class T, class HF, class EqKey, class Alloc,
+          class Policy>
+inline bool
+operator==(const hash_multimap<Key, T, HF, EqKey, Alloc, Policy>& hm1,
+           const hash_multimap<Key, T, HF, EqKey, Alloc, Policy>& hm2)
 {
   return hm1.rep == hm2.rep;
 }
 
 #ifdef __STL_FUNCTION_TMPL_PARTIAL_ORDER
 
-template <class Key, class T, class HashFcn, class EqualKey, class Alloc>
-inline void swap(hash_multimap<Key, T, HashFcn, EqualKey, Alloc>& hm1,
-                 hash_multimap<Key, T, HashFcn, EqualKey, Alloc>& hm2)
+template <class Key, class T, class HashFcn, class EqualKey, class Alloc,
+          class Policy>
+inline void swap(hash_multimap<Key, T, HashFcn, EqualKey, Alloc, Policy>& hm1,
+                 hash_multimap<Key, T, HashFcn, EqualKey, Alloc, Policy>& hm2)
 {
   hm1.swap(hm2);
 }
@@ -40,15 +40,17 @@ __STL_BEGIN_NAMESPACE
 #ifndef __STL_LIMITED_DEFAULT_TEMPLATES
 template <class Value, class HashFcn = hash<Value>,
           class EqualKey = equal_to<Value>,
-          class Alloc = alloc>
+          class Alloc = alloc,
+          class Policy = hash_prime_policy>
 #else
-template <class Value, class HashFcn, class EqualKey, class Alloc = alloc>
+template <class Value, class HashFcn, class EqualKey, class Alloc = alloc,
+          class Policy = hash_prime_policy>
 #endif
 class hash_set
 {
 private:
   typedef hashtable<Value, Value, HashFcn, identity<Value>, 
-                    EqualKey, Alloc> ht;
+                    EqualKey, Alloc, Policy> ht;
   ht rep;
 
 public:
@@ -137,6 +139,10 @@ public:
 #ifdef __STL_MEMBER_TEMPLATES
   template <class InputIterator>
   void insert(InputIterator f, InputIterator l) { rep.insert_unique(f,l); }
+  template <class RandomAccessIterator>
+  void insert_parallel(RandomAccessIterator f, RandomAccessIterator l,
+                       size_type n_threads)
+    { rep.insert_unique_parallel(f, l, n_threads); }
 #else
   void insert(const value_type* f, const value_type* l) {
     rep.insert_unique(f,l);
@@ -156,6 +162,23 @@ public:
   pair<iterator, iterator> equal_range(const key_type& key) const
     { return rep.equal_range(key); }
 
+#ifdef __STL_MEMBER_TEMPLATES
+  // Lookup by another type; see hashtable.
+  template <class K>
+  iterator find(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.find(key); }
+  template <class K>
+  size_type count(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                  __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.count(key); }
+  template <class K>
+  pair<iterator, iterator>
+  equal_range(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+              __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.equal_range(key); }
+#endif /* __STL_MEMBER_TEMPLATES */
+
   size_type erase(const key_type& key) {return rep.erase(key); }
   void erase(iterator it) { rep.erase(it); }
   void erase(iterator f, iterator l) { rep.erase(f, l); }
@@ -167,20 +190,29 @@ public:
   size_type max_bucket_count() const { return rep.max_bucket_count(); }
   size_type elems_in_bucket(size_type n) const
     { return rep.elems_in_bucket(n); }
+
+  float load_factor() const { return rep.load_factor(); }
+  float max_load_factor() const { return rep.max_load_factor(); }
+  void max_load_factor(float z) { rep.max_load_factor(z); }
+  void reserve(size_type n) { rep.reserve(n); }
+  void rehash(size_type n) { rep.rehash(n); }
 };
 
-template <class Value, class HashFcn, class EqualKey, class Alloc>
-inline bool operator==(const hash_set<Value, HashFcn, EqualKey, Alloc>& hs1,
-                       const hash_set<Value, HashFcn, EqualKey, Alloc>& hs2)
+template <class Value, class HashFcn, class EqualKey, class Alloc,
+          class Policy>
+inline bool
+operator==(const hash_set<Value, HashFcn, EqualKey, Alloc, Policy>& hs1,
+           const hash_set<Value, HashFcn, EqualKey, Alloc, Policy>& hs2)
 {
   return hs1.rep == hs2.rep;
 }
 
 #ifdef __STL_FUNCTION_TMPL_PARTIAL_ORDER
 
-template <class Val, class HashFcn, class EqualKey, class Alloc>
-inline void swap(hash_set<Val, HashFcn, EqualKey, Alloc>& hs1,
-                 hash_set<Val, HashFcn, EqualKey, Alloc>& hs2) {
+template <class Val, class HashFcn, class EqualKey, class Alloc,
+          class Policy>
+inline void swap(hash_set<Val, HashFcn, EqualKey, Alloc, Policy>& hs1,
+                 hash_set<Val, HashFcn, EqualKey, Alloc, Policy>& hs2) {
   hs1.swap(hs2);
 }
 
@@ -190,15 +222,17 @@ inline void swap(hash_set<Val, HashFcn, EqualKey, Alloc>& hs1,
 #ifndef __STL_LIMITED_DEFAULT_TEMPLATES
 template <class Value, class HashFcn = hash<Value>,
           class EqualKey = equal_to<Value>,
-          class Alloc = alloc>
+          class Alloc = alloc,
+          class Policy = hash_prime_policy>
 #else
-template <class Value, class HashFcn, class EqualKey, class Alloc = alloc>
+template <class Value, class HashFcn, class EqualKey, class Alloc = alloc,
+          class Policy = hash_prime_policy>
 #endif
 class hash_multiset
 {
 private:
   typedef hashtable<Value, Value, HashFcn, identity<Value>, 
-                    EqualKey, Alloc> ht;
+                    EqualKey, Alloc, Policy> ht;
   ht rep;
 
 public:
@@ -283,6 +317,10 @@ public:
 #ifdef __STL_MEMBER_TEMPLATES
   template <class InputIterator>
   void insert(InputIterator f, InputIterator l) { rep.insert_equal(f,l); }
+  template <class RandomAccessIterator>
+  void insert_parallel(RandomAccessIterator f, RandomAccessIterator l,
+                       size_type n_threads)
+    { rep.insert_equal_parallel(f, l, n_threads); }
 #else
   void insert(const value_type* f, const value_type* l) {
     rep.insert_equal(f,l);
@@ -299,6 +337,23 @@ public:
   pair<iterator, iterator> equal_range(const key_type& key) const
     { return rep.equal_range(key); }
 
+#ifdef __STL_MEMBER_TEMPLATES
+  // Lookup by another type; see hashtable.
+  template <class K>
+  iterator find(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.find(key); }
+  template <class K>
+  size_type count(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                  __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.count(key); }
+  template <class K>
+  pair<iterator, iterator>
+  equal_range(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+              __STL_IF_TRANSPARENT(EqualKey, K)) const
+    { return rep.equal_range(key); }
+#endif /* __STL_MEMBER_TEMPLATES */
+
   size_type erase(const key_type& key) {return rep.erase(key); }
   void erase(iterator it) { rep.erase(it); }
   void erase(iterator f, iterator l) { rep.erase(f, l); }
@@ -310,20 +365,29 @@ public:
   size_type max_bucket_count() const { return rep.max_bucket_count(); }
   size_type elems_in_bucket(size_type n) const
     { return rep.elems_in_bucket(n); }
+
+  float load_factor() const { return rep.load_factor(); }
+  float max_load_factor() const { return rep.max_load_factor(); }
+  void max_load_factor(float z) { rep.max_load_factor(z); }
+  void reserve(size_type n) { rep.reserve(n); }
+  void rehash(size_type n) { rep.rehash(n); }
 };
 
-template <class Val, class HashFcn, class EqualKey, class Alloc>
-inline bool operator==(const hash_multiset<Val, HashFcn, EqualKey, Alloc>& hs1,
-                       const hash_multiset<Val, HashFcn, EqualKey, Alloc>& hs2)
+template <class Val, class HashFcn, class EqualKey, class Alloc,
+          class Policy>
+inline bool
+operator==(const hash_multiset<Val, HashFcn, EqualKey, Alloc, Policy>& hs1,
+           const hash_multiset<Val, HashFcn, EqualKey, Alloc, Policy>& hs2)
 {
   return hs1.rep == hs2.rep;
 }
 
 #ifdef __STL_FUNCTION_TMPL_PARTIAL_ORDER
 
-template <class Val, class HashFcn, class EqualKey, class Alloc>
-inline void swap(hash_multiset<Val, HashFcn, EqualKey, Alloc>& hs1,
-                 hash_multiset<Val, HashFcn, EqualKey, Alloc>& hs2)
+template <class Val, class HashFcn, class EqualKey, class Alloc,
+          class Policy>
+inline void swap(hash_multiset<Val, HashFcn, EqualKey, Alloc, Policy>& hs1,
+                 hash_multiset<Val, HashFcn, EqualKey, Alloc, Policy>& hs2)
 {
   hs1.swap(hs2);
 }
@@ -43,40 +43,69 @@
 #include <stl_function.h>
 #include <stl_vector.h>
 #include <stl_hash_fun.h>
+#include <stl_threads.h>
 
 __STL_BEGIN_NAMESPACE
 
-template <class Value>
-struct __hashtable_node
+struct hash_prime_policy;
+
+// Storage for a node's hash code, when the bucket policy asks for one.
+// The general case stores nothing and never reports a mismatch.
+template <bool Cached>
+struct __hashtable_hash_code
+{
+  void set_hash(size_t) {}
+  size_t stored_hash() const { return 0; }
+  bool hash_differs(size_t) const { return false; }
+};
+
+__STL_TEMPLATE_NULL struct __hashtable_hash_code<true>
+{
+  size_t hash_code;
+  void set_hash(size_t h) { hash_code = h; }
+  size_t stored_hash() const { return hash_code; }
+  bool hash_differs(size_t h) const { return hash_code != h; }
+};
+
+// An iterator's bucket when it does not know it.  Iterators that know
+// their bucket move to the next chain without hashing the current key.
+static const size_t __stl_no_bucket = size_t(-1);
+
+template <class Value, bool Cached = false>
+struct __hashtable_node : public __hashtable_hash_code<Cached>
 {
   __hashtable_node* next;
   Value val;
 };  
 
 template <class Value, class Key, class HashFcn,
-          class ExtractKey, class EqualKey, class Alloc = alloc>
+          class ExtractKey, class EqualKey, class Alloc = alloc,
+          class Policy = hash_prime_policy>
 class hashtable;
 
 template <class Value, class Key, class HashFcn,
-          class ExtractKey, class EqualKey, class Alloc>
+          class ExtractKey, class EqualKey, class Alloc,
+          class Policy>
 struct __hashtable_iterator;
 
 template <class Value, class Key, class HashFcn,
-          class ExtractKey, class EqualKey, class Alloc>
+          class ExtractKey, class EqualKey, class Alloc,
+          class Policy>
 struct __hashtable_const_iterator;
 
 template <class Value, class Key, class HashFcn,
-          class ExtractKey, class EqualKey, class Alloc>
+          class ExtractKey, class EqualKey, class Alloc,
+          class Policy>
 struct __hashtable_iterator {
-  typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>
+  typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc, Policy>
           hashtable;
   typedef __hashtable_iterator<Value, Key, HashFcn, 
-                               ExtractKey, EqualKey, Alloc>
+                               ExtractKey, EqualKey, Alloc, Policy>
           iterator;
   typedef __hashtable_const_iterator<Value, Key, HashFcn, 
-                                     ExtractKey, EqualKey, Alloc>
+                                     ExtractKey, EqualKey, Alloc, Policy>
           const_iterator;
-  typedef __hashtable_node<Value> node;
+  typedef __hashtable_node<Value, bool(Policy::cache_hash_code)> node;
 
   typedef forward_iterator_tag iterator_category;
   typedef Value value_type;
@@ -87,8 +116,12 @@ struct __hashtable_iterator {
 
   node* cur;
   hashtable* ht;
+  size_type bucket;
 
-  __hashtable_iterator(node* n, hashtable* tab) : cur(n), ht(tab) {}
+  __hashtable_iterator(node* n, hashtable* tab)
+    : cur(n), ht(tab), bucket(__stl_no_bucket) {}
+  __hashtable_iterator(node* n, hashtable* tab, size_type b)
+    : cur(n), ht(tab), bucket(b) {}
   __hashtable_iterator() {}
   reference operator*() const { return cur->val; }
 #ifndef __SGI_STL_NO_ARROW_OPERATOR
@@ -102,17 +135,18 @@ struct __hashtable_iterator {
 
 
 template <class Value, class Key, class HashFcn,
-          class ExtractKey, class EqualKey, class Alloc>
+          class ExtractKey, class EqualKey, class Alloc,
+          class Policy>
 struct __hashtable_const_iterator {
-  typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>
+  typedef hashtable<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc, Policy>
           hashtable;
   typedef __hashtable_iterator<Value, Key, HashFcn, 
-                               ExtractKey, EqualKey, Alloc>
+                               ExtractKey, EqualKey, Alloc, Policy>
           iterator;
   typedef __hashtable_const_iterator<Value, Key, HashFcn, 
-                                     ExtractKey, EqualKey, Alloc>
+                                     ExtractKey, EqualKey, Alloc, Policy>
           const_iterator;
-  typedef __hashtable_node<Value> node;
+  typedef __hashtable_node<Value, bool(Policy::cache_hash_code)> node;
 
   typedef forward_iterator_tag iterator_category;
   typedef Value value_type;
@@ -123,11 +157,16 @@ struct __hashtable_const_iterator {
 
   const node* cur;
   const hashtable* ht;
+  size_type bucket;
 
   __hashtable_const_iterator(const node* n, const hashtable* tab)
-    : cur(n), ht(tab) {}
+    : cur(n), ht(tab), bucket(__stl_no_bucket) {}
+  __hashtable_const_iterator(const node* n, const hashtable* tab,
+                             size_type b)
+    : cur(n), ht(tab), bucket(b) {}
   __hashtable_const_iterator() {}
-  __hashtable_const_iterator(const iterator& it) : cur(it.cur), ht(it.ht) {}
+  __hashtable_const_iterator(const iterator& it)
+    : cur(it.cur), ht(it.ht), bucket(it.bucket) {}
   reference operator*() const { return cur->val; }
 #ifndef __SGI_STL_NO_ARROW_OPERATOR
   pointer operator->() const { return &(operator*()); }
@@ -158,10 +197,71 @@ inline unsigned long __stl_next_prime(unsigned long n)
   return pos == last ? *(last - 1) : *pos;
 }
 
+// Bucket policies.  A policy chooses the bucket count for a requested
+// number of buckets and maps a hash code to a bucket.  It is the last
+// template argument of hashtable and of the hashed containers.
+//
+// rehash_step is the number of old buckets that the insertion growing
+// the table moves into the new array.  Zero means that resize moves
+// every element at once.
+//
+// cache_hash_code is nonzero if each node keeps its key's hash code.
+
+// Prime bucket counts, and the hash code modulo the bucket count.  This
+// is the default; it behaves well even with weak hash functions.
+struct hash_prime_policy {
+  static size_t next_size(size_t n) { return __stl_next_prime(n); }
+  static size_t max_bucket_count()
+    { return __stl_prime_list[__stl_num_primes - 1]; }
+  static size_t bucket(size_t h, size_t n) { return h % n; }
+  enum { rehash_step = 0, cache_hash_code = 0 };
+};
+
+// Power-of-two bucket counts, so the bucket is a mask rather than an
+// integer division.  The mask keeps only the low bits, so the hash code
+// is mixed first.
+struct hash_pow2_policy {
+  static size_t next_size(size_t n)
+  {
+    size_t result = 16;
+    while (result < n && result < max_bucket_count())
+      result <<= 1;
+    return result;
+  }
+  static size_t max_bucket_count()
+    { return size_t(1) << (sizeof(size_t) * 8 - 1); }
+  static size_t bucket(size_t h, size_t n)
+    { return __stl_hash_mix(h) & (n - 1); }
+  enum { rehash_step = 0, cache_hash_code = 0 };
+};
+
+// Splits the cost of each resize between two insertions instead of
+// stalling one: the insertion that grows the table moves Step old
+// buckets, and the next one that grows it moves the rest.  Until then
+// the table keeps both bucket arrays.  Lookups check the old bucket of
+// a key while it is non-empty, and a key is inserted into its old bucket
+// while that is non-empty, so that equal keys are never split between
+// the two arrays.  Only an insertion that grows the table moves
+// elements, so, as with the other policies, other insertions and
+// erasures invalidate no iterators.
+template <class BasePolicy = hash_prime_policy, size_t Step = 64>
+struct hash_incremental_policy : public BasePolicy {
+  enum { rehash_step = Step };
+};
+
+// Keeps the hash code in every node, at the cost of one word per
+// element.  Lookups compare keys only when the hash codes match, and
+// a resize never calls the hash function.  Worthwhile when keys are
+// expensive to hash or to compare, as strings are.
+template <class BasePolicy = hash_prime_policy>
+struct hash_cached_policy : public BasePolicy {
+  enum { cache_hash_code = 1 };
+};
+
 
 template <class Value, class Key, class HashFcn,
           class ExtractKey, class EqualKey,
-          class Alloc>
+          class Alloc, class Policy>
 class hashtable {
 public:
   typedef Key key_type;
@@ -184,32 +284,41 @@ private:
   key_equal equals;
   ExtractKey get_key;
 
-  typedef __hashtable_node<Value> node;
+  typedef __hashtable_node<Value, bool(Policy::cache_hash_code)> node;
   typedef simple_alloc<node, Alloc> node_allocator;
 
   vector<node*,Alloc> buckets;
   size_type num_elements;
+  float max_load;
+
+  // Buckets not yet moved by an incremental rehash, and the next one to
+  // move.  old_buckets is empty when no rehash is in progress.
+  vector<node*,Alloc> old_buckets;
+  size_type rehash_pos;
 
 public:
   typedef __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, 
-                               Alloc>
+                               Alloc, Policy>
   iterator;
 
   typedef __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey,
-                                     Alloc>
+                                     Alloc, Policy>
   const_iterator;
 
   friend struct
-  __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>;
+  __hashtable_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc,
+                       Policy>;
   friend struct
-  __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc>;
+  __hashtable_const_iterator<Value, Key, HashFcn, ExtractKey, EqualKey, Alloc,
+                             Policy>;
 
 public:
   hashtable(size_type n,
             const HashFcn&    hf,
             const EqualKey&   eql,
             const ExtractKey& ext)
-    : hash(hf), equals(eql), get_key(ext), num_elements(0)
+    : hash(hf), equals(eql), get_key(ext), num_elements(0),
+      max_load(1.0f), rehash_pos(0)
   {
     initialize_buckets(n);
   }
@@ -217,13 +326,15 @@ public:
   hashtable(size_type n,
             const HashFcn&    hf,
             const EqualKey&   eql)
-    : hash(hf), equals(eql), get_key(ExtractKey()), num_elements(0)
+    : hash(hf), equals(eql), get_key(ExtractKey()), num_elements(0),
+      max_load(1.0f), rehash_pos(0)
   {
     initialize_buckets(n);
   }
 
   hashtable(const hashtable& ht)
-    : hash(ht.hash), equals(ht.equals), get_key(ht.get_key), num_elements(0)
+    : hash(ht.hash), equals(ht.equals), get_key(ht.get_key), num_elements(0),
+      max_load(ht.max_load), rehash_pos(0)
   {
     copy_from(ht);
   }
@@ -235,6 +346,7 @@ public:
       hash = ht.hash;
       equals = ht.equals;
       get_key = ht.get_key;
+      max_load = ht.max_load;
       copy_from(ht);
     }
     return *this;
@@ -253,24 +365,25 @@ public:
     __STD::swap(get_key, ht.get_key);
     buckets.swap(ht.buckets);
     __STD::swap(num_elements, ht.num_elements);
+    __STD::swap(max_load, ht.max_load);
+    old_buckets.swap(ht.old_buckets);
+    __STD::swap(rehash_pos, ht.rehash_pos);
   }
 
   iterator begin()
-  { 
-    for (size_type n = 0; n < buckets.size(); ++n)
-      if (buckets[n])
-        return iterator(buckets[n], this);
-    return end();
+  {
+    size_type bucket;
+    node* first = first_node(bucket);
+    return iterator(first, this, bucket);
   }
 
   iterator end() { return iterator(0, this); }
 
   const_iterator begin() const
   {
-    for (size_type n = 0; n < buckets.size(); ++n)
-      if (buckets[n])
-        return const_iterator(buckets[n], this);
-    return end();
+    size_type bucket;
+    const node* first = first_node(bucket);
+    return const_iterator(first, this, bucket);
   }
 
   const_iterator end() const { return const_iterator(0, this); }
@@ -283,7 +396,7 @@ public:
   size_type bucket_count() const { return buckets.size(); }
 
   size_type max_bucket_count() const
-    { return __stl_prime_list[__stl_num_primes - 1]; } 
+    { return Policy::max_bucket_count(); } 
 
   size_type elems_in_bucket(size_type bucket) const
   {
@@ -395,14 +508,43 @@ public:
   }
 #endif /*__STL_MEMBER_TEMPLATES */
 
+#ifdef __STL_MEMBER_TEMPLATES
+  // Insert [f, l) using up to n_threads threads.  The buckets are split
+  // into one contiguous range per thread, and each thread links the
+  // elements whose keys fall in its range, so the threads never touch
+  // the same chain and take no locks.  The result is the same as that
+  // of insert_unique(f, l) or insert_equal(f, l).  n_threads is capped
+  // at the number of processors, and 0 asks for one per processor.  The
+  // threads allocate nodes at the same time, so with an allocator that
+  // serves one thread only, such as single_client_alloc, the elements
+  // are inserted one by one on the calling thread.  So are they when an
+  // incremental rehash is under way and the insertion does not grow the
+  // table, since the threads can link only into the new bucket array.
+  // While it runs, the table must not be used by any other thread, and
+  // it needs two words of temporary storage per element.
+  template <class RandomAccessIterator>
+  void insert_unique_parallel(RandomAccessIterator f, RandomAccessIterator l,
+                              size_type n_threads)
+  {
+    insert_parallel(f, size_type(l - f), n_threads, true);
+  }
+
+  template <class RandomAccessIterator>
+  void insert_equal_parallel(RandomAccessIterator f, RandomAccessIterator l,
+                             size_type n_threads)
+  {
+    insert_parallel(f, size_type(l - f), n_threads, false);
+  }
+#endif /* __STL_MEMBER_TEMPLATES */
+
   reference find_or_insert(const value_type& obj);
 
   iterator find(const key_type& key) 
   {
-    size_type n = bkt_num_key(key);
+    const size_type h = hash(key);
     node* first;
-    for ( first = buckets[n];
-          first && !equals(get_key(first->val), key);
+    for ( first = chain_for_hash(h);
+          first && !node_equals(first, key, h);
           first = first->next)
       {}
     return iterator(first, this);
@@ -410,10 +552,10 @@ public:
 
   const_iterator find(const key_type& key) const
   {
-    size_type n = bkt_num_key(key);
+    const size_type h = hash(key);
     const node* first;
-    for ( first = buckets[n];
-          first && !equals(get_key(first->val), key);
+    for ( first = chain_for_hash(h);
+          first && !node_equals(first, key, h);
           first = first->next)
       {}
     return const_iterator(first, this);
@@ -421,11 +563,11 @@ public:
 
   size_type count(const key_type& key) const
   {
-    const size_type n = bkt_num_key(key);
+    const size_type h = hash(key);
     size_type result = 0;
 
-    for (const node* cur = buckets[n]; cur; cur = cur->next)
-      if (equals(get_key(cur->val), key))
+    for (const node* cur = chain_for_hash(h); cur; cur = cur->next)
+      if (node_equals(cur, key, h))
         ++result;
     return result;
   }
@@ -433,6 +575,94 @@ public:
   pair<iterator, iterator> equal_range(const key_type& key);
   pair<const_iterator, const_iterator> equal_range(const key_type& key) const;
 
+#ifdef __STL_MEMBER_TEMPLATES
+  // Lookup by any type K that both the hash function and the key
+  // equality accept, if both declare is_transparent.  hash(k) must equal
+  // the hash of every key that compares equal to k.
+  template <class K>
+  iterator find(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                __STL_IF_TRANSPARENT(EqualKey, K))
+  {
+    const size_type h = hash(key);
+    node* first;
+    for ( first = chain_for_hash(h);
+          first && !node_equals(first, key, h);
+          first = first->next)
+      {}
+    return iterator(first, this);
+  }
+
+  template <class K>
+  const_iterator find(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                      __STL_IF_TRANSPARENT(EqualKey, K)) const
+  {
+    const size_type h = hash(key);
+    const node* first;
+    for ( first = chain_for_hash(h);
+          first && !node_equals(first, key, h);
+          first = first->next)
+      {}
+    return const_iterator(first, this);
+  }
+
+  template <class K>
+  size_type count(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+                  __STL_IF_TRANSPARENT(EqualKey, K)) const
+  {
+    const size_type h = hash(key);
+    size_type result = 0;
+
+    for (const node* cur = chain_for_hash(h); cur; cur = cur->next)
+      if (node_equals(cur, key, h))
+        ++result;
+    return result;
+  }
+
+  template <class K>
+  pair<iterator, iterator>
+  equal_range(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+              __STL_IF_TRANSPARENT(EqualKey, K))
+  {
+    typedef pair<iterator, iterator> pii;
+    const size_type h = hash(key);
+
+    for (node* first = chain_for_hash(h); first; first = first->next) {
+      if (node_equals(first, key, h)) {
+        for (node* cur = first->next; cur; cur = cur->next)
+          if (!node_equals(cur, key, h))
+            return pii(iterator(first, this), iterator(cur, this));
+        size_type bucket = __stl_no_bucket;
+        node* last = next_bucket_start(first, bucket);
+        return pii(iterator(first, this), iterator(last, this, bucket));
+      }
+    }
+    return pii(end(), end());
+  }
+
+  template <class K>
+  pair<const_iterator, const_iterator>
+  equal_range(const K& key, __STL_IF_TRANSPARENT(HashFcn, K),
+              __STL_IF_TRANSPARENT(EqualKey, K)) const
+  {
+    typedef pair<const_iterator, const_iterator> pii;
+    const size_type h = hash(key);
+
+    for (const node* first = chain_for_hash(h); first; first = first->next) {
+      if (node_equals(first, key, h)) {
+        for (const node* cur = first->next; cur; cur = cur->next)
+          if (!node_equals(cur, key, h))
+            return pii(const_iterator(first, this),
+                       const_iterator(cur, this));
+        size_type bucket = __stl_no_bucket;
+        const node* last = next_bucket_start(first, bucket);
+        return pii(const_iterator(first, this),
+                   const_iterator(last, this, bucket));
+      }
+    }
+    return pii(end(), end());
+  }
+#endif /* __STL_MEMBER_TEMPLATES */
+
   size_type erase(const key_type& key);
   void erase(const iterator& it);
   void erase(iterator first, iterator last);
@@ -443,8 +673,32 @@ public:
   void resize(size_type num_elements_hint);
   void clear();
 
+  // The table grows once size() / bucket_count() would pass the maximum
+  // load factor.  Lower values trade memory for shorter chains.
+  float load_factor() const { return float(num_elements) / buckets.size(); }
+  float max_load_factor() const { return max_load; }
+  void max_load_factor(float z)
+  {
+    __stl_assert(z > 0);
+    max_load = z;
+    resize(num_elements);
+  }
+
+  void reserve(size_type n) { resize(n); }
+
+  // Unlike resize, rehash may also shrink the table.
+  void rehash(size_type n);
+
 private:
-  size_type next_size(size_type n) const { return __stl_next_prime(n); }
+  size_type next_size(size_type n) const { return Policy::next_size(n); }
+
+  // Buckets needed to hold n elements within the maximum load factor.
+  size_type buckets_for(size_type n) const
+  {
+    const float f = n / max_load;
+    size_type result = size_type(f);
+    return result < f ? result + 1 : result;
+  }
 
   void initialize_buckets(size_type n)
   {
@@ -466,7 +720,7 @@ private:
 
   size_type bkt_num_key(const key_type& key, size_t n) const
   {
-    return hash(key) % n;
+    return Policy::bucket(hash(key), n);
   }
 
   size_type bkt_num(const value_type& obj, size_t n) const
@@ -474,10 +728,37 @@ private:
     return bkt_num_key(get_key(obj), n);
   }
 
-  node* new_node(const value_type& obj)
+  // The hash code of an element's key, from the node if it keeps one.
+  size_type node_hash(const node* p) const
+  {
+    return Policy::cache_hash_code ? p->stored_hash() : hash(get_key(p->val));
+  }
+
+  size_type node_bkt_num(const node* p, size_t n) const
+  {
+    return Policy::bucket(node_hash(p), n);
+  }
+
+  // h is hash(key).  Nodes that keep their hash code are rejected without
+  // calling equals unless the codes match.
+  bool node_equals(const node* p, const key_type& key, size_type h) const
+  {
+    return !p->hash_differs(h) && equals(get_key(p->val), key);
+  }
+
+#ifdef __STL_MEMBER_TEMPLATES
+  template <class K>
+  bool node_equals(const node* p, const K& key, size_type h) const
+  {
+    return !p->hash_differs(h) && equals(get_key(p->val), key);
+  }
+#endif /* __STL_MEMBER_TEMPLATES */
+
+  node* new_node(const value_type& obj, size_type h)
   {
     node* n = node_allocator::allocate();
     n->next = 0;
+    n->set_hash(h);
     __STL_TRY {
       construct(&n->val, obj);
       return n;
@@ -491,53 +772,175 @@ private:
     node_allocator::deallocate(n);
   }
 
+  // Links obj into its bucket without counting it.  Used by parallel
+  // insertion, which adds to num_elements once the threads are done.
+  bool link_unique(const value_type& obj, size_type h);
+  void link_equal(const value_type& obj, size_type h);
+
+#ifdef __STL_MEMBER_TEMPLATES
+  // State shared by the threads of a parallel insertion.  Task t hashes
+  // and later scatters elements [t * n / n_tasks, (t + 1) * n / n_tasks)
+  // of the input, then links the elements that fall in buckets
+  // [t * span, (t + 1) * span).
+  struct bulk_insert {
+    hashtable* table;
+    const void* first;                  // Points to the input iterator.
+    size_type n;
+    size_type n_tasks;
+    size_type span;
+    bool unique;
+    vector<size_type, Alloc> codes;     // Hash code of each element.
+    vector<size_type, Alloc> cursor;    // [task * n_tasks + owner]
+    vector<size_type, Alloc> order;     // Element indices, by owner.
+    vector<size_type, Alloc> region;    // Each owner's part of order.
+    vector<size_type, Alloc> progress;  // Next entry of order to link.
+    vector<size_type, Alloc> added;     // Elements linked, by owner.
+
+    size_type owner(size_type h) const
+      { return Policy::bucket(h, table->buckets.size()) / span; }
+    size_type chunk(size_type t) const
+      { return n / n_tasks * t + n % n_tasks * t / n_tasks; }
+    size_type total_added() const
+    {
+      size_type result = 0;
+      for (size_type t = 0; t < n_tasks; ++t)
+        result += added[t];
+      return result;
+    }
+  };
+
+  template <class RandomAccessIterator>
+  void insert_parallel(RandomAccessIterator f, size_type n,
+                       size_type n_threads, bool unique);
+  template <class RandomAccessIterator>
+  static void bulk_hash(void* p, size_t task);
+  static void bulk_scatter(void* p, size_t task);
+  template <class RandomAccessIterator>
+  static void bulk_link(void* p, size_t task);
+#endif /* __STL_MEMBER_TEMPLATES */
+
   void erase_bucket(const size_type n, node* first, node* last);
   void erase_bucket(const size_type n, node* last);
 
   void copy_from(const hashtable& ht);
 
+  bool rehashing() const { return !old_buckets.empty(); }
+
+  // The chain that holds the keys with hash code h, if any element with
+  // such a key exists.
+  node* chain_for_hash(size_type h) const
+  {
+    if (rehashing()) {
+      node* old_chain = old_buckets[Policy::bucket(h, old_buckets.size())];
+      if (old_chain)
+        return old_chain;
+    }
+    return buckets[Policy::bucket(h, buckets.size())];
+  }
+
+  // The bucket array that holds the keys with hash code h, and their
+  // bucket in it: the key's old bucket while that is non-empty.  Nodes
+  // are inserted and erased there, so that neither moves any others.
+  vector<node*,Alloc>& table_for_hash(size_type h, size_type& n)
+  {
+    if (rehashing()) {
+      n = Policy::bucket(h, old_buckets.size());
+      if (old_buckets[n])
+        return old_buckets;
+    }
+    n = Policy::bucket(h, buckets.size());
+    return buckets;
+  }
+
+  static bool in_chain(const node* first, const node* p)
+  {
+    for ( ; first; first = first->next)
+      if (first == p)
+        return true;
+    return false;
+  }
+
+  // Finds the bucket that holds p; returns true if it is an old bucket.
+  bool locate(const node* p, size_type& bucket) const
+  {
+    const size_type h = node_hash(p);
+    if (rehashing()) {
+      bucket = Policy::bucket(h, old_buckets.size());
+      if (in_chain(old_buckets[bucket], p))
+        return true;
+    }
+    bucket = Policy::bucket(h, buckets.size());
+    return false;
+  }
+
+  // Iteration visits the old buckets first while a rehash is in progress.
+  // bucket is set to the new bucket of the result, or to __stl_no_bucket
+  // for an old one.  Nodes move between the arrays only when the table
+  // grows, which invalidates iterators anyway.
+  node* first_node(size_type& bucket) const
+  {
+    for (size_type n = rehash_pos; n < old_buckets.size(); ++n)
+      if (old_buckets[n]) {
+        bucket = __stl_no_bucket;
+        return old_buckets[n];
+      }
+    return first_node_from(0, bucket);
+  }
+
+  node* first_node_from(size_type n, size_type& bucket) const
+  {
+    for ( ; n < buckets.size(); ++n)
+      if (buckets[n]) {
+        bucket = n;
+        return buckets[n];
+      }
+    return 0;
+  }
+
+  // The first node of the chain after p's.  bucket is p's bucket, or
+  // __stl_no_bucket if not known; it is updated as by first_node.
+  node* next_bucket_start(const node* p, size_type& bucket) const;
+
+  void migrate_bucket(size_type bucket);
+  void rehash_some(size_type count);
+  void rebucket(size_type n);
+
 };
 
-template <class V, class K, class HF, class ExK, class EqK, class A>
-__hashtable_iterator<V, K, HF, ExK, EqK, A>&
-__hashtable_iterator<V, K, HF, ExK, EqK, A>::operator++()
+template <class V, class K, class HF, class ExK, class EqK, class A, class P>
+__hashtable_iterator<V, K, HF, ExK, EqK, A, P>&
+__hashtable_iterator<V, K, HF, ExK, EqK, A, P>::operator++()
 {
   const node* old = cur;
   cur = cur->next;
-  if (!cur) {
-    size_type bucket = ht->bkt_num(old->val);
-    while (!cur && ++bucket < ht->buckets.size())
-      cur = ht->buckets[bucket];
-  }
+  if (!cur)
+    cur = ht->next_bucket_start(old, bucket);
   return *this;
 }
 
-template <class V, class K, class HF, class ExK, class EqK, class A>
-inline __hashtable_iterator<V, K, HF, ExK, EqK, A>
-__hashtable_iterator<V, K, HF, ExK, EqK, A>::operator++(int)
+template <class V, class K, class HF, class ExK, class EqK, class A, class P>
+inline __hashtable_iterator<V, K, HF, ExK, EqK, A, P>
+__hashtable_iterator<V, K, HF, ExK, EqK, A, P>::operator++(int)
 {
   iterator tmp = *this;
   ++*this;
   return tmp;
 }
 
-template <class V, class K, class HF, class ExK, class EqK, class A>
-__hashtable_const_iterator<V, K, HF, ExK, EqK, A>&
-__hashtable_const_iterator<V, K, HF, ExK, EqK, A>::operator++()
+template <class V, class K, class HF, class ExK, class EqK, class A, class P>
+__hashtable_const_iterator<V, K, HF, ExK, EqK, A, P>&
+__hashtable_const_iterator<V, K, HF, ExK, EqK, A, P>::operator++()
 {
   const node* old = cur;
   cur = cur->next;
-  if (!cur) {
-    size_type bucket = ht->bkt_num(old->val);
-    while (!cur && ++bucket < ht->buckets.size())
-      cur = ht->buckets[bucket];
-  }
+  if (!cur)
+    cur = ht->next_bucket_start(old, bucket);
   return *this;
 }
 
-template <class V, class K, class HF, class ExK, class EqK, class A>
-inline __hashtable_const_iterator<V, K, HF, ExK, EqK, A>
-__hashtable_const_iterator<V, K, HF, ExK, EqK, A>::operator++(int)
+template <class V, class K, class HF, class ExK, class EqK, class A, class P>
+inline __hashtable_const_iterator<V, K, HF, ExK, EqK, A, P>
+__hashtable_const_iterator<V, K, HF, ExK, EqK, A, P>::operator++(int)
 {
   const_iterator tmp = *this;
   ++*this;
@@ -546,56 +949,69 @@ __hashtable_const_iterator<V, K, HF, ExK, EqK, A>::operator++(int)
 
 #ifndef __STL_CLASS_PARTIAL_SPECIALIZATION
 
-template <class V, class K, class HF, class ExK, class EqK, class All>
+template <class V, class K, class HF, class ExK, class EqK, class All, class P>
 inline forward_iterator_tag
-iterator_category(const __hashtable_iterator<V, K, HF, ExK, EqK, All>&)
+iterator_category(const __hashtable_iterator<V, K, HF, ExK, EqK, All, P>&)
 {
   return forward_iterator_tag();
 }
 
-template <class V, class K, class HF, class ExK, class EqK, class All>
-inline V* value_type(const __hashtable_iterator<V, K, HF, ExK, EqK, All>&)
+template <class V, class K, class HF, class ExK, class EqK, class All, class P>
+inline V* value_type(const __hashtable_iterator<V, K, HF, ExK, EqK, All, P>&)
 {
   return (V*) 0;
 }
 
-template <class V, class K, class HF, class ExK, class EqK, class All>
-inline hashtable<V, K, HF, ExK, EqK, All>::difference_type*
-distance_type(const __hashtable_iterator<V, K, HF, ExK, EqK, All>&)
+template <class V, class K, class HF, class ExK, class EqK, class All, class P>
+inline hashtable<V, K, HF, ExK, EqK, All, P>::difference_type*
+distance_type(const __hashtable_iterator<V, K, HF, ExK, EqK, All, P>&)
 {
-  return (hashtable<V, K, HF, ExK, EqK, All>::difference_type*) 0;
+  return (hashtable<V, K, HF, ExK, EqK, All, P>::difference_type*) 0;
 }
 
-template <class V, class K, class HF, class ExK, class EqK, class All>
+template <class V, class K, class HF, class ExK, class EqK, class All, class P>
 inline forward_iterator_tag
-iterator_category(const __hashtable_const_iterator<V, K, HF, ExK, EqK, All>&)
+iterator_category(
+  const __hashtable_const_iterator<V, K, HF, ExK, EqK, All, P>&)
 {
   return forward_iterator_tag();
 }
 
-template <class V, class K, class HF, class ExK, class EqK, class All>
+template <class V, class K, class HF, class ExK, class EqK, class All, class P>
 inline V* 
-value_type(const __hashtable_const_iterator<V, K, HF, ExK, EqK, All>&)
+value_type(const __hashtable_const_iterator<V, K, HF, ExK, EqK, All, P>&)
 {
   return (V*) 0;
 }
 
-template <class V, class K, class HF, class ExK, class EqK, class All>
-inline hashtable<V, K, HF, ExK, EqK, All>::difference_type*
-distance_type(const __hashtable_const_iterator<V, K, HF, ExK, EqK, All>&)
+template <class V, class K, class HF, class ExK, class EqK, class All, class P>
+inline hashtable<V, K, HF, ExK, EqK, All, P>::difference_type*
+distance_type(const __hashtable_const_iterator<V, K, HF, ExK, EqK, All, P>&)
 {
-  return (hashtable<V, K, HF, ExK, EqK, All>::difference_type*) 0;
+  return (hashtable<V, K, HF, ExK, EqK, All, P>::difference_type*) 0;
 }
 
 #endif /* __STL_CLASS_PARTIAL_SPECIALIZATION */
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-bool operator==(const hashtable<V, K, HF, Ex, Eq, A>& ht1,
-                const hashtable<V, K, HF, Ex, Eq, A>& ht2)
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+bool operator==(const hashtable<V, K, HF, Ex, Eq, A, P>& ht1,
+                const hashtable<V, K, HF, Ex, Eq, A, P>& ht2)
 {
-  typedef typename hashtable<V, K, HF, Ex, Eq, A>::node node;
+  typedef typename hashtable<V, K, HF, Ex, Eq, A, P>::node node;
+  typedef typename hashtable<V, K, HF, Ex, Eq, A, P>::const_iterator
+          const_iterator;
   if (ht1.buckets.size() != ht2.buckets.size())
     return false;
+  if (ht1.rehashing() || ht2.rehashing()) {
+    if (ht1.size() != ht2.size())
+      return false;
+    const_iterator it1 = ht1.begin();
+    const_iterator it2 = ht2.begin();
+    for ( ; it1 != ht1.end(); ++it1, ++it2)
+      if (!(*it1 == *it2))
+        return false;
+    return true;
+  }
   for (int n = 0; n < ht1.buckets.size(); ++n) {
     node* cur1 = ht1.buckets[n];
     node* cur2 = ht2.buckets[n];
@@ -610,136 +1026,313 @@ bool operator==(const hashtable<V, K, HF, Ex, Eq, A>& ht1,
 
 #ifdef __STL_FUNCTION_TMPL_PARTIAL_ORDER
 
-template <class Val, class Key, class HF, class Extract, class EqKey, class A>
-inline void swap(hashtable<Val, Key, HF, Extract, EqKey, A>& ht1,
-                 hashtable<Val, Key, HF, Extract, EqKey, A>& ht2) {
+template <class Val, class Key, class HF, class Extract, class EqKey, class A,
+          class P>
+inline void swap(hashtable<Val, Key, HF, Extract, EqKey, A, P>& ht1,
+                 hashtable<Val, Key, HF, Extract, EqKey, A, P>& ht2) {
   ht1.swap(ht2);
 }
 
 #endif /* __STL_FUNCTION_TMPL_PARTIAL_ORDER */
 
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-pair<typename hashtable<V, K, HF, Ex, Eq, A>::iterator, bool> 
-hashtable<V, K, HF, Ex, Eq, A>::insert_unique_noresize(const value_type& obj)
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+pair<typename hashtable<V, K, HF, Ex, Eq, A, P>::iterator, bool> 
+hashtable<V, K, HF, Ex, Eq, A, P>
+  ::insert_unique_noresize(const value_type& obj)
 {
-  const size_type n = bkt_num(obj);
-  node* first = buckets[n];
+  const size_type h = hash(get_key(obj));
+  size_type n;
+  vector<node*, A>& table = table_for_hash(h, n);
+  node* first = table[n];
 
   for (node* cur = first; cur; cur = cur->next) 
-    if (equals(get_key(cur->val), get_key(obj)))
+    if (node_equals(cur, get_key(obj), h))
       return pair<iterator, bool>(iterator(cur, this), false);
 
-  node* tmp = new_node(obj);
+  node* tmp = new_node(obj, h);
   tmp->next = first;
-  buckets[n] = tmp;
+  table[n] = tmp;
   ++num_elements;
   return pair<iterator, bool>(iterator(tmp, this), true);
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-typename hashtable<V, K, HF, Ex, Eq, A>::iterator 
-hashtable<V, K, HF, Ex, Eq, A>::insert_equal_noresize(const value_type& obj)
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+typename hashtable<V, K, HF, Ex, Eq, A, P>::iterator 
+hashtable<V, K, HF, Ex, Eq, A, P>::insert_equal_noresize(const value_type& obj)
 {
-  const size_type n = bkt_num(obj);
-  node* first = buckets[n];
+  const size_type h = hash(get_key(obj));
+  size_type n;
+  vector<node*, A>& table = table_for_hash(h, n);
+  node* first = table[n];
 
   for (node* cur = first; cur; cur = cur->next) 
-    if (equals(get_key(cur->val), get_key(obj))) {
-      node* tmp = new_node(obj);
+    if (node_equals(cur, get_key(obj), h)) {
+      node* tmp = new_node(obj, h);
       tmp->next = cur->next;
       cur->next = tmp;
       ++num_elements;
       return iterator(tmp, this);
     }
 
-  node* tmp = new_node(obj);
+  node* tmp = new_node(obj, h);
   tmp->next = first;
-  buckets[n] = tmp;
+  table[n] = tmp;
   ++num_elements;
   return iterator(tmp, this);
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-typename hashtable<V, K, HF, Ex, Eq, A>::reference 
-hashtable<V, K, HF, Ex, Eq, A>::find_or_insert(const value_type& obj)
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+bool hashtable<V, K, HF, Ex, Eq, A, P>::link_unique(const value_type& obj,
+                                                    size_type h)
 {
-  resize(num_elements + 1);
+  const size_type n = P::bucket(h, buckets.size());
+  node* first = buckets[n];
+
+  for (node* cur = first; cur; cur = cur->next)
+    if (node_equals(cur, get_key(obj), h))
+      return false;
+
+  node* tmp = new_node(obj, h);
+  tmp->next = first;
+  buckets[n] = tmp;
+  return true;
+}
 
-  size_type n = bkt_num(obj);
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::link_equal(const value_type& obj,
+                                                   size_type h)
+{
+  const size_type n = P::bucket(h, buckets.size());
   node* first = buckets[n];
 
   for (node* cur = first; cur; cur = cur->next)
-    if (equals(get_key(cur->val), get_key(obj)))
-      return cur->val;
+    if (node_equals(cur, get_key(obj), h)) {
+      node* tmp = new_node(obj, h);
+      tmp->next = cur->next;
+      cur->next = tmp;
+      return;
+    }
 
-  node* tmp = new_node(obj);
+  node* tmp = new_node(obj, h);
   tmp->next = first;
   buckets[n] = tmp;
+}
+
+#ifdef __STL_MEMBER_TEMPLATES
+
+// Each thread should have a few thousand elements to insert, or
+// starting it costs more than it saves.
+static const size_t __stl_parallel_insert_grain = 4096;
+
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+template <class RandomAccessIterator>
+void hashtable<V, K, HF, Ex, Eq, A, P>
+  ::insert_parallel(RandomAccessIterator f, size_type n,
+                    size_type n_threads, bool unique)
+{
+  // The threads link into the new array only.  If resize grew the
+  // table, iterators are invalid already and the old buckets can be
+  // moved; otherwise the elements go in one at a time.
+  const size_type old_size = buckets.size();
+  resize(num_elements + n);
+  if (rehashing() && buckets.size() != old_size)
+    rehash_some(old_buckets.size());
+
+  const size_type cpus = __stl_processor_count();
+  if (n_threads == 0 || (cpus != 0 && n_threads > cpus))
+    n_threads = cpus;
+  size_type n_tasks = n / __stl_parallel_insert_grain;
+  if (n_tasks > n_threads)
+    n_tasks = n_threads;
+  if (n_tasks <= 1 || __alloc_single_client<A>::value || rehashing()) {
+    for ( ; n > 0; --n, ++f)
+      if (unique)
+        insert_unique_noresize(*f);
+      else
+        insert_equal_noresize(*f);
+    return;
+  }
+
+  bulk_insert s;
+  s.table = this;
+  s.first = &f;
+  s.n = n;
+  s.n_tasks = n_tasks;
+  s.span = (buckets.size() + n_tasks - 1) / n_tasks;
+  s.unique = unique;
+  s.codes.resize(n);
+  s.cursor.resize(n_tasks * n_tasks);
+  s.order.resize(n);
+  s.region.resize(n_tasks + 1);
+  s.progress.resize(n_tasks);
+  s.added.resize(n_tasks);
+
+  __stl_run_tasks(n_tasks, &bulk_hash<RandomAccessIterator>, &s);
+
+  // Turn the counts into positions in order: the elements of each owner
+  // are contiguous, and within them, in input order.
+  size_type pos = 0;
+  for (size_type owner = 0; owner < n_tasks; ++owner) {
+    s.region[owner] = s.progress[owner] = pos;
+    for (size_type t = 0; t < n_tasks; ++t) {
+      const size_type count = s.cursor[t * n_tasks + owner];
+      s.cursor[t * n_tasks + owner] = pos;
+      pos += count;
+    }
+  }
+  s.region[n_tasks] = n;
+
+  __stl_run_tasks(n_tasks, &bulk_scatter, &s);
+
+  __STL_TRY {
+    __stl_run_tasks(n_tasks, &bulk_link<RandomAccessIterator>, &s);
+  }
+  __STL_UNWIND(num_elements += s.total_added());
+  num_elements += s.total_added();
+}
+
+// Hashes a chunk of the input and counts its elements by owner.  It may
+// be restarted, so it starts its counts from zero.
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+template <class RandomAccessIterator>
+void hashtable<V, K, HF, Ex, Eq, A, P>::bulk_hash(void* p, size_t task)
+{
+  bulk_insert& s = *(bulk_insert*) p;
+  const hashtable& table = *s.table;
+  const RandomAccessIterator first = *(const RandomAccessIterator*) s.first;
+  size_type* count = &s.cursor[task * s.n_tasks];
+  fill(count, count + s.n_tasks, size_type(0));
+  const size_type last = s.chunk(task + 1);
+  for (size_type i = s.chunk(task); i < last; ++i) {
+    const size_type h = table.hash(table.get_key(*(first + i)));
+    s.codes[i] = h;
+    ++count[s.owner(h)];
+  }
+}
+
+// Calls no user code, so it cannot throw and is never restarted.
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::bulk_scatter(void* p, size_t task)
+{
+  bulk_insert& s = *(bulk_insert*) p;
+  size_type* cursor = &s.cursor[task * s.n_tasks];
+  const size_type last = s.chunk(task + 1);
+  for (size_type i = s.chunk(task); i < last; ++i)
+    s.order[cursor[s.owner(s.codes[i])]++] = i;
+}
+
+// Links the elements of one owner.  A restart resumes after the last
+// element linked.
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+template <class RandomAccessIterator>
+void hashtable<V, K, HF, Ex, Eq, A, P>::bulk_link(void* p, size_t task)
+{
+  bulk_insert& s = *(bulk_insert*) p;
+  hashtable& table = *s.table;
+  const RandomAccessIterator first = *(const RandomAccessIterator*) s.first;
+  const size_type last = s.region[task + 1];
+  size_type k = s.progress[task];
+  size_type added = 0;
+  __STL_TRY {
+    for ( ; k < last; ++k) {
+      const size_type i = s.order[k];
+      if (s.unique)
+        added += table.link_unique(*(first + i), s.codes[i]);
+      else {
+        table.link_equal(*(first + i), s.codes[i]);
+        ++added;
+      }
+    }
+  }
+  __STL_UNWIND((s.progress[task] = k, s.added[task] += added));
+  s.progress[task] = k;
+  s.added[task] += added;
+}
+
+#endif /* __STL_MEMBER_TEMPLATES */
+
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+typename hashtable<V, K, HF, Ex, Eq, A, P>::reference 
+hashtable<V, K, HF, Ex, Eq, A, P>::find_or_insert(const value_type& obj)
+{
+  resize(num_elements + 1);
+  const size_type h = hash(get_key(obj));
+
+  size_type n;
+  vector<node*, A>& table = table_for_hash(h, n);
+  node* first = table[n];
+
+  for (node* cur = first; cur; cur = cur->next)
+    if (node_equals(cur, get_key(obj), h))
+      return cur->val;
+
+  node* tmp = new_node(obj, h);
+  tmp->next = first;
+  table[n] = tmp;
   ++num_elements;
   return tmp->val;
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-pair<typename hashtable<V, K, HF, Ex, Eq, A>::iterator,
-     typename hashtable<V, K, HF, Ex, Eq, A>::iterator> 
-hashtable<V, K, HF, Ex, Eq, A>::equal_range(const key_type& key)
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+pair<typename hashtable<V, K, HF, Ex, Eq, A, P>::iterator,
+     typename hashtable<V, K, HF, Ex, Eq, A, P>::iterator> 
+hashtable<V, K, HF, Ex, Eq, A, P>::equal_range(const key_type& key)
 {
   typedef pair<iterator, iterator> pii;
-  const size_type n = bkt_num_key(key);
+  const size_type h = hash(key);
 
-  for (node* first = buckets[n]; first; first = first->next) {
-    if (equals(get_key(first->val), key)) {
+  for (node* first = chain_for_hash(h); first; first = first->next) {
+    if (node_equals(first, key, h)) {
       for (node* cur = first->next; cur; cur = cur->next)
-        if (!equals(get_key(cur->val), key))
+        if (!node_equals(cur, key, h))
           return pii(iterator(first, this), iterator(cur, this));
-      for (size_type m = n + 1; m < buckets.size(); ++m)
-        if (buckets[m])
-          return pii(iterator(first, this),
-                     iterator(buckets[m], this));
-      return pii(iterator(first, this), end());
+      size_type bucket = __stl_no_bucket;
+      node* last = next_bucket_start(first, bucket);
+      return pii(iterator(first, this), iterator(last, this, bucket));
     }
   }
   return pii(end(), end());
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-pair<typename hashtable<V, K, HF, Ex, Eq, A>::const_iterator, 
-     typename hashtable<V, K, HF, Ex, Eq, A>::const_iterator> 
-hashtable<V, K, HF, Ex, Eq, A>::equal_range(const key_type& key) const
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+pair<typename hashtable<V, K, HF, Ex, Eq, A, P>::const_iterator, 
+     typename hashtable<V, K, HF, Ex, Eq, A, P>::const_iterator> 
+hashtable<V, K, HF, Ex, Eq, A, P>::equal_range(const key_type& key) const
 {
   typedef pair<const_iterator, const_iterator> pii;
-  const size_type n = bkt_num_key(key);
+  const size_type h = hash(key);
 
-  for (const node* first = buckets[n] ; first; first = first->next) {
-    if (equals(get_key(first->val), key)) {
+  for (const node* first = chain_for_hash(h); first; first = first->next) {
+    if (node_equals(first, key, h)) {
       for (const node* cur = first->next; cur; cur = cur->next)
-        if (!equals(get_key(cur->val), key))
+        if (!node_equals(cur, key, h))
           return pii(const_iterator(first, this),
                      const_iterator(cur, this));
-      for (size_type m = n + 1; m < buckets.size(); ++m)
-        if (buckets[m])
-          return pii(const_iterator(first, this),
-                     const_iterator(buckets[m], this));
-      return pii(const_iterator(first, this), end());
+      size_type bucket = __stl_no_bucket;
+      const node* last = next_bucket_start(first, bucket);
+      return pii(const_iterator(first, this),
+                 const_iterator(last, this, bucket));
     }
   }
   return pii(end(), end());
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-typename hashtable<V, K, HF, Ex, Eq, A>::size_type 
-hashtable<V, K, HF, Ex, Eq, A>::erase(const key_type& key)
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+typename hashtable<V, K, HF, Ex, Eq, A, P>::size_type 
+hashtable<V, K, HF, Ex, Eq, A, P>::erase(const key_type& key)
 {
-  const size_type n = bkt_num_key(key);
-  node* first = buckets[n];
+  const size_type h = hash(key);
+  size_type n;
+  vector<node*, A>& table = table_for_hash(h, n);
+  node* first = table[n];
   size_type erased = 0;
 
   if (first) {
     node* cur = first;
     node* next = cur->next;
     while (next) {
-      if (equals(get_key(next->val), key)) {
+      if (node_equals(next, key, h)) {
         cur->next = next->next;
         delete_node(next);
         next = cur->next;
@@ -751,8 +1344,8 @@ hashtable<V, K, HF, Ex, Eq, A>::erase(const key_type& key)
         next = cur->next;
       }
     }
-    if (equals(get_key(first->val), key)) {
-      buckets[n] = first->next;
+    if (node_equals(first, key, h)) {
+      table[n] = first->next;
       delete_node(first);
       ++erased;
       --num_elements;
@@ -761,15 +1354,16 @@ hashtable<V, K, HF, Ex, Eq, A>::erase(const key_type& key)
   return erased;
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-void hashtable<V, K, HF, Ex, Eq, A>::erase(const iterator& it)
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::erase(const iterator& it)
 {
   if (node* const p = it.cur) {
-    const size_type n = bkt_num(p->val);
-    node* cur = buckets[n];
+    size_type n;
+    vector<node*, A>& table = locate(p, n) ? old_buckets : buckets;
+    node* cur = table[n];
 
     if (cur == p) {
-      buckets[n] = cur->next;
+      table[n] = cur->next;
       delete_node(cur);
       --num_elements;
     }
@@ -791,11 +1385,21 @@ void hashtable<V, K, HF, Ex, Eq, A>::erase(const iterator& it)
   }
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-void hashtable<V, K, HF, Ex, Eq, A>::erase(iterator first, iterator last)
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::erase(iterator first, iterator last)
 {
-  size_type f_bucket = first.cur ? bkt_num(first.cur->val) : buckets.size();
-  size_type l_bucket = last.cur ? bkt_num(last.cur->val) : buckets.size();
+  if (rehashing()) {
+    // The range may span both bucket arrays; erase node by node.
+    while (first != last)
+      erase(first++);
+    return;
+  }
+
+  const size_type n_buckets = buckets.size();
+  size_type f_bucket =
+    first.cur ? node_bkt_num(first.cur, n_buckets) : n_buckets;
+  size_type l_bucket =
+    last.cur ? node_bkt_num(last.cur, n_buckets) : n_buckets;
 
   if (first.cur == last.cur)
     return;
@@ -810,9 +1414,9 @@ void hashtable<V, K, HF, Ex, Eq, A>::erase(iterator first, iterator last)
   }
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
 inline void
-hashtable<V, K, HF, Ex, Eq, A>::erase(const_iterator first,
+hashtable<V, K, HF, Ex, Eq, A, P>::erase(const_iterator first,
                                       const_iterator last)
 {
   erase(iterator(const_cast<node*>(first.cur),
@@ -821,53 +1425,81 @@ hashtable<V, K, HF, Ex, Eq, A>::erase(const_iterator first,
                  const_cast<hashtable*>(last.ht)));
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
 inline void
-hashtable<V, K, HF, Ex, Eq, A>::erase(const const_iterator& it)
+hashtable<V, K, HF, Ex, Eq, A, P>::erase(const const_iterator& it)
 {
   erase(iterator(const_cast<node*>(it.cur),
                  const_cast<hashtable*>(it.ht)));
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-void hashtable<V, K, HF, Ex, Eq, A>::resize(size_type num_elements_hint)
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::resize(size_type num_elements_hint)
 {
+  const size_type wanted = buckets_for(num_elements_hint);
   const size_type old_n = buckets.size();
-  if (num_elements_hint > old_n) {
-    const size_type n = next_size(num_elements_hint);
-    if (n > old_n) {
-      vector<node*, A> tmp(n, (node*) 0);
-      __STL_TRY {
-        for (size_type bucket = 0; bucket < old_n; ++bucket) {
-          node* first = buckets[bucket];
-          while (first) {
-            size_type new_bucket = bkt_num(first->val, n);
-            buckets[bucket] = first->next;
-            first->next = tmp[new_bucket];
-            tmp[new_bucket] = first;
-            first = buckets[bucket];          
-          }
-        }
-        buckets.swap(tmp);
+  if (wanted > old_n) {
+    const size_type n = next_size(wanted);
+    if (n > old_n)
+      rebucket(n);
+  }
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::rehash(size_type n)
+{
+  const size_type wanted = buckets_for(num_elements);
+  const size_type target = next_size(n > wanted ? n : wanted);
+  if (target != buckets.size())
+    rebucket(target);
+}
+
+// Moves every element into a new array of n buckets, or starts moving
+// them if the policy rehashes incrementally.
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::rebucket(size_type n)
+{
+  if (rehashing())
+    rehash_some(old_buckets.size());
+
+  const size_type old_n = buckets.size();
+  vector<node*, A> tmp(n, (node*) 0);
+  if (P::rehash_step != 0) {
+    old_buckets.swap(buckets);
+    buckets.swap(tmp);
+    rehash_pos = 0;
+    rehash_some(P::rehash_step);
+    return;
+  }
+  __STL_TRY {
+    for (size_type bucket = 0; bucket < old_n; ++bucket) {
+      node* first = buckets[bucket];
+      while (first) {
+        size_type new_bucket = node_bkt_num(first, n);
+        buckets[bucket] = first->next;
+        first->next = tmp[new_bucket];
+        tmp[new_bucket] = first;
+        first = buckets[bucket];          
       }
-#         ifdef __STL_USE_EXCEPTIONS
-      catch(...) {
-        for (size_type bucket = 0; bucket < tmp.size(); ++bucket) {
-          while (tmp[bucket]) {
-            node* next = tmp[bucket]->next;
-            delete_node(tmp[bucket]);
-            tmp[bucket] = next;
-          }
-        }
-        throw;
+    }
+    buckets.swap(tmp);
+  }
+#     ifdef __STL_USE_EXCEPTIONS
+  catch(...) {
+    for (size_type bucket = 0; bucket < tmp.size(); ++bucket) {
+      while (tmp[bucket]) {
+        node* next = tmp[bucket]->next;
+        delete_node(tmp[bucket]);
+        tmp[bucket] = next;
       }
-#         endif /* __STL_USE_EXCEPTIONS */
     }
+    throw;
   }
+#     endif /* __STL_USE_EXCEPTIONS */
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-void hashtable<V, K, HF, Ex, Eq, A>::erase_bucket(const size_type n, 
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::erase_bucket(const size_type n, 
                                                   node* first, node* last)
 {
   node* cur = buckets[n];
@@ -886,9 +1518,9 @@ void hashtable<V, K, HF, Ex, Eq, A>::erase_bucket(const size_type n,
   }
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
 void 
-hashtable<V, K, HF, Ex, Eq, A>::erase_bucket(const size_type n, node* last)
+hashtable<V, K, HF, Ex, Eq, A, P>::erase_bucket(const size_type n, node* last)
 {
   node* cur = buckets[n];
   while (cur != last) {
@@ -900,8 +1532,8 @@ hashtable<V, K, HF, Ex, Eq, A>::erase_bucket(const size_type n, node* last)
   }
 }
 
-template <class V, class K, class HF, class Ex, class Eq, class A>
-void hashtable<V, K, HF, Ex, Eq, A>::clear()
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::clear()
 {
   for (size_type i = 0; i < buckets.size(); ++i) {
     node* cur = buckets[i];
@@ -912,12 +1544,22 @@ void hashtable<V, K, HF, Ex, Eq, A>::clear()
     }
     buckets[i] = 0;
   }
+  for (size_type j = 0; j < old_buckets.size(); ++j) {
+    node* cur = old_buckets[j];
+    while (cur != 0) {
+      node* next = cur->next;
+      delete_node(cur);
+      cur = next;
+    }
+  }
+  vector<node*, A> tmp;
+  old_buckets.swap(tmp);
   num_elements = 0;
 }
 
     
-template <class V, class K, class HF, class Ex, class Eq, class A>
-void hashtable<V, K, HF, Ex, Eq, A>::copy_from(const hashtable& ht)
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::copy_from(const hashtable& ht)
 {
   buckets.clear();
   buckets.reserve(ht.buckets.size());
@@ -925,20 +1567,76 @@ void hashtable<V, K, HF, Ex, Eq, A>::copy_from(const hashtable& ht)
   __STL_TRY {
     for (size_type i = 0; i < ht.buckets.size(); ++i) {
       if (const node* cur = ht.buckets[i]) {
-        node* copy = new_node(cur->val);
+        node* copy = new_node(cur->val, cur->stored_hash());
         buckets[i] = copy;
 
         for (node* next = cur->next; next; cur = next, next = cur->next) {
-          copy->next = new_node(next->val);
+          copy->next = new_node(next->val, next->stored_hash());
           copy = copy->next;
         }
       }
     }
+    // Fold in any buckets that ht has not moved yet.  Equal keys share
+    // an old bucket and the new bucket holds none of them, so pushing
+    // the chain in order keeps them adjacent.
+    for (size_type j = 0; j < ht.old_buckets.size(); ++j) {
+      for (const node* cur = ht.old_buckets[j]; cur; cur = cur->next) {
+        const size_type n = node_bkt_num(cur, buckets.size());
+        node* copy = new_node(cur->val, cur->stored_hash());
+        copy->next = buckets[n];
+        buckets[n] = copy;
+      }
+    }
     num_elements = ht.num_elements;
   }
   __STL_UNWIND(clear());
 }
 
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+typename hashtable<V, K, HF, Ex, Eq, A, P>::node*
+hashtable<V, K, HF, Ex, Eq, A, P>::next_bucket_start(const node* p,
+                                                   size_type& bucket) const
+{
+  if (bucket == __stl_no_bucket && locate(p, bucket)) {
+    for (size_type n = bucket + 1; n < old_buckets.size(); ++n)
+      if (old_buckets[n]) {
+        bucket = __stl_no_bucket;
+        return old_buckets[n];
+      }
+    return first_node_from(0, bucket);
+  }
+  return first_node_from(bucket + 1, bucket);
+}
+
+// Moves one old bucket into the new array.  Nodes are relinked, never
+// copied, so references stay valid; iterators do not, since the order
+// of iteration changes.
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::migrate_bucket(size_type bucket)
+{
+  node* first = old_buckets[bucket];
+  while (first) {
+    size_type new_bucket = node_bkt_num(first, buckets.size());
+    old_buckets[bucket] = first->next;
+    first->next = buckets[new_bucket];
+    buckets[new_bucket] = first;
+    first = old_buckets[bucket];
+  }
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class A, class P>
+void hashtable<V, K, HF, Ex, Eq, A, P>::rehash_some(size_type count)
+{
+  const size_type old_n = old_buckets.size();
+  for ( ; count > 0 && rehash_pos < old_n; --count, ++rehash_pos)
+    migrate_bucket(rehash_pos);
+  if (rehash_pos == old_n) {
+    vector<node*, A> tmp;
+    old_buckets.swap(tmp);
+    rehash_pos = 0;
+  }
+}
+
 __STL_END_NAMESPACE
 
 #endif /* __SGI_STL_INTERNAL_HASHTABLE_H */
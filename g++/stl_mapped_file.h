@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 1997
+ * Silicon Graphics Computer Systems, Inc.
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Silicon Graphics makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ */
+
+/* NOTE: This is an internal header file, included by other STL headers.
+ *   You should not attempt to use it directly.
+ */
+
+#ifndef __SGI_STL_INTERNAL_MAPPED_FILE_H
+#define __SGI_STL_INTERNAL_MAPPED_FILE_H
+
+// A read-only image of a file, shared by the frozen tables and by file
+// ropes: mapped where the system has mmap (see __STL_USE_MMAP in
+// stl_config.h), and read into memory elsewhere.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __STL_USE_MMAP
+#   include <sys/types.h>
+#   include <sys/stat.h>
+#   include <sys/mman.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+__STL_BEGIN_NAMESPACE
+
+// An empty file opens successfully, with data() == 0 and size() == 0.
+class __stl_mapped_file {
+public:
+  __stl_mapped_file() : addr(0), len(0) {}
+  ~__stl_mapped_file() { close(); }
+
+  const void* data() const { return addr; }
+  size_t size() const { return len; }
+
+  bool open(const char* path)
+  {
+    close();
+#ifdef __STL_USE_MMAP
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0) {
+      if (st.st_size == 0)
+        p = 0;
+      else if (st.st_size > 0)
+        p = mmap(0, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (p == MAP_FAILED)
+      return false;
+    addr = p;
+    len = size_t(st.st_size);
+    return true;
+#else
+    FILE* f = fopen(path, "rb");
+    if (!f)
+      return false;
+    long n = -1;
+    if (fseek(f, 0, SEEK_END) == 0)
+      n = ftell(f);
+    void* p = n > 0 ? malloc(size_t(n)) : 0;
+    bool ok = n == 0 || p != 0;
+    if (p && (fseek(f, 0, SEEK_SET) != 0
+              || fread(p, size_t(n), 1, f) != 1)) {
+      free(p);
+      p = 0;
+      ok = false;
+    }
+    fclose(f);
+    if (!ok)
+      return false;
+    addr = p;
+    len = size_t(n);
+    return true;
+#endif /* __STL_USE_MMAP */
+  }
+
+  void close()
+  {
+    if (addr) {
+#ifdef __STL_USE_MMAP
+      munmap(addr, len);
+#else
+      free(addr);
+#endif
+    }
+    addr = 0;
+    len = 0;
+  }
+
+private:
+  void* addr;
+  size_t len;
+
+  __stl_mapped_file(const __stl_mapped_file&);
+  void operator=(const __stl_mapped_file&);
+};
+
+__STL_END_NAMESPACE
+
+#endif /* __SGI_STL_INTERNAL_MAPPED_FILE_H */
+
+// Local Variables:
+// mode:C++
+// End:
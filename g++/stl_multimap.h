@@ -198,6 +198,59 @@ public:
   {
     return t.equal_range(x);
   }
+
+#ifdef __STL_MEMBER_TEMPLATES
+  // Lookup by another type; see rb_tree.
+  template <class K>
+  iterator find(const K &x, __STL_IF_TRANSPARENT(Compare, K))
+  {
+    return t.find(x);
+  }
+  template <class K>
+  const_iterator find(const K &x, __STL_IF_TRANSPARENT(Compare, K)) const
+  {
+    return t.find(x);
+  }
+  template <class K>
+  size_type count(const K &x, __STL_IF_TRANSPARENT(Compare, K)) const
+  {
+    return t.count(x);
+  }
+  template <class K>
+  iterator lower_bound(const K &x, __STL_IF_TRANSPARENT(Compare, K))
+  {
+    return t.lower_bound(x);
+  }
+  template <class K>
+  const_iterator lower_bound(const K &x,
+                             __STL_IF_TRANSPARENT(Compare, K)) const
+  {
+    return t.lower_bound(x);
+  }
+  template <class K>
+  iterator upper_bound(const K &x, __STL_IF_TRANSPARENT(Compare, K))
+  {
+    return t.upper_bound(x);
+  }
+  template <class K>
+  const_iterator upper_bound(const K &x,
+                             __STL_IF_TRANSPARENT(Compare, K)) const
+  {
+    return t.upper_bound(x);
+  }
+  template <class K>
+  pair<iterator, iterator> equal_range(const K &x,
+                                       __STL_IF_TRANSPARENT(Compare, K))
+  {
+    return t.equal_range(x);
+  }
+  template <class K>
+  pair<const_iterator, const_iterator>
+  equal_range(const K &x, __STL_IF_TRANSPARENT(Compare, K)) const
+  {
+    return t.equal_range(x);
+  }
+#endif /* __STL_MEMBER_TEMPLATES */
   friend bool operator== __STL_NULL_TMPL_ARGS(const multimap &,
                                               const multimap &);
   friend bool operator<__STL_NULL_TMPL_ARGS(const multimap &,
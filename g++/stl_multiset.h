@@ -159,6 +159,31 @@ public:
   pair<iterator,iterator> equal_range(const key_type& x) const {
     return t.equal_range(x);
   }
+
+#ifdef __STL_MEMBER_TEMPLATES
+  // Lookup by another type; see rb_tree.
+  template <class K>
+  iterator find(const K& x, __STL_IF_TRANSPARENT(Compare, K)) const {
+    return t.find(x);
+  }
+  template <class K>
+  size_type count(const K& x, __STL_IF_TRANSPARENT(Compare, K)) const {
+    return t.count(x);
+  }
+  template <class K>
+  iterator lower_bound(const K& x, __STL_IF_TRANSPARENT(Compare, K)) const {
+    return t.lower_bound(x);
+  }
+  template <class K>
+  iterator upper_bound(const K& x, __STL_IF_TRANSPARENT(Compare, K)) const {
+    return t.upper_bound(x);
+  }
+  template <class K>
+  pair<iterator,iterator>
+  equal_range(const K& x, __STL_IF_TRANSPARENT(Compare, K)) const {
+    return t.equal_range(x);
+  }
+#endif /* __STL_MEMBER_TEMPLATES */
   friend bool operator== __STL_NULL_TMPL_ARGS (const multiset&,
                                                const multiset&);
   friend bool operator< __STL_NULL_TMPL_ARGS (const multiset&,
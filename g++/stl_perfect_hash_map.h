@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 1996
+ * Silicon Graphics Computer Systems, Inc.
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Silicon Graphics makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ *
+ * Copyright (c) 1994
+ * Hewlett-Packard Company
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Hewlett-Packard Company makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ */
+
+/* NOTE: This is an internal header file, included by other STL headers.
+ *   You should not attempt to use it directly.
+ */
+
+#ifndef __SGI_STL_INTERNAL_PERFECT_HASH_MAP_H
+#define __SGI_STL_INTERNAL_PERFECT_HASH_MAP_H
+
+__STL_BEGIN_NAMESPACE
+
+#if defined(__sgi) && !defined(__GNUC__) && (_MIPS_SIM != _MIPS_SIM_ABI32)
+#pragma set woff 1174
+#endif
+
+// perfect_hash_map is an immutable map with the lookup interface of a
+// const hash_map.  It is built once, from a range of elements with
+// distinct keys or from a hash_map by freeze(), and every lookup probes
+// exactly one element.  Elements are stored contiguously; iterators are
+// pointers into that array.
+
+#ifndef __STL_LIMITED_DEFAULT_TEMPLATES
+template <class Key, class T, class HashFcn = hash<Key>,
+          class EqualKey = equal_to<Key>,
+          class Alloc = alloc>
+#else
+template <class Key, class T, class HashFcn, class EqualKey,
+          class Alloc = alloc>
+#endif
+class perfect_hash_map
+{
+private:
+  typedef perfect_hashtable<pair<const Key, T>, Key, HashFcn,
+                            select1st<pair<const Key, T> >, EqualKey,
+                            Alloc> ht;
+  ht rep;
+
+public:
+  typedef typename ht::key_type key_type;
+  typedef T data_type;
+  typedef T mapped_type;
+  typedef typename ht::value_type value_type;
+  typedef typename ht::hasher hasher;
+  typedef typename ht::key_equal key_equal;
+
+  typedef typename ht::size_type size_type;
+  typedef typename ht::difference_type difference_type;
+  typedef typename ht::const_pointer pointer;
+  typedef typename ht::const_pointer const_pointer;
+  typedef typename ht::const_reference reference;
+  typedef typename ht::const_reference const_reference;
+
+  typedef typename ht::const_iterator iterator;
+  typedef typename ht::const_iterator const_iterator;
+
+  hasher hash_funct() const { return rep.hash_funct(); }
+  key_equal key_eq() const { return rep.key_eq(); }
+
+public:
+  perfect_hash_map() : rep(hasher(), key_equal()) {}
+
+#ifdef __STL_MEMBER_TEMPLATES
+  template <class ForwardIterator>
+  perfect_hash_map(ForwardIterator f, ForwardIterator l)
+    : rep(f, l, hasher(), key_equal()) {}
+  template <class ForwardIterator>
+  perfect_hash_map(ForwardIterator f, ForwardIterator l, const hasher& hf)
+    : rep(f, l, hf, key_equal()) {}
+  template <class ForwardIterator>
+  perfect_hash_map(ForwardIterator f, ForwardIterator l, const hasher& hf,
+                   const key_equal& eql)
+    : rep(f, l, hf, eql) {}
+#else
+  perfect_hash_map(const value_type* f, const value_type* l)
+    : rep(f, l, hasher(), key_equal()) {}
+  perfect_hash_map(const value_type* f, const value_type* l,
+                   const hasher& hf)
+    : rep(f, l, hf, key_equal()) {}
+  perfect_hash_map(const value_type* f, const value_type* l,
+                   const hasher& hf, const key_equal& eql)
+    : rep(f, l, hf, eql) {}
+#endif /*__STL_MEMBER_TEMPLATES */
+
+public:
+  size_type size() const { return rep.size(); }
+  size_type max_size() const { return rep.max_size(); }
+  bool empty() const { return rep.empty(); }
+  void swap(perfect_hash_map& hs) { rep.swap(hs.rep); }
+
+  const_iterator begin() const { return rep.begin(); }
+  const_iterator end() const { return rep.end(); }
+
+public:
+  const_iterator find(const key_type& key) const { return rep.find(key); }
+  size_type count(const key_type& key) const { return rep.count(key); }
+  pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+    { return rep.equal_range(key); }
+
+public:
+  size_type bucket_count() const { return rep.bucket_count(); }
+  size_type overflow_count() const { return rep.overflow_count(); }
+};
+
+#ifdef __STL_FUNCTION_TMPL_PARTIAL_ORDER
+
+template <class Key, class T, class HashFcn, class EqualKey, class Alloc>
+inline void swap(perfect_hash_map<Key, T, HashFcn, EqualKey, Alloc>& hm1,
+                 perfect_hash_map<Key, T, HashFcn, EqualKey, Alloc>& hm2)
+{
+  hm1.swap(hm2);
+}
+
+#endif /* __STL_FUNCTION_TMPL_PARTIAL_ORDER */
+
+#ifdef __STL_MEMBER_TEMPLATES
+
+template <class Key, class T, class HashFcn, class EqualKey, class Alloc,
+          class Policy>
+inline perfect_hash_map<Key, T, HashFcn, EqualKey, Alloc>
+freeze(const hash_map<Key, T, HashFcn, EqualKey, Alloc, Policy>& hm)
+{
+  return perfect_hash_map<Key, T, HashFcn, EqualKey, Alloc>(
+           hm.begin(), hm.end(), hm.hash_funct(), hm.key_eq());
+}
+
+#endif /* __STL_MEMBER_TEMPLATES */
+
+#if defined(__sgi) && !defined(__GNUC__) && (_MIPS_SIM != _MIPS_SIM_ABI32)
+#pragma reset woff 1174
+#endif
+
+__STL_END_NAMESPACE
+
+#endif /* __SGI_STL_INTERNAL_PERFECT_HASH_MAP_H */
+
+// Local Variables:
+// mode:C++
+// End:
@@ -0,0 +1,476 @@
+/*
+ * Copyright (c) 1996,1997
+ * Silicon Graphics Computer Systems, Inc.
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Silicon Graphics makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ *
+ * Copyright (c) 1994
+ * Hewlett-Packard Company
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Hewlett-Packard Company makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ *
+ */
+
+/* NOTE: This is an internal header file, included by other STL headers.
+ *   You should not attempt to use it directly.
+ */
+
+#ifndef __SGI_STL_INTERNAL_PERFECT_HASHTABLE_H
+#define __SGI_STL_INTERNAL_PERFECT_HASHTABLE_H
+
+// Immutable hash table with a minimal perfect hash function, used to
+// implement perfect_hash_set and perfect_hash_map.  It is built once
+// from a range of elements with distinct keys; after that, a lookup
+// computes one slot from the hash code and compares one key.
+//
+// The hash function is built with the hash-and-displace method.  Keys
+// are spread over a small number of buckets, averaging two to four keys
+// each.  Buckets are placed largest first: for each bucket we search for
+// a pilot value that sends every key of the bucket to a distinct free
+// position, and store only the pilot.  A key's position is then
+// __perfect_position(h, pilots[bucket]), so the table costs one pilot per
+// bucket on top of the elements themselves.
+//
+// Positions range over slightly more places than there are elements,
+// which keeps the search for the last buckets short.  The few elements
+// placed beyond the end are moved into the holes left below it, and the
+// remap array records where each went.
+//
+// Keys whose hash codes are identical cannot be told apart by any
+// pilot.  All but the first of them are kept in an overflow area after
+// the placed elements and are searched linearly when the probe misses.
+// With a reasonable hash function the overflow area is empty.
+
+#include <stl_algobase.h>
+#include <stl_alloc.h>
+#include <stl_construct.h>
+#include <stl_function.h>
+#include <stl_vector.h>
+#include <stl_hash_fun.h>
+
+__STL_BEGIN_NAMESPACE
+
+// Pilots tried for one bucket before its keys are sent to the overflow
+// area instead.
+static const unsigned int __perfect_max_pilot = 1u << 16;
+
+// Both functions take a hash code that has already been through
+// __stl_hash_finish, so keys with similar codes, as small integers have,
+// are spread evenly.
+inline size_t __perfect_bucket(size_t h, size_t n_buckets)
+{
+  return h & (n_buckets - 1);
+}
+
+inline size_t __perfect_position(size_t h, unsigned int pilot,
+                                 size_t n_positions)
+{
+  return __stl_hash_finish(h ^ pilot) % n_positions;
+}
+
+// The build marks taken positions in a bit array, which stays in cache
+// far longer than an array of flags would.
+static const size_t __perfect_word_bits = sizeof(size_t) * 8;
+
+inline bool __perfect_test(const size_t* bits, size_t i)
+{
+  return (bits[i / __perfect_word_bits] >> (i % __perfect_word_bits)) & 1;
+}
+
+inline void __perfect_set(size_t* bits, size_t i)
+{
+  bits[i / __perfect_word_bits] |= size_t(1) << (i % __perfect_word_bits);
+}
+
+template <class Value, class Key, class HashFcn,
+          class ExtractKey, class EqualKey, class Alloc = alloc>
+class perfect_hashtable {
+public:
+  typedef Key key_type;
+  typedef Value value_type;
+  typedef HashFcn hasher;
+  typedef EqualKey key_equal;
+
+  typedef size_t            size_type;
+  typedef ptrdiff_t         difference_type;
+  typedef const value_type* const_pointer;
+  typedef const value_type& const_reference;
+  typedef const value_type* const_iterator;
+
+  hasher hash_funct() const { return hash; }
+  key_equal key_eq() const { return equals; }
+
+private:
+  hasher hash;
+  key_equal equals;
+  ExtractKey get_key;
+
+  typedef simple_alloc<Value, Alloc> value_allocator;
+  typedef simple_alloc<unsigned int, Alloc> pilot_allocator;
+  typedef simple_alloc<size_type, Alloc> remap_allocator;
+
+  Value* elems;
+  size_type num_elements;
+  size_type num_placed;         // Elements reached by the perfect hash.
+  unsigned int* pilots;
+  size_type num_buckets;        // Always a power of two.
+  size_type* remap;
+  size_type num_positions;      // At least num_placed.
+
+public:
+  perfect_hashtable(const HashFcn& hf, const EqualKey& eql)
+    : hash(hf), equals(eql), get_key(ExtractKey())
+  {
+    initialize_empty();
+  }
+
+#ifdef __STL_MEMBER_TEMPLATES
+  template <class ForwardIterator>
+  perfect_hashtable(ForwardIterator first, ForwardIterator last,
+                    const HashFcn& hf, const EqualKey& eql)
+    : hash(hf), equals(eql), get_key(ExtractKey())
+  {
+    initialize_empty();
+    size_type n = 0;
+    distance(first, last, n);
+    vector<const Value*, Alloc> items(n);
+    for (size_type i = 0; i < n; ++i, ++first)
+      items[i] = &*first;
+    __STL_TRY {
+      build(items);
+    }
+    __STL_UNWIND(clear());
+  }
+#else /* __STL_MEMBER_TEMPLATES */
+  perfect_hashtable(const value_type* first, const value_type* last,
+                    const HashFcn& hf, const EqualKey& eql)
+    : hash(hf), equals(eql), get_key(ExtractKey())
+  {
+    initialize_empty();
+    vector<const Value*, Alloc> items(size_type(last - first));
+    for (size_type i = 0; first != last; ++i, ++first)
+      items[i] = first;
+    __STL_TRY {
+      build(items);
+    }
+    __STL_UNWIND(clear());
+  }
+#endif /* __STL_MEMBER_TEMPLATES */
+
+  perfect_hashtable(const perfect_hashtable& ht)
+    : hash(ht.hash), equals(ht.equals), get_key(ht.get_key)
+  {
+    initialize_empty();
+    copy_from(ht);
+  }
+
+  perfect_hashtable& operator= (const perfect_hashtable& ht)
+  {
+    if (&ht != this) {
+      perfect_hashtable tmp(ht);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  ~perfect_hashtable() { clear(); }
+
+  size_type size() const { return num_elements; }
+  size_type max_size() const { return size_type(-1) / sizeof(Value); }
+  bool empty() const { return num_elements == 0; }
+
+  void swap(perfect_hashtable& ht)
+  {
+    __STD::swap(hash, ht.hash);
+    __STD::swap(equals, ht.equals);
+    __STD::swap(get_key, ht.get_key);
+    __STD::swap(elems, ht.elems);
+    __STD::swap(num_elements, ht.num_elements);
+    __STD::swap(num_placed, ht.num_placed);
+    __STD::swap(pilots, ht.pilots);
+    __STD::swap(num_buckets, ht.num_buckets);
+    __STD::swap(remap, ht.remap);
+    __STD::swap(num_positions, ht.num_positions);
+  }
+
+  const_iterator begin() const { return elems; }
+  const_iterator end() const { return elems + num_elements; }
+
+  size_type bucket_count() const { return num_buckets; }
+
+  // Elements the perfect hash does not reach; normally zero.
+  size_type overflow_count() const { return num_elements - num_placed; }
+
+  const_iterator find(const key_type& key) const
+  {
+    if (num_placed != 0) {
+      const size_t h = __stl_hash_finish(hash(key));
+      size_type pos =
+        __perfect_position(h, pilots[__perfect_bucket(h, num_buckets)],
+                           num_positions);
+      if (pos >= num_placed)
+        pos = remap[pos - num_placed];
+      if (equals(get_key(elems[pos]), key))
+        return elems + pos;
+    }
+    return find_overflow(key);
+  }
+
+  size_type count(const key_type& key) const
+  {
+    return find(key) == end() ? 0 : 1;
+  }
+
+  pair<const_iterator, const_iterator> equal_range(const key_type& key) const
+  {
+    const_iterator first = find(key);
+    return pair<const_iterator, const_iterator>(first,
+                                                first == end() ? first
+                                                               : first + 1);
+  }
+
+  void clear();
+
+private:
+  void initialize_empty()
+  {
+    elems = 0;
+    num_elements = 0;
+    num_placed = 0;
+    pilots = 0;
+    num_buckets = 0;
+    remap = 0;
+    num_positions = 0;
+  }
+
+  const_iterator find_overflow(const key_type& key) const
+  {
+    for (const Value* cur = elems + num_placed; cur != end(); ++cur)
+      if (equals(get_key(*cur), key))
+        return cur;
+    return end();
+  }
+
+  void build(const vector<const Value*, Alloc>& items);
+  bool place_bucket(const size_type* codes, size_type n,
+                    unsigned int& pilot, vector<size_type, Alloc>& taken,
+                    size_type* pos) const;
+  void construct_elements(const vector<const Value*, Alloc>& order);
+  void copy_from(const perfect_hashtable& ht);
+};
+
+template <class V, class K, class HF, class Ex, class Eq, class All>
+void perfect_hashtable<V, K, HF, Ex, Eq, All>::clear()
+{
+  destroy(elems, elems + num_elements);
+  if (elems)
+    value_allocator::deallocate(elems, num_elements);
+  if (pilots)
+    pilot_allocator::deallocate(pilots, num_buckets);
+  if (remap)
+    remap_allocator::deallocate(remap, num_positions - num_placed);
+  initialize_empty();
+}
+
+// Looks for a pilot that sends the n hash codes codes[0, n) to distinct
+// positions not yet taken.  On success, marks the positions taken and
+// returns them in pos[0, n).
+template <class V, class K, class HF, class Ex, class Eq, class All>
+bool perfect_hashtable<V, K, HF, Ex, Eq, All>
+  ::place_bucket(const size_type* codes, size_type n, unsigned int& pilot,
+                 vector<size_type, All>& taken, size_type* pos) const
+{
+  for (pilot = 0; pilot < __perfect_max_pilot; ++pilot) {
+    size_type i;
+    for (i = 0; i < n; ++i) {
+      pos[i] = __perfect_position(codes[i], pilot, num_positions);
+      if (__perfect_test(&taken[0], pos[i]))
+        break;
+      size_type j;
+      for (j = 0; j < i && pos[j] != pos[i]; ++j)
+        ;
+      if (j < i)
+        break;
+    }
+    if (i == n) {
+      for (i = 0; i < n; ++i)
+        __perfect_set(&taken[0], pos[i]);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class All>
+void perfect_hashtable<V, K, HF, Ex, Eq, All>
+  ::build(const vector<const V*, All>& items)
+{
+  const size_type n = items.size();
+  if (n == 0)
+    return;
+  const size_type no_position = size_type(-1);
+
+  vector<size_type, All> codes(n);
+  size_type i;
+  for (i = 0; i < n; ++i)
+    codes[i] = __stl_hash_finish(hash(get_key(*items[i])));
+
+  size_type nb = 1;
+  while (nb * 4 < n)
+    nb <<= 1;
+  const size_type np = n + n / 64 + 1;
+
+  // Group the keys by bucket: bucket b holds by_bucket[start[b],
+  // start[b + 1]).
+  vector<size_type, All> start(nb + 1, size_type(0));
+  vector<size_type, All> bkt(n);
+  for (i = 0; i < n; ++i) {
+    bkt[i] = __perfect_bucket(codes[i], nb);
+    ++start[bkt[i] + 1];
+  }
+  size_type largest = 0;
+  for (i = 0; i < nb; ++i) {
+    largest = max(largest, start[i + 1]);
+    start[i + 1] += start[i];
+  }
+  vector<size_type, All> by_bucket(n);
+  {
+    vector<size_type, All> next(start.begin(), start.end() - 1);
+    for (i = 0; i < n; ++i)
+      by_bucket[next[bkt[i]]++] = i;
+  }
+
+  // Order the buckets largest first, with a counting sort on size.
+  vector<size_type, All> order(nb);
+  {
+    vector<size_type, All> next(largest + 2, size_type(0));
+    for (i = 0; i < nb; ++i)
+      ++next[largest - (start[i + 1] - start[i]) + 1];
+    for (i = 1; i <= largest; ++i)
+      next[i] += next[i - 1];
+    for (i = 0; i < nb; ++i)
+      order[next[largest - (start[i + 1] - start[i])]++] = i;
+  }
+
+  num_buckets = nb;
+  num_positions = np;
+  pilots = pilot_allocator::allocate(nb);
+  fill(pilots, pilots + nb, 0u);
+
+  vector<size_type, All> taken(np / __perfect_word_bits + 1, size_type(0));
+  vector<size_type, All> where(n, no_position);
+  vector<size_type, All> members;
+  vector<size_type, All> member_codes;
+  vector<size_type, All> bucket_pos(largest);
+  for (size_type k = 0; k < nb; ++k) {
+    const size_type b = order[k];
+    members.clear();
+    member_codes.clear();
+    for (i = start[b]; i < start[b + 1]; ++i) {
+      const size_type m = by_bucket[i];
+      size_type j;
+      for (j = 0; j < members.size() && member_codes[j] != codes[m]; ++j)
+        ;
+      if (j == members.size()) {
+        members.push_back(m);
+        member_codes.push_back(codes[m]);
+      }
+    }
+    if (members.empty())
+      continue;
+    if (place_bucket(&member_codes[0], members.size(), pilots[b], taken,
+                     &bucket_pos[0]))
+      for (i = 0; i < members.size(); ++i)
+        where[members[i]] = bucket_pos[i];
+    else
+      pilots[b] = 0;
+  }
+
+  // Fill the holes below num_placed with the elements placed above it.
+  size_type placed = 0;
+  for (i = 0; i < n; ++i)
+    if (where[i] != no_position)
+      ++placed;
+  num_placed = placed;
+  remap = remap_allocator::allocate(np - placed);
+  fill(remap, remap + (np - placed), size_type(0));
+  vector<const V*, All> final_order(n);
+  size_type hole = 0;
+  size_type overflow = placed;
+  for (i = 0; i < n; ++i) {
+    size_type pos = where[i];
+    if (pos == no_position)
+      pos = overflow++;
+    else if (pos >= placed) {
+      while (__perfect_test(&taken[0], hole))
+        ++hole;
+      remap[pos - placed] = hole;
+      pos = hole++;
+    }
+    final_order[pos] = items[i];
+  }
+
+  construct_elements(final_order);
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class All>
+void perfect_hashtable<V, K, HF, Ex, Eq, All>
+  ::construct_elements(const vector<const V*, All>& order)
+{
+  const size_type n = order.size();
+  V* p = value_allocator::allocate(n);
+  size_type i = 0;
+  __STL_TRY {
+    for ( ; i < n; ++i)
+      construct(p + i, *order[i]);
+  }
+  __STL_UNWIND((destroy(p, p + i), value_allocator::deallocate(p, n)));
+  elems = p;
+  num_elements = n;
+}
+
+template <class V, class K, class HF, class Ex, class Eq, class All>
+void perfect_hashtable<V, K, HF, Ex, Eq, All>
+  ::copy_from(const perfect_hashtable& ht)
+{
+  if (ht.num_elements == 0)
+    return;
+  __STL_TRY {
+    num_buckets = ht.num_buckets;
+    pilots = pilot_allocator::allocate(num_buckets);
+    copy(ht.pilots, ht.pilots + num_buckets, pilots);
+    num_positions = ht.num_positions;
+    num_placed = ht.num_placed;
+    remap = remap_allocator::allocate(num_positions - num_placed);
+    copy(ht.remap, ht.remap + (num_positions - num_placed), remap);
+    V* p = value_allocator::allocate(ht.num_elements);
+    __STL_TRY {
+      uninitialized_copy(ht.elems, ht.elems + ht.num_elements, p);
+    }
+    __STL_UNWIND(value_allocator::deallocate(p, ht.num_elements));
+    elems = p;
+    num_elements = ht.num_elements;
+  }
+  __STL_UNWIND(clear());
+}
+
+__STL_END_NAMESPACE
+
+#endif /* __SGI_STL_INTERNAL_PERFECT_HASHTABLE_H */
+
+// Local Variables:
+// mode:C++
+// End:
@@ -26,6 +26,23 @@
 # ifdef __STL_SGI_THREADS
 #    include <mutex.h>
 # endif
+# ifdef __STL_USE_WRITEV
+#    include <sys/uio.h>
+#    include <errno.h>
+# endif
+# include <stl_mapped_file.h>
+
+// The number of nodes above the current leaf that a rope iterator
+// remembers, and the number of characters of a function node that it
+// computes at a time.  A longer path lets an iterator move to the next
+// leaf without starting again from the root more often; both make
+// iterators bigger.  For bulk scans, see rope::piece_cursor instead.
+# ifndef __STL_ROPE_PATH_CACHE_LEN
+#   define __STL_ROPE_PATH_CACHE_LEN 4
+# endif
+# ifndef __STL_ROPE_ITERATOR_BUF_LEN
+#   define __STL_ROPE_ITERATOR_BUF_LEN 15
+# endif
 
 __STL_BEGIN_NAMESPACE
 
@@ -72,12 +89,31 @@ class char_producer {
 	virtual ~char_producer() {};
 	virtual void operator()(size_t start_pos, size_t len, charT* buffer)
 		= 0;
+	// A producer whose characters already sit in memory, such as
+	// a mapped file, may return them here.  They must stay put for
+	// the life of the producer.  Iterators and apply_to_pieces then
+	// read them in place instead of calling operator().
+	virtual const charT* contiguous() { return 0; }
 	// Buffer should really be an arbitrary output iterator.
 	// That way we could flatten directly into an ostream, etc.
 	// This is thoroughly impossible, since iterator types don't
 	// have runtime descriptions.
 };
 
+// The characters of a file, mapped read-only where the system has
+// mmap and read into memory elsewhere.  Used by rope::map_file.
+template <class charT>
+class __rope_file_char_producer : public char_producer<charT> {
+    public:
+	__stl_mapped_file file;
+	virtual void operator()(size_t start_pos, size_t len, charT* buffer) {
+	    uninitialized_copy_n(contiguous() + start_pos, len, buffer);
+	}
+	virtual const charT* contiguous() {
+	    return (const charT *)file.data();
+	}
+};
+
 // Sequence buffers:
 //
 // Sequence must provide an append operation that appends an
@@ -197,6 +233,14 @@ class __rope_char_consumer {
 	// The symmetry with char_producer is accidental and temporary.
 	virtual ~__rope_char_consumer() {};
 	virtual bool operator()(const charT* buffer, size_t len) = 0;
+	// Pieces of leaves, and of producers that are contiguous(),
+	// are passed to operator() in place, and stay valid as long
+	// as the rope.  Characters computed by a char_producer are
+	// passed here instead, in a buffer that is reused once this
+	// returns.
+	virtual bool transient(const charT* buffer, size_t len) {
+	    return (*this)(buffer, len);
+	}
 };
 
 //
@@ -248,6 +292,11 @@ struct __rope_RopeBase {
     enum {leaf, concat, substringfn, function} tag:8;
     bool is_balanced:8;
     unsigned char depth;
+    unsigned char leaf_capacity_log;
+			/* Leaves only.  If it's not 0, the data   */
+			/* field was allocated with room for       */
+			/* 2**leaf_capacity_log characters, so     */
+			/* that appends can extend it in place.    */
     size_t size;
     __GC_CONST charT * c_string;
 			/* Flattened version of string, if needed.  */
@@ -306,16 +355,42 @@ struct __rope_RopeBase {
             {
                 return InterlockedDecrement(&refcount);
             }
+#	elif defined(__STL_PTHREADS) && defined(__STL_ATOMIC_BUILTINS)
+	    // The GCC builtins are a single locked instruction on
+	    // most targets, and need no lock in the node.
+	    void init_refcount_lock() {}
+	    void incr_refcount ()
+	    {
+		if (__alloc_single_client<Alloc>::value) {
+		    ++refcount;
+		} else {
+		    __sync_add_and_fetch(&refcount, 1);
+		}
+	    }
+	    size_t decr_refcount ()
+	    {
+		if (__alloc_single_client<Alloc>::value) {
+		    return --refcount;
+		} else {
+		    return __sync_sub_and_fetch(&refcount, 1);
+		}
+	    }
 #	elif defined(__STL_PTHREADS)
 	    // This should be portable, but performance is expected
 	    // to be quite awful.  This really needs platform specific
 	    // code.
 	    pthread_mutex_t refcount_lock;
 	    void init_refcount_lock() {
-		pthread_mutex_init(&refcount_lock, 0);
+		if (!__alloc_single_client<Alloc>::value) {
+		    pthread_mutex_init(&refcount_lock, 0);
+		}
 	    }
 	    void incr_refcount ()
             {   
+		if (__alloc_single_client<Alloc>::value) {
+		    ++refcount;
+		    return;
+		}
 		pthread_mutex_lock(&refcount_lock);
                 ++refcount;
 		pthread_mutex_unlock(&refcount_lock);
@@ -323,6 +398,9 @@ struct __rope_RopeBase {
             size_t decr_refcount ()
             {   
 		size_t result;
+		if (__alloc_single_client<Alloc>::value) {
+		    return --refcount;
+		}
 		pthread_mutex_lock(&refcount_lock);
                 result = --refcount;
 		pthread_mutex_unlock(&refcount_lock);
@@ -343,7 +421,8 @@ struct __rope_RopeBase {
 #   else
 	void incr_refcount () {}
 #   endif
-	static void free_string(charT *, size_t len);
+	static void free_string(charT *, size_t len,
+				unsigned char capacity_log = 0);
 			// Deallocate data section of a leaf.
 			// This shouldn't be a member function.
 			// But its hard to do anything else at the
@@ -412,9 +491,11 @@ struct __rope_RopeLeaf : public __rope_RopeBase<charT,Alloc> {
   public:  // Apparently needed by VC++
     __GC_CONST charT* data;     /* Not necessarily 0 terminated. */
 				/* The allocated size is	 */
-				/* rounded_up_size(size), except */
-				/* in the GC case, in which it	 */
-				/* doesn't matter.		 */
+				/* rounded_up_size(size), or	 */
+				/* 2**leaf_capacity_log if that	 */
+				/* is nonzero, except in the GC	 */
+				/* case, in which it doesn't	 */
+				/* matter.			 */
 };
 
 template<class charT, class Alloc>
@@ -478,6 +559,23 @@ struct __rope_RopeSubstring: public __rope_RopeFunction<charT,Alloc>,
 	      __stl_assert(false);
 	}
     }
+    virtual const charT* contiguous() {
+	const charT * s;
+	switch(base -> tag) {
+	    case function:
+	    case substringfn:
+		s = ((__rope_RopeFunction<charT,Alloc> *)base) -> fn
+			-> contiguous();
+		break;
+	    case leaf:
+		s = ((__rope_RopeLeaf<charT,Alloc> *)base) -> data;
+		break;
+	    default:
+		__stl_assert(false);
+		s = 0;
+	}
+	return 0 == s? 0 : s + start;
+    }
     __rope_RopeSubstring(__rope_RopeBase<charT,Alloc> * b, size_t s, size_t l) :
 	base(b), start(s) {
 #       ifndef __GC
@@ -487,6 +585,7 @@ struct __rope_RopeSubstring: public __rope_RopeFunction<charT,Alloc>,
 #       endif
 	size = l;
 	tag = substringfn;
+	is_balanced = true;
 	depth = 0;
 	c_string = 0;
 	fn = this;
@@ -615,8 +714,9 @@ class __rope_iterator_base:
     typedef __rope_RopeBase<charT,Alloc> RopeBase;
 	// Borland doesnt want this to be protected.
   protected:
-    enum { path_cache_len = 4 }; // Must be <= 9.
-    enum { iterator_buf_len = 15 };
+    enum { path_cache_len = __STL_ROPE_PATH_CACHE_LEN };
+				// Must be <= 33.
+    enum { iterator_buf_len = __STL_ROPE_ITERATOR_BUF_LEN };
     size_t current_pos;
     RopeBase * root;     // The whole rope.
     size_t leaf_pos;    // Starting position for current leaf
@@ -636,11 +736,11 @@ class __rope_iterator_base:
     int leaf_index;     // Last valid pos in path_end;
     			// path_end[0] ... path_end[leaf_index-1]
 			// point to concatenation nodes.
-    unsigned char path_directions;
+    unsigned long path_directions;
 			  // (path_directions >> i) & 1 is 1
 			  // iff we got from path_end[leaf_index - i - 1]
 			  // to path_end[leaf_index - i] by going to the
-			  // right. Assumes path_cache_len <= 9.
+			  // right. Assumes path_cache_len <= 33.
     charT tmp_buf[iterator_buf_len];
 			// Short buffer for surrounding chars.
 			// This is useful primarily for 
@@ -662,14 +762,11 @@ class __rope_iterator_base:
     __rope_iterator_base(RopeBase * root, size_t pos):
 		   root(root), current_pos(pos), buf_ptr(0) {}
     __rope_iterator_base(const __rope_iterator_base& x) {
-	if (0 != x.buf_ptr) {
-	    *this = x;
-	} else {
-	    current_pos = x.current_pos;
-	    root = x.root;
-	    buf_ptr = 0;
-	}
+	copy_from(x);
     }
+    // Copies only the live part of the path cache and of tmp_buf,
+    // and repoints the buffer pointers if they point into x.tmp_buf.
+    void copy_from(const __rope_iterator_base& x);
     void incr(size_t n);
     void decr(size_t n);
   public:
@@ -701,13 +798,7 @@ class __rope_const_iterator : public __rope_iterator_base<charT,Alloc> {
     __rope_const_iterator(const rope<charT,Alloc> &r, size_t pos) :
 	__rope_iterator_base<charT,Alloc>(r.tree_ptr, pos) {}
     __rope_const_iterator& operator= (const __rope_const_iterator & x) {
-	if (0 != x.buf_ptr) {
-	    *this = x;
-	} else {
-	    current_pos = x.current_pos;
-	    root = x.root;
-	    buf_ptr = 0;
-	}
+	copy_from(x);
 	return(*this);
     }
     reference operator*() {
@@ -820,14 +911,8 @@ class __rope_iterator : public __rope_iterator_base<charT,Alloc> {
 	RopeBase *old = root;
 
 	RopeBase::ref(x.root);
-	if (0 != x.buf_ptr) {
-	    *this = x;
-	} else {
-	    current_pos = x.current_pos;
-	    root = x.root;
-	    root_rope = x.root_rope;
-	    buf_ptr = 0;
-	}
+	copy_from(x);
+	root_rope = x.root_rope;
 	RopeBase::unref(old);
 	return(*this);
     }
@@ -902,6 +987,80 @@ class __rope_iterator : public __rope_iterator_base<charT,Alloc> {
 #pragma reset woff 1375
 #endif
 
+// A piece cursor walks the characters in a range of a rope one
+// contiguous piece at a time, usually a whole leaf, so that a scan can
+// run over plain arrays instead of going through an iterator per
+// character:
+//	for (crope::piece_cursor c(r); !c.done(); c.next())
+//	    use(c.data(), c.size());
+// Leaves, substrings of leaves and contiguous() producers are handed
+// out in place.  Other function nodes are computed apply_chunk_len
+// characters at a time into a buffer owned by the cursor, which next()
+// reuses.  Like an iterator, a cursor holds no reference to the rope.
+template<class charT, class Alloc>
+class __rope_piece_cursor {
+    friend class rope<charT,Alloc>;
+  public:
+    typedef __rope_RopeBase<charT,Alloc> RopeBase;
+    __rope_piece_cursor(const rope<charT,Alloc>& r) : buf(0) {
+	init(r.tree_ptr, 0, r.size());
+    }
+    // begin and end are assumed to be in range.
+    __rope_piece_cursor(const rope<charT,Alloc>& r,
+			size_t begin, size_t end) : buf(0) {
+	init(r.tree_ptr, begin, end);
+    }
+    ~__rope_piece_cursor();
+    bool done() const { return 0 == piece_len; }
+    const charT* data() const { return piece; }
+    size_t size() const { return piece_len; }
+    // Position in the rope of data()[0].
+    size_t index() const { return pos; }
+    void next() {
+	pos += piece_len;
+	advance();
+    }
+  protected:
+    typedef __rope_RopeConcatenation<charT,Alloc> RopeConcatenation;
+    typedef __rope_RopeLeaf<charT,Alloc> RopeLeaf;
+    typedef __rope_RopeFunction<charT,Alloc> RopeFunction;
+    typedef __rope_RopeSubstring<charT,Alloc> RopeSubstring;
+    typedef simple_alloc<charT, Alloc> DataAlloc;
+    struct pending {
+	const RopeBase * node;
+	size_t begin;
+	size_t end;
+    };
+    // Right subtrees still to be visited, innermost last.  At most
+    // one per concatenation on the current path, plus the rest of
+    // a function node.
+    pending stack[RopeBase::max_rope_depth + 1];
+    int depth;
+    const charT * piece;
+    size_t piece_len;
+    size_t pos;
+    charT * buf;	// For function nodes, allocated on first use.
+    __rope_piece_cursor(const RopeBase * r, size_t begin, size_t end)
+      : buf(0) {
+	init(r, begin, end);
+    }
+    void init(const RopeBase * r, size_t begin, size_t end) {
+	depth = 0;
+	pos = begin;
+	if (0 != r && begin < end) {
+	    stack[0].node = r;
+	    stack[0].begin = begin;
+	    stack[0].end = end;
+	    depth = 1;
+	}
+	advance();
+    }
+    void advance();
+  private:
+    __rope_piece_cursor(const __rope_piece_cursor&);
+    void operator=(const __rope_piece_cursor&);
+};
+
 template <class charT, class Alloc>
 class rope {
     public:
@@ -914,6 +1073,7 @@ class rope {
 	typedef __rope_const_iterator<charT,Alloc> const_iterator;
 	typedef __rope_charT_ref_proxy<charT,Alloc> reference;
 	typedef __rope_charT_ptr_proxy<charT,Alloc> pointer;
+	typedef __rope_piece_cursor<charT,Alloc> piece_cursor;
 
 	friend class __rope_iterator<charT,Alloc>;
 	friend class __rope_const_iterator<charT,Alloc>;
@@ -922,6 +1082,7 @@ class rope {
 	friend class __rope_charT_ptr_proxy<charT,Alloc>;
 	friend class __rope_charT_ref_proxy<charT,Alloc>;
 	friend struct __rope_RopeSubstring<charT,Alloc>;
+	friend class __rope_piece_cursor<charT,Alloc>;
 
     protected:
 	typedef __GC_CONST charT * cstrptr;
@@ -939,6 +1100,19 @@ class rope {
 	    static cstrptr atomic_swap(cstrptr *p, cstrptr q) {
 		return (cstrptr) InterlockedExchange((LPLONG)p, (LONG)q);
 	    }
+#	elif defined(__STL_PTHREADS) && defined(__STL_ATOMIC_BUILTINS)
+	    static cstrptr atomic_swap(cstrptr *p, cstrptr q) {
+		cstrptr result;
+		if (__alloc_single_client<Alloc>::value) {
+		    result = *p;
+		    *p = q;
+		    return result;
+		}
+		do {
+		    result = *p;
+		} while (!__sync_bool_compare_and_swap(p, result, q));
+		return result;
+	    }
 #	elif defined(__STL_PTHREADS)
 	    // This should be portable, but performance is expected
 	    // to be quite awful.  This really needs platform specific
@@ -999,6 +1173,10 @@ class rope {
 				const RopeBase * r,
 				size_t begin, size_t end);
 				// begin and end are assumed to be in range.
+	enum { apply_chunk_len = 4096 };
+				// Function nodes are evaluated this many
+				// characters at a time by apply_to_pieces
+				// and by piece cursors.
 
 #	ifndef __GC
 	  static void unref(RopeBase* t)
@@ -1034,7 +1212,10 @@ class rope {
 						 const charT *iter, size_t slen)
 		// As above, but one reference to r is about to be
 		// destroyed.  Thus the pieces may be recycled if all
-		// relevent reference counts are 1.
+		// relevent reference counts are 1.  In that case the
+		// rightmost leaf is grown in place, and new leaves are
+		// attached low enough on the right edge that repeated
+		// appends keep the tree balanced without rebuilding it.
 #	    ifdef __GC
 		// We can't really do anything since refcounts are unavailable.
 		{ return concat_char_iter(r, iter, slen); }
@@ -1052,6 +1233,25 @@ class rope {
 	    apply_to_pieces(c, tree_ptr, begin, end);
 	}
 
+#	ifdef __STL_USE_WRITEV
+	  // Write the characters in [begin, end) to the file descriptor
+	  // fd, leaf by leaf, with writev.  Nothing is flattened, and
+	  // function nodes are evaluated apply_chunk_len characters at
+	  // a time.  Returns false, with errno set, if a write fails.
+	  bool write(int fd, size_t begin, size_t end) const;
+	  bool write(int fd) const { return write(fd, 0, size()); }
+#	endif
+
+	// Replace the contents with those of the named file.  The file
+	// is mapped, not read, so this costs the same for any size;
+	// substr, insert, replace and concatenation then build nodes
+	// over the mapped pages, and iterators and write() read them
+	// in place.  The file must not be truncated while a rope still
+	// refers to it.  Returns false, and leaves the rope unchanged,
+	// if the file cannot be opened.
+	bool map_file(const char* path);
+
+
 
    protected:
 
@@ -1066,6 +1266,39 @@ class rope {
 		return rounded_up_size(n);
 	    }
 	}
+
+	// Leaves at the right end of a rope that is being appended to
+	// are allocated in power of two sizes, from append_leaf_min up
+	// to append_leaf_max, so that they can be extended in place
+	// with amortized constant copying per character.
+	enum { append_leaf_min = 32, append_leaf_max = 1024 };
+
+	// The base 2 log of the size to allocate for a growable leaf
+	// of length n, or 0 if n is too long for one.
+	static unsigned char append_leaf_log(size_t n) {
+	    size_t sz = rounded_up_size(n);
+	    unsigned char result = 0;
+
+	    if (sz > append_leaf_max) return 0;
+	    while (((size_t)1 << result) < sz
+		   || ((size_t)1 << result) < append_leaf_min) {
+		++result;
+	    }
+	    return result;
+	}
+
+	// The number of characters that fit in the data of l.
+	static size_t leaf_capacity(const RopeLeaf * l) {
+	    if (0 == l -> leaf_capacity_log) {
+		return allocated_capacity(l -> size);
+	    }
+	    size_t sz = (size_t)1 << l -> leaf_capacity_log;
+	    if (__is_basic_char_type((charT *)0)) {
+		return sz - 1;
+	    } else {
+		return sz;
+	    }
+	}
 		
 	// s should really be an arbitrary input iterator.
 	// Adds a trailing NULL for basic char types.
@@ -1124,6 +1357,19 @@ class rope {
 	  static RopeLeaf * destr_leaf_concat_char_iter
 			(RopeLeaf * r, const charT * iter, size_t slen);
 	  // A version that potentially clobbers r if r -> refcount == 1.
+
+	  // As RopeLeaf_from_unowned_char_ptr, but the data is allocated
+	  // with 2**log characters of room.  Result has refcount 1.
+	  static RopeLeaf * RopeLeaf_for_append(const charT *s, size_t size,
+						unsigned char log);
+
+	  // Move the data of l, which must be referenced only once, to
+	  // an allocation of 2**log characters.
+	  static void grow_leaf(RopeLeaf * l, unsigned char log);
+
+	  // Recompute size and depth of a concatenation node one of
+	  // whose subtrees was changed in place, and drop its c_string.
+	  static void update_concat(RopeConcatenation * c);
 #       endif
 
 	// A helper function for exponentiating strings.
@@ -1315,7 +1561,7 @@ class rope {
 	void push_back(charT x)
 	{
 	    RopeBase *old = tree_ptr;
-	    tree_ptr = concat_char_iter(tree_ptr, &x, 1);
+	    tree_ptr = destr_concat_char_iter(tree_ptr, &x, 1);
 	    unref(old);
 	}
 
@@ -1811,11 +2057,7 @@ class rope {
 	}
 
 	size_type find(charT c, size_type pos = 0) const;
-	size_type find(charT *s, size_type pos = 0) const {
-	    const_iterator result = search(const_begin() + pos, const_end(),
-					   s, s + char_ptr_len(s));
-	    return result.index();
-	}
+	size_type find(const charT *s, size_type pos = 0) const;
 
 	iterator mutable_begin() {
 	    return(iterator(this, 0));
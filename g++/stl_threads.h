@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 1997
+ * Silicon Graphics Computer Systems, Inc.
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.  Silicon Graphics makes no
+ * representations about the suitability of this software for any
+ * purpose.  It is provided "as is" without express or implied warranty.
+ */
+
+/* NOTE: This is an internal header file, included by other STL headers.
+ *   You should not attempt to use it directly.
+ */
+
+#ifndef __SGI_STL_INTERNAL_THREADS_H
+#define __SGI_STL_INTERNAL_THREADS_H
+
+// Locking primitives for the containers that are meant to be shared
+// between threads, and a way to run a container operation on several
+// threads at once.  They follow the same configuration macros as the
+// node allocator in stl_alloc.h: __STL_PTHREADS, __STL_WIN32THREADS,
+// __STL_SGI_THREADS, or none of them for a single-threaded build.
+
+#include <stdlib.h>
+
+#if defined(__STL_PTHREADS)
+#   include <pthread.h>
+#   include <sched.h>
+#   include <unistd.h>
+#elif defined(__STL_WIN32THREADS)
+#   include <windows.h>
+#elif defined(__STL_SGI_THREADS)
+#   include <mutex.h>
+#   include <time.h>
+#endif
+
+__STL_BEGIN_NAMESPACE
+
+// A readers/writer lock.  Readers share the lock where the thread
+// package supports it; elsewhere a reader locks exclusively.
+struct __stl_rw_lock {
+#if defined(__STL_PTHREADS)
+  pthread_rwlock_t lock;
+
+  __stl_rw_lock() { pthread_rwlock_init(&lock, 0); }
+  ~__stl_rw_lock() { pthread_rwlock_destroy(&lock); }
+  void read_lock() { pthread_rwlock_rdlock(&lock); }
+  void write_lock() { pthread_rwlock_wrlock(&lock); }
+  void unlock() { pthread_rwlock_unlock(&lock); }
+#elif defined(__STL_WIN32THREADS)
+  CRITICAL_SECTION lock;
+
+  __stl_rw_lock() { InitializeCriticalSection(&lock); }
+  ~__stl_rw_lock() { DeleteCriticalSection(&lock); }
+  void read_lock() { EnterCriticalSection(&lock); }
+  void write_lock() { EnterCriticalSection(&lock); }
+  void unlock() { LeaveCriticalSection(&lock); }
+#elif defined(__STL_SGI_THREADS)
+  volatile unsigned long lock;
+
+  __stl_rw_lock() : lock(0) {}
+  void read_lock() { write_lock(); }
+  void write_lock() {
+    static struct timespec ts = {0, 1000};
+    while (test_and_set((unsigned long*) &lock, 1))
+      nanosleep(&ts, 0);
+  }
+  void unlock() {
+#   if __mips >= 3 && (defined(_ABIN32) || defined(_ABI64))
+    __lock_release(&lock);
+#   else
+    lock = 0;
+#   endif
+  }
+#else
+  __stl_rw_lock() {}
+  void read_lock() {}
+  void write_lock() {}
+  void unlock() {}
+#endif
+
+private:
+  __stl_rw_lock(const __stl_rw_lock&);
+  void operator=(const __stl_rw_lock&);
+};
+
+// Lets another thread run, for a thread that is waiting for one.
+inline void __stl_thread_yield()
+{
+#if defined(__STL_PTHREADS)
+  sched_yield();
+#elif defined(__STL_WIN32THREADS)
+  Sleep(0);
+#elif defined(__STL_SGI_THREADS)
+  static struct timespec ts = {0, 1000};
+  nanosleep(&ts, 0);
+#endif
+}
+
+// A mutex with a condition, for threads that wait for a change to the
+// state it guards.  wait() releases the mutex while it sleeps and holds
+// it again when it returns, which may be before anyone has notified, so
+// callers test their condition in a loop.  Without pthreads, tasks run
+// one after another, and wait() only gives up the processor.
+struct __stl_monitor {
+#if defined(__STL_PTHREADS)
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+
+  __stl_monitor()
+    { pthread_mutex_init(&mutex, 0); pthread_cond_init(&cond, 0); }
+  ~__stl_monitor()
+    { pthread_cond_destroy(&cond); pthread_mutex_destroy(&mutex); }
+  void lock() { pthread_mutex_lock(&mutex); }
+  void unlock() { pthread_mutex_unlock(&mutex); }
+  void wait() { pthread_cond_wait(&cond, &mutex); }
+  void notify_one() { pthread_cond_signal(&cond); }
+  void notify_all() { pthread_cond_broadcast(&cond); }
+#else
+  __stl_rw_lock mutex;
+
+  __stl_monitor() {}
+  void lock() { mutex.write_lock(); }
+  void unlock() { mutex.unlock(); }
+  void wait() { unlock(); __stl_thread_yield(); lock(); }
+  void notify_one() {}
+  void notify_all() {}
+#endif
+
+private:
+  __stl_monitor(const __stl_monitor&);
+  void operator=(const __stl_monitor&);
+};
+
+// Scoped holders, so that a lock is released if the guarded code throws.
+struct __stl_read_guard {
+  __stl_rw_lock& lock;
+  explicit __stl_read_guard(__stl_rw_lock& l) : lock(l)
+    { lock.read_lock(); }
+  ~__stl_read_guard() { lock.unlock(); }
+};
+
+struct __stl_write_guard {
+  __stl_rw_lock& lock;
+  explicit __stl_write_guard(__stl_rw_lock& l) : lock(l)
+    { lock.write_lock(); }
+  ~__stl_write_guard() { lock.unlock(); }
+};
+
+struct __stl_monitor_guard {
+  __stl_monitor& monitor;
+  explicit __stl_monitor_guard(__stl_monitor& m) : monitor(m)
+    { monitor.lock(); }
+  ~__stl_monitor_guard() { monitor.unlock(); }
+};
+
+// The number of processors online, or 0 if it is not known.
+inline size_t __stl_processor_count()
+{
+#if defined(__STL_PTHREADS) && defined(_SC_NPROCESSORS_ONLN)
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? size_t(n) : 0;
+#else
+  return 0;
+#endif
+}
+
+// __stl_run_tasks(n, fn, arg) calls fn(arg, i) for every i in [0, n) and
+// returns when all the calls have finished.  With __STL_PTHREADS the
+// calls run on n threads at once, one of them the calling thread;
+// elsewhere they run one after another.
+//
+// An exception cannot be carried from one thread to another, so a task
+// that throws on a worker thread is simply run again on the calling
+// thread once the others have finished, and this time its exception
+// propagates.  Every failed task is run again, even if an earlier one
+// throws again; the exception that propagates is then the last one
+// thrown.  A task must therefore be safe to restart after it has
+// thrown.
+typedef void (*__stl_task_fn)(void*, size_t);
+
+struct __stl_task {
+  __stl_task_fn fn;
+  void* arg;
+  size_t index;
+  bool failed;
+
+  static void* run(void* p)
+  {
+    __stl_task* t = (__stl_task*) p;
+    __STL_TRY {
+      t->fn(t->arg, t->index);
+    }
+    __STL_CATCH_ALL {
+      t->failed = true;
+    }
+    return 0;
+  }
+
+  // Runs the failed tasks among tasks[i, n) again on this thread.  If
+  // one throws, the rest are still run before the exception leaves.
+  static void rerun_failed(__stl_task* tasks, size_t i, size_t n)
+  {
+    while (i < n && !tasks[i].failed)
+      ++i;
+    if (i == n)
+      return;
+    __STL_TRY {
+      tasks[i].fn(tasks[i].arg, i);
+    }
+    __STL_UNWIND(rerun_failed(tasks, i + 1, n));
+    rerun_failed(tasks, i + 1, n);
+  }
+};
+
+inline void __stl_run_tasks(size_t n, __stl_task_fn fn, void* arg)
+{
+#ifdef __STL_PTHREADS
+  __stl_task* tasks = 0;
+  pthread_t* threads = 0;
+  bool* started = 0;
+  if (n > 1) {
+    tasks = (__stl_task*) malloc(n * sizeof(__stl_task));
+    threads = (pthread_t*) malloc(n * sizeof(pthread_t));
+    started = (bool*) malloc(n * sizeof(bool));
+  }
+  if (tasks && threads && started) {
+    size_t i;
+    for (i = 0; i < n; ++i) {
+      tasks[i].fn = fn;
+      tasks[i].arg = arg;
+      tasks[i].index = i;
+      tasks[i].failed = false;
+      started[i] = i > 0 && pthread_create(&threads[i], 0, __stl_task::run,
+                                           &tasks[i]) == 0;
+    }
+    // Tasks that could not be given a thread run here, in order.
+    for (i = 0; i < n; ++i)
+      if (!started[i])
+        __stl_task::run(&tasks[i]);
+    for (i = 1; i < n; ++i)
+      if (started[i])
+        pthread_join(threads[i], 0);
+    free(threads);
+    free(started);
+    __STL_TRY {
+      __stl_task::rerun_failed(tasks, 0, n);
+    }
+    __STL_UNWIND(free(tasks));
+    free(tasks);
+    return;
+  }
+  free(tasks);
+  free(threads);
+  free(started);
+#endif /* __STL_PTHREADS */
+  for (size_t i = 0; i < n; ++i)
+    fn(arg, i);
+}
+
+__STL_END_NAMESPACE
+
+#endif /* __SGI_STL_INTERNAL_THREADS_H */
+
+// Local Variables:
+// mode:C++
+// End:
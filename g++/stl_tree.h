@@ -698,6 +698,98 @@ public:
   pair<iterator, iterator> equal_range(const key_type &x);
   pair<const_iterator, const_iterator> equal_range(const key_type &x) const;
 
+#ifdef __STL_MEMBER_TEMPLATES
+  // Lookup by any type K that key_compare accepts in either argument
+  // position, if Compare declares is_transparent.  No key_type is built.
+  template <class K>
+  iterator find(const K &k, __STL_IF_TRANSPARENT(Compare, K))
+  {
+    iterator j = iterator(lower_bound_node(k));
+    return (j == end() || key_compare(k, key(j.node))) ? end() : j;
+  }
+  template <class K>
+  const_iterator find(const K &k, __STL_IF_TRANSPARENT(Compare, K)) const
+  {
+    const_iterator j = const_iterator(lower_bound_node(k));
+    return (j == end() || key_compare(k, key(j.node))) ? end() : j;
+  }
+  template <class K>
+  size_type count(const K &k, __STL_IF_TRANSPARENT(Compare, K)) const
+  {
+    size_type n = 0;
+    distance(const_iterator(lower_bound_node(k)),
+             const_iterator(upper_bound_node(k)), n);
+    return n;
+  }
+  template <class K>
+  iterator lower_bound(const K &k, __STL_IF_TRANSPARENT(Compare, K))
+  {
+    return iterator(lower_bound_node(k));
+  }
+  template <class K>
+  const_iterator lower_bound(const K &k,
+                             __STL_IF_TRANSPARENT(Compare, K)) const
+  {
+    return const_iterator(lower_bound_node(k));
+  }
+  template <class K>
+  iterator upper_bound(const K &k, __STL_IF_TRANSPARENT(Compare, K))
+  {
+    return iterator(upper_bound_node(k));
+  }
+  template <class K>
+  const_iterator upper_bound(const K &k,
+                             __STL_IF_TRANSPARENT(Compare, K)) const
+  {
+    return const_iterator(upper_bound_node(k));
+  }
+  template <class K>
+  pair<iterator, iterator> equal_range(const K &k,
+                                       __STL_IF_TRANSPARENT(Compare, K))
+  {
+    return pair<iterator, iterator>(iterator(lower_bound_node(k)),
+                                    iterator(upper_bound_node(k)));
+  }
+  template <class K>
+  pair<const_iterator, const_iterator>
+  equal_range(const K &k, __STL_IF_TRANSPARENT(Compare, K)) const
+  {
+    return pair<const_iterator, const_iterator>(
+        const_iterator(lower_bound_node(k)),
+        const_iterator(upper_bound_node(k)));
+  }
+
+private:
+  template <class K>
+  link_type lower_bound_node(const K &k) const
+  {
+    link_type y = header; /* Last node which is not less than k. */
+    link_type x = root(); /* Current node. */
+
+    while (x != 0)
+      if (!key_compare(key(x), k))
+        y = x, x = left(x);
+      else
+        x = right(x);
+
+    return y;
+  }
+  template <class K>
+  link_type upper_bound_node(const K &k) const
+  {
+    link_type y = header; /* Last node which is greater than k. */
+    link_type x = root(); /* Current node. */
+
+    while (x != 0)
+      if (key_compare(k, key(x)))
+        y = x, x = left(x);
+      else
+        x = right(x);
+
+    return y;
+  }
+#endif /* __STL_MEMBER_TEMPLATES */
+
 public:
   // Debugging.
   bool __rb_verify() const;
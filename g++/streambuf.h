@@ -284,11 +284,18 @@ class streammarker : private _IO_marker {
     int delta();
 };
 
+template <class charT, class traits, class Allocator> class basic_string;
+
 struct streambuf : public _IO_FILE { // protected??
     friend class ios;
     friend class istream;
     friend class ostream;
     friend class streammarker;
+    // The string extractors take whole runs of the get area at once.
+    template <class charT, class traits, class Allocator> friend istream&
+      operator>>(istream&, basic_string<charT, traits, Allocator>&);
+    template <class charT, class traits, class Allocator> friend istream&
+      getline(istream&, basic_string<charT, traits, Allocator>&, charT);
     const void *&_vtable() { return *(const void**)((_IO_FILE*)this + 1); }
   protected:
     static streambuf* _list_all; /* List of open streambufs. */
@@ -0,0 +1,95 @@
+// Helpers shared by the tests and benchmarks in this directory.
+
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// Wall-clock time in seconds.
+static double bench_seconds()
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// argv[i] as a count, or dflt if there is no such argument.
+static long bench_arg(int argc, char** argv, int i, long dflt)
+{
+  return i < argc ? atol(argv[i]) : dflt;
+}
+
+// A small, fast generator, so that runs are repeatable and the
+// generator does not dominate the loops it feeds.
+struct bench_random
+{
+  unsigned long long state;
+  explicit bench_random(unsigned long long seed) : state(seed * 2 + 1) {}
+  unsigned long long next()
+  {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+  }
+  unsigned long below(unsigned long n) { return next() % n; }
+};
+
+// Shuffles [first, first + n).
+template <class T>
+void bench_shuffle(T* first, long n, bench_random& r)
+{
+  for (long i = n - 1; i > 0; --i) {
+    long j = r.below(i + 1);
+    T t = first[i];
+    first[i] = first[j];
+    first[j] = t;
+  }
+}
+
+// The number of processors online, and at least one.
+static long bench_processors()
+{
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? n : 1;
+}
+
+typedef void (*bench_thread_fn)(void* arg, long i);
+
+struct bench_thread
+{
+  bench_thread_fn fn;
+  void* arg;
+  long i;
+  static void* start(void* p)
+  {
+    bench_thread& t = *(bench_thread*) p;
+    t.fn(t.arg, t.i);
+    return 0;
+  }
+};
+
+// Calls fn(arg, i) on n threads, for i from 0 to n - 1, and waits for
+// them all.  Thread 0 is the calling thread.
+static void bench_run_threads(long n, bench_thread_fn fn, void* arg)
+{
+  pthread_t* ids = new pthread_t[n];
+  bench_thread* t = new bench_thread[n];
+  for (long i = 0; i < n; ++i) {
+    t[i].fn = fn;
+    t[i].arg = arg;
+    t[i].i = i;
+    if (i > 0 && pthread_create(&ids[i], 0, bench_thread::start, &t[i]))
+      abort();
+  }
+  fn(arg, 0);
+  for (long i = 1; i < n; ++i)
+    pthread_join(ids[i], 0);
+  delete[] t;
+  delete[] ids;
+}
+
+#endif
@@ -0,0 +1,189 @@
+// concurrent_hash_map under several threads at once: find_or_insert,
+// update, visit and erase on keys that the threads share.
+
+#include <concurrent_hash_map>
+#include <stdio.h>
+#include "bench.h"
+
+static const long threads = 8;
+static const unsigned keys = 20000;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+// Each thread counts its own failed checks, so that the main thread
+// can report them after the join.
+static long thread_failures[threads];
+
+// Every thread asks for every key, each in its own order, offering its
+// own number as the value.  All of them must get the same answer.
+typedef concurrent_hash_map<unsigned, long> counts;
+static counts* first_map;
+static long* first_seen;
+
+static void find_or_insert_thread(void*, long t)
+{
+  for (unsigned i = 0; i < keys; ++i) {
+    const unsigned k = (i * 7919 + t * 104729) % keys;
+    first_seen[t * keys + k] = first_map->find_or_insert(counts::value_type(k, t));
+  }
+}
+
+// Every thread adds one to every key rounds times.
+static const long rounds = 20;
+static counts* sum_map;
+
+struct increment
+{
+  void operator()(counts::value_type& v) const { ++v.second; }
+};
+
+static void update_thread(void*, long t)
+{
+  for (long r = 0; r < rounds; ++r)
+    for (unsigned i = 0; i < keys; ++i) {
+      const unsigned k = (i + t * 1000) % keys;
+      if (k % 2)
+        sum_map->update(k, increment());
+      else
+        sum_map->insert_or_update(counts::value_type(k, 0), increment());
+    }
+}
+
+// Writers set both halves of a value under the write lock; readers must
+// never see the halves differ.
+struct twin
+{
+  long a, b;
+};
+typedef concurrent_hash_map<unsigned, twin> twins;
+static twins* twin_map;
+
+struct set_twin
+{
+  long x;
+  explicit set_twin(long v) : x(v) {}
+  void operator()(twins::value_type& v) const
+  {
+    v.second.a = x;
+    v.second.b = x;
+  }
+};
+
+struct check_twin
+{
+  long* bad;
+  explicit check_twin(long* p) : bad(p) {}
+  void operator()(const twins::value_type& v) const
+  {
+    if (v.second.a != v.second.b)
+      ++*bad;
+  }
+};
+
+static void visit_thread(void*, long t)
+{
+  for (long r = 0; r < rounds; ++r)
+    for (unsigned k = 0; k < keys; k += 7) {
+      if (t % 2)
+        twin_map->update(k, set_twin(r * keys + k));
+      else
+        twin_map->visit(k, check_twin(&thread_failures[t]));
+    }
+}
+
+// Every thread tries to erase every shared key; each must go once.  In
+// between, each inserts and erases keys of its own.
+static counts* erase_map;
+static long erased[threads];
+
+static void erase_thread(void*, long t)
+{
+  const unsigned own = keys * (t + 1);
+  for (unsigned i = 0; i < keys; ++i) {
+    erased[t] += erase_map->erase((i * 31 + t * 977) % keys);
+    if (!erase_map->insert(counts::value_type(own + i, t)))
+      ++thread_failures[t];
+    if (i % 2 && erase_map->erase(own + i) != 1)
+      ++thread_failures[t];
+  }
+}
+
+int main()
+{
+  {
+    counts m;
+    first_map = &m;
+    first_seen = new long[threads * keys];
+    bench_run_threads(threads, find_or_insert_thread, 0);
+    check(m.size() == keys, "find_or_insert: size");
+    bool agree = true;
+    for (unsigned k = 0; k < keys; ++k) {
+      long v = -1;
+      m.find(k, v);
+      for (long t = 0; t < threads; ++t)
+        agree = agree && first_seen[t * keys + k] == v;
+    }
+    check(agree, "find_or_insert: every thread sees the first value");
+    delete[] first_seen;
+  }
+
+  {
+    counts m;
+    for (unsigned k = 1; k < keys; k += 2)
+      m.insert(counts::value_type(k, 0));
+    sum_map = &m;
+    bench_run_threads(threads, update_thread, 0);
+    bool right = m.size() == keys;
+    for (unsigned k = 0; k < keys; ++k) {
+      long v = 0;
+      right = right && m.find(k, v) && v == threads * rounds;
+    }
+    check(right, "update: no increment lost");
+  }
+
+  {
+    twins m;
+    for (unsigned k = 0; k < keys; ++k) {
+      twin v = { 0, 0 };
+      m.insert(twins::value_type(k, v));
+    }
+    twin_map = &m;
+    bench_run_threads(threads, visit_thread, 0);
+    long bad = 0;
+    for (long t = 0; t < threads; ++t)
+      bad += thread_failures[t];
+    check(bad == 0, "visit: never sees a half-done update");
+  }
+
+  {
+    counts m;
+    for (unsigned k = 0; k < keys; ++k)
+      m.insert(counts::value_type(k, 0));
+    erase_map = &m;
+    for (long t = 0; t < threads; ++t)
+      thread_failures[t] = 0;
+    bench_run_threads(threads, erase_thread, 0);
+    long total = 0, bad = 0;
+    for (long t = 0; t < threads; ++t) {
+      total += erased[t];
+      bad += thread_failures[t];
+    }
+    check(total == keys, "erase: each shared key erased once");
+    check(bad == 0, "erase: own keys inserted and erased");
+    check(m.size() == threads * (keys / 2), "erase: size");
+    for (unsigned k = 0; k < keys; ++k)
+      check(m.count(k) == 0, "erase: shared keys gone");
+  }
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
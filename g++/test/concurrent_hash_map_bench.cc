@@ -0,0 +1,111 @@
+// How concurrent_hash_map scales with threads under a mix of reads and
+// writes, next to one hash_map behind one readers/writer lock.  Each
+// operation picks a random key; a read is a find, and a write is an
+// insertion or an erasure with equal odds, so the size stays near half
+// the keys.
+//
+// Usage: concurrent_hash_map_bench [max_threads [read_percent
+//                                   [ops_per_thread [keys]]]]
+// max_threads defaults to the number of processors.
+
+#include <concurrent_hash_map>
+#include <hash_map.h>
+#include <stdio.h>
+#include "bench.h"
+
+typedef concurrent_hash_map<unsigned, unsigned> sharded;
+typedef hash_map<unsigned, unsigned> plain;
+
+static long read_percent;
+static long ops;
+static unsigned long keys;
+
+static sharded* sharded_map;
+static plain* plain_map;
+static pthread_rwlock_t plain_lock = PTHREAD_RWLOCK_INITIALIZER;
+static unsigned long hits[256];
+
+static void sharded_thread(void*, long t)
+{
+  bench_random r(t + 1);
+  unsigned long found = 0;
+  for (long i = 0; i < ops; ++i) {
+    const unsigned k = r.below(keys);
+    if (long(r.below(100)) < read_percent) {
+      unsigned v;
+      found += sharded_map->find(k, v);
+    }
+    else if (r.below(2))
+      sharded_map->insert(sharded::value_type(k, k));
+    else
+      sharded_map->erase(k);
+  }
+  hits[t % 256] = found;
+}
+
+static void plain_thread(void*, long t)
+{
+  bench_random r(t + 1);
+  unsigned long found = 0;
+  for (long i = 0; i < ops; ++i) {
+    const unsigned k = r.below(keys);
+    if (long(r.below(100)) < read_percent) {
+      pthread_rwlock_rdlock(&plain_lock);
+      found += plain_map->find(k) != plain_map->end();
+      pthread_rwlock_unlock(&plain_lock);
+    }
+    else {
+      pthread_rwlock_wrlock(&plain_lock);
+      if (r.below(2))
+        plain_map->insert(plain::value_type(k, k));
+      else
+        plain_map->erase(k);
+      pthread_rwlock_unlock(&plain_lock);
+    }
+  }
+  hits[t % 256] = found;
+}
+
+static double run(bench_thread_fn fn, long n)
+{
+  sharded s;
+  plain p;
+  sharded_map = &s;
+  plain_map = &p;
+  for (unsigned k = 0; k < keys; k += 2) {
+    s.insert(sharded::value_type(k, k));
+    p.insert(plain::value_type(k, k));
+  }
+  const double t = bench_seconds();
+  bench_run_threads(n, fn, 0);
+  return bench_seconds() - t;
+}
+
+int main(int argc, char** argv)
+{
+  const long max_threads = bench_arg(argc, argv, 1, bench_processors());
+  read_percent = bench_arg(argc, argv, 2, 90);
+  ops = bench_arg(argc, argv, 3, 1000000);
+  keys = bench_arg(argc, argv, 4, 1000000);
+
+  printf("%ld%% reads, %ld operations per thread, %lu keys\n",
+         read_percent, ops, keys);
+  printf("threads  concurrent_hash_map        hash_map + rwlock\n");
+  double base_sharded = 0, base_plain = 0;
+  // Powers of two, and max_threads last.
+  for (long n = 1; ; n = n * 2 < max_threads ? n * 2 : max_threads) {
+    const double ts = run(sharded_thread, n);
+    const double tp = run(plain_thread, n);
+    const double mops_s = n * ops / ts * 1e-6;
+    const double mops_p = n * ops / tp * 1e-6;
+    if (n == 1) {
+      base_sharded = mops_s;
+      base_plain = mops_p;
+    }
+    printf("%7ld  %7.2f Mop/s  x%5.2f     %7.2f Mop/s  x%5.2f\n",
+           n, mops_s, mops_s / base_sharded, mops_p, mops_p / base_plain);
+    if (n == max_threads)
+      break;
+  }
+  return 0;
+}
@@ -0,0 +1,100 @@
+// flat_hash_map against hash_map under a random mix of operations, and
+// the limits of its capacity.
+
+#include <hash_map.h>
+#include <flat_hash_map>
+#include <flat_hash_set>
+#include <stdio.h>
+#include "bench.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+int main()
+{
+  {
+    // Keys from a small range, so that erasures leave tombstones that
+    // later insertions must reuse or rebuild away.
+    flat_hash_map<int, int> f;
+    hash_map<int, int> h;
+    bench_random r(1);
+    bool same = true;
+    for (int i = 0; i < 1000000 && same; ++i) {
+      const int k = r.below(50000);
+      switch (r.below(4)) {
+      case 0:
+        f[k] = i;
+        h[k] = i;
+        break;
+      case 1:
+        same = f.erase(k) == h.erase(k);
+        break;
+      default: {
+        flat_hash_map<int, int>::iterator a = f.find(k);
+        hash_map<int, int>::iterator b = h.find(k);
+        same = (a == f.end()) == (b == h.end())
+               && (a == f.end() || a->second == b->second);
+      }
+      }
+      same = same && f.size() == h.size();
+    }
+    check(same, "random operations: same as hash_map");
+
+    size_t n = 0;
+    for (flat_hash_map<int, int>::iterator i = f.begin(); i != f.end(); ++i) {
+      ++n;
+      check(h[i->first] == i->second, "iteration: values");
+    }
+    check(n == f.size(), "iteration: count");
+
+    // Erasing through an iterator leaves the others valid.
+    for (flat_hash_map<int, int>::iterator i = f.begin(); i != f.end(); ++i)
+      if (i->first & 1)
+        f.erase(i);
+    for (flat_hash_map<int, int>::iterator i = f.begin(); i != f.end(); ++i)
+      check(!(i->first & 1), "erase while iterating");
+
+    const size_t kept = f.size();
+    flat_hash_map<int, int> g(f);
+    check(g.size() == kept, "copy: size");
+    g.clear();
+    g.swap(f);
+    check(f.size() == 0 && g.size() == kept, "clear and swap");
+  }
+
+  {
+    flat_hash_set<const char*> s;
+    s.insert("abc");
+    s.insert("def");
+    check(s.count("abc") == 1 && s.count("xyz") == 0, "string keys");
+  }
+
+#ifdef __STL_USE_EXCEPTIONS
+  {
+    // More slots than can be addressed is a length error, and leaves
+    // the table as it was.
+    flat_hash_map<int, int> f;
+    f[1] = 1;
+    bool thrown = false;
+    try {
+      f.resize(size_t(-1));
+    }
+    catch (...) {
+      thrown = true;
+    }
+    check(thrown, "resize (size_t (-1)) throws");
+    check(f.size() == 1 && f[1] == 1, "resize (size_t (-1)) keeps elements");
+  }
+#endif
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
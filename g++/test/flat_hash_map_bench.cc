@@ -0,0 +1,68 @@
+// Compares flat_hash_map with hash_map on int keys: inserting, finding
+// keys that are present, finding keys that are not, and erasing.
+//
+// Usage: flat_hash_map_bench [elements [rounds]]
+
+#include <hash_map.h>
+#include <flat_hash_map>
+#include <stdio.h>
+#include "bench.h"
+
+static unsigned* keys;
+static unsigned* order;
+static long n;
+
+template <class Map>
+static void run(const char* name, long rounds)
+{
+  double insert = 0, hit = 0, miss = 0, erase = 0;
+  long sum = 0;
+  for (long r = 0; r < rounds; ++r) {
+    Map m;
+    double t = bench_seconds();
+    for (long i = 0; i < n; ++i)
+      m[keys[i]] = i;
+    insert += bench_seconds() - t;
+
+    t = bench_seconds();
+    for (long i = 0; i < n; ++i)
+      sum += m.find(keys[order[i]])->second;
+    hit += bench_seconds() - t;
+
+    // The keys are all even, so an odd key is always a miss.
+    t = bench_seconds();
+    for (long i = 0; i < n; ++i)
+      sum += m.count(keys[order[i]] + 1);
+    miss += bench_seconds() - t;
+
+    t = bench_seconds();
+    for (long i = 0; i < n; ++i)
+      sum += m.erase(keys[order[i]]);
+    erase += bench_seconds() - t;
+  }
+  const double per = 1e9 / (double(n) * rounds);
+  printf("%-14s insert %6.1f  hit %6.1f  miss %6.1f  erase %6.1f"
+         "  ns/op (%ld)\n",
+         name, insert * per, hit * per, miss * per, erase * per, sum);
+}
+
+int main(int argc, char** argv)
+{
+  n = bench_arg(argc, argv, 1, 1000000);
+  const long rounds = bench_arg(argc, argv, 2, 3);
+  keys = new unsigned[n];
+  order = new unsigned[n];
+  bench_random r(1);
+  // Distinct even keys, scattered over the whole range.
+  for (long i = 0; i < n; ++i) {
+    keys[i] = (unsigned(i) * 2654435761u) << 1;
+    order[i] = i;
+  }
+  bench_shuffle(keys, n, r);
+  bench_shuffle(order, n, r);
+
+  printf("%ld elements, %ld rounds\n", n, rounds);
+  run<hash_map<unsigned, long> >("hash_map", rounds);
+  run<flat_hash_map<unsigned, long> >("flat_hash_map", rounds);
+  return 0;
+}
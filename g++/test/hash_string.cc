@@ -0,0 +1,126 @@
+// The quality of __stl_hash_string, the default hash of strings.
+//
+// Avalanche: flipping any one bit of a key should flip each bit of the
+// hash with probability one half.  Distribution: keys that share a long
+// prefix and differ in a counter at the end, as URLs and path names do,
+// should fill the buckets of a table as well as random numbers would,
+// whichever bits of the hash the table uses.
+
+#include <hash_map.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, long n)
+{
+  if (!ok) {
+    printf("FAIL: %s (%ld)\n", what, n);
+    ++failures;
+  }
+}
+
+static const int hash_bits = sizeof(size_t) * 8;
+
+// The largest distance from 1/2 of the probability that flipping an
+// input bit flips an output bit, over all pairs of bits, and the number
+// of independent samples behind each probability.  Keys of one or two
+// bytes are all tried; longer ones are random.
+static double worst_bias(size_t len, long trials, bench_random& r,
+                         long& samples)
+{
+  static long flips[128 * 8][sizeof(size_t) * 8];
+  memset(flips, 0, sizeof flips);
+  char key[128];
+  if (len <= 2)
+    trials = 1L << (8 * len);
+  for (long t = 0; t < trials; ++t) {
+    for (size_t i = 0; i < len; ++i)
+      key[i] = char(len <= 2 ? t >> (8 * i) : r.next());
+    const size_t h = __stl_hash_string(key, len);
+    for (size_t b = 0; b < len * 8; ++b) {
+      key[b / 8] ^= char(1 << (b % 8));
+      const size_t d = h ^ __stl_hash_string(key, len);
+      key[b / 8] ^= char(1 << (b % 8));
+      for (int o = 0; o < hash_bits; ++o)
+        flips[b][o] += (d >> o) & 1;
+    }
+  }
+  // Trying every key tries each pair of keys twice.
+  samples = len <= 2 ? trials / 2 : trials;
+  double worst = 0;
+  for (size_t b = 0; b < len * 8; ++b)
+    for (int o = 0; o < hash_bits; ++o) {
+      double bias = double(flips[b][o]) / trials - 0.5;
+      if (bias < 0)
+        bias = -bias;
+      if (bias > worst)
+        worst = bias;
+    }
+  return worst;
+}
+
+// The number of distinct values of 16 bits of the hash, starting at
+// bit shift, over n keys that differ only in a counter at the end.
+static long occupied(int shift, long n)
+{
+  static char used[1 << 16];
+  memset(used, 0, sizeof used);
+  char key[64];
+  long count = 0;
+  for (long i = 0; i < n; ++i) {
+    const int len = sprintf(key, "http://www.example.com/catalog/item/%ld", i);
+    const size_t h = __stl_hash_string(key, len);
+    count += !used[(h >> shift) & 0xffff]++;
+  }
+  return count;
+}
+
+int main()
+{
+  bench_random r(1);
+
+  // Each probability has a sampling error of 0.5 / sqrt (samples).  A
+  // random function stays within about four times that over the tens
+  // of thousands of pairs of bits tried; allow six.
+  static const size_t lengths[] = {
+    1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 40, 63, 64, 65, 100
+  };
+  for (size_t i = 0; i < sizeof lengths / sizeof *lengths; ++i) {
+    long samples;
+    const double bias = worst_bias(lengths[i], 2000, r, samples);
+    check(bias < 6 * 0.5 / sqrt(double(samples)),
+          "avalanche: bias at length", lengths[i]);
+  }
+
+  // 65536 keys in 65536 buckets: a random function leaves a fraction
+  // 1/e of them empty, that is, about 41427 occupied.
+  for (int shift = 0; shift + 16 <= hash_bits; shift += 8) {
+    const long n = occupied(shift, 65536);
+    check(n > 40800 && n < 42100, "distribution: bits from", shift);
+  }
+
+  // The NUL-terminated form, hash<const char*> and the byte counts all
+  // agree, wherever the key sits in memory.
+  {
+    char buf[128];
+    const char* text = "the quick brown fox jumps over the lazy dog, twice";
+    const size_t len = strlen(text);
+    const size_t h = __stl_hash_string(text, len);
+    check(__stl_hash_string(text) == h, "NUL-terminated form", 0);
+    check(hash<const char*>()(text) == h, "hash<const char*>", 0);
+    for (int offset = 0; offset < 16; ++offset) {
+      memcpy(buf + offset, text, len + 1);
+      check(__stl_hash_string(buf + offset, len) == h, "alignment", offset);
+    }
+    check(__stl_hash_string(text, len - 1) != h, "length matters", 0);
+    check(__stl_hash_string("", 0) != __stl_hash_string("\0", 1),
+          "trailing NUL bytes matter", 0);
+  }
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
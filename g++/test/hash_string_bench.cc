@@ -0,0 +1,102 @@
+// Throughput of __stl_hash_string, next to the byte-at-a-time 5*h + c
+// loop it replaced, and the cost of each in a hash_map keyed on URLs.
+//
+// Usage: hash_string_bench [bytes_per_length [url_keys]]
+
+#include <hash_map.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+
+// The hash of strings before the word-at-a-time version.
+static size_t hash_5hc(const char* s)
+{
+  unsigned long h = 0;
+  for ( ; *s; ++s)
+    h = 5 * h + *s;
+  return size_t(h);
+}
+
+struct hash_new
+{
+  size_t operator()(const char* s) const { return __stl_hash_string(s); }
+};
+
+struct hash_old
+{
+  size_t operator()(const char* s) const { return hash_5hc(s); }
+};
+
+struct str_equal
+{
+  bool operator()(const char* a, const char* b) const
+    { return strcmp(a, b) == 0; }
+};
+
+static char** urls;
+static long n_urls;
+
+template <class Hash>
+static void run_map(const char* name)
+{
+  hash_map<const char*, long, Hash, str_equal> m;
+  double t = bench_seconds();
+  for (long i = 0; i < n_urls; ++i)
+    m[urls[i]] = i;
+  const double insert = bench_seconds() - t;
+  long sum = 0;
+  t = bench_seconds();
+  for (long r = 0; r < 4; ++r)
+    for (long i = 0; i < n_urls; ++i)
+      sum += m.find(urls[(i * 7919) % n_urls])->second;
+  const double find = (bench_seconds() - t) / 4;
+  printf("hash_map %-9s insert %6.1f  find %6.1f  ns/key (%ld)\n",
+         name, insert * 1e9 / n_urls, find * 1e9 / n_urls, sum);
+}
+
+int main(int argc, char** argv)
+{
+  const long total = bench_arg(argc, argv, 1, 200000000);
+  n_urls = bench_arg(argc, argv, 2, 500000);
+
+  static const long lengths[] = { 4, 8, 16, 32, 64, 256, 4096 };
+  char* buf = new char[4097];
+  for (int i = 0; i < 4096; ++i)
+    buf[i] = 'a' + i % 26;
+  printf("length  __stl_hash_string       5*h + c\n");
+  for (size_t l = 0; l < sizeof lengths / sizeof *lengths; ++l) {
+    const long len = lengths[l];
+    const long iters = total / len;
+    buf[len] = 0;
+    size_t acc = 0;
+    // Changing the first byte keeps the compiler from hoisting the hash
+    // out of the loop.
+    double t = bench_seconds();
+    for (long i = 0; i < iters; ++i) {
+      buf[0] = 'a' + (i & 15);
+      acc += __stl_hash_string(buf, len);
+    }
+    const double t_new = bench_seconds() - t;
+    t = bench_seconds();
+    for (long i = 0; i < iters; ++i) {
+      buf[0] = 'a' + (i & 15);
+      acc += hash_5hc(buf);
+    }
+    const double t_old = bench_seconds() - t;
+    buf[len] = 'a' + len % 26;
+    printf("%6ld  %6.2f GB/s %6.1f ns   %6.2f GB/s %6.1f ns (%u)\n", len,
+           total / t_new * 1e-9, t_new / iters * 1e9,
+           total / t_old * 1e-9, t_old / iters * 1e9, unsigned(acc & 1));
+  }
+
+  // Keys with a long common prefix, which the old hash spreads poorly
+  // over the low bits.
+  urls = new char*[n_urls];
+  for (long i = 0; i < n_urls; ++i) {
+    urls[i] = new char[64];
+    sprintf(urls[i], "http://www.example.com/catalog/item/%ld", i);
+  }
+  run_map<hash_new>("new");
+  run_map<hash_old>("5*h + c");
+  return 0;
+}
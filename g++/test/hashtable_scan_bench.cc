@@ -0,0 +1,72 @@
+// The cost of walking a hash_map from begin () to end ().  Iterators
+// keep the index of their bucket, so a walk should make no calls to the
+// hash function at all; before they did, each step off the end of a
+// chain hashed the key again to find the next bucket.
+//
+// Usage: hashtable_scan_bench [elements [scans]]
+
+#include <hash_map.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+
+struct str_equal
+{
+  bool operator()(const char* a, const char* b) const
+    { return strcmp(a, b) == 0; }
+};
+
+static long hash_calls;
+
+struct counting_string_hash
+{
+  size_t operator()(const char* s) const
+  {
+    ++hash_calls;
+    return __stl_hash_string(s);
+  }
+};
+
+struct counting_int_hash
+{
+  size_t operator()(long k) const
+  {
+    ++hash_calls;
+    return k;
+  }
+};
+
+template <class Map>
+static void scan(const char* name, const Map& m, long scans)
+{
+  hash_calls = 0;
+  long sum = 0;
+  const double t = bench_seconds();
+  for (long r = 0; r < scans; ++r)
+    for (typename Map::const_iterator i = m.begin(); i != m.end(); ++i)
+      sum += i->second;
+  const double elapsed = bench_seconds() - t;
+  printf("%-12s %6.2f ns/element  %ld hash calls per scan (%ld)\n", name,
+         elapsed * 1e9 / (double(m.size()) * scans), hash_calls / scans, sum);
+}
+
+int main(int argc, char** argv)
+{
+  const long n = bench_arg(argc, argv, 1, 1000000);
+  const long scans = bench_arg(argc, argv, 2, 10);
+
+  char** keys = new char*[n];
+  hash_map<const char*, long, counting_string_hash, str_equal> strings;
+  hash_map<long, long, counting_int_hash> ints;
+  for (long i = 0; i < n; ++i) {
+    keys[i] = new char[48];
+    sprintf(keys[i], "http://www.example.com/some/long/path/%ld", i);
+    strings[keys[i]] = i;
+    ints[i * 7919] = i;
+  }
+  printf("%ld elements, %lu buckets, %ld scans\n", n,
+         (unsigned long) strings.bucket_count(), scans);
+  scan("string keys", strings, scans);
+  scan("int keys", ints, scans);
+  return 0;
+}
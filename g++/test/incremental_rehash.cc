@@ -0,0 +1,128 @@
+// Erasing from a hash_map, or inserting into it without growing it,
+// while a rehash is in progress must not move the elements that an
+// iterator has still to visit.
+
+#include <hash_map.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef hash_map<int, int, hash<int>, equal_to<int>, alloc,
+                 hash_incremental_policy<hash_prime_policy, 4> > table;
+typedef hash_map<int, int, hash<int>, equal_to<int>, alloc,
+                 hash_incremental_policy<hash_pow2_policy, 4> > pow2_table;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+// Fills m so that the last insertion starts a rehash that is still far
+// from done.
+static void fill(table& m, int n)
+{
+  for (int i = 0; i < n; ++i)
+    m[i] = i;
+}
+
+int main()
+{
+  const int n = 900;
+
+  {
+    table m;
+    fill(m, n);
+    char* seen = (char*) calloc(n, 1);
+    int visited = 0;
+    for (table::iterator it = m.begin(); it != m.end(); ) {
+      int k = it->first;
+      ++it;
+      if (seen[k]++)
+        check(false, "erase by key: element visited twice");
+      ++visited;
+      m.erase(k);
+    }
+    check(visited == n, "erase by key: every element visited");
+    check(m.size() == 0 && m.begin() == m.end(), "erase by key: table empty");
+    free(seen);
+  }
+
+  {
+    table m;
+    fill(m, n);
+    int visited = 0;
+    for (table::iterator it = m.begin(); it != m.end(); ++visited)
+      m.erase(it++);
+    check(visited == n, "erase by iterator: every element visited");
+    check(m.size() == 0, "erase by iterator: table empty");
+  }
+
+  {
+    // Erase every other element during iteration, then check that the
+    // rest can still be found and that insertion finishes the rehash.
+    table m;
+    fill(m, n);
+    for (table::iterator it = m.begin(); it != m.end(); ) {
+      int k = it->first;
+      ++it;
+      if (k % 2)
+        m.erase(k);
+    }
+    check(m.size() == n / 2, "erase odd keys: size");
+    for (int i = 0; i < n; ++i)
+      check(m.count(i) == (i % 2 ? 0 : 1), "erase odd keys: count");
+    for (int i = n; i < 2 * n; ++i)
+      m[i] = i;
+    check(m.size() == n / 2 + n, "insert after erase: size");
+  }
+
+  {
+    // 8193 elements grow a power-of-two table to 16384 buckets and leave
+    // nearly all of the 8192 old ones to move.  Walk the table, inserting
+    // a new key every second step; none of these insertions grows it, so
+    // every element present at the start is visited exactly once.
+    const int m_n = 8193;
+    pow2_table m;
+    for (int i = 0; i < m_n; ++i)
+      m[i] = i;
+    const size_t buckets = m.bucket_count();
+    char* seen = (char*) calloc(m_n, 1);
+    int step = 0;
+    int next_key = m_n;
+    for (pow2_table::iterator it = m.begin(); it != m.end(); ++it, ++step) {
+      if (it->first < m_n && seen[it->first]++)
+        check(false, "insert while iterating: element visited twice");
+      if (step % 2)
+        m[next_key++] = 0;
+    }
+    check(m.bucket_count() == buckets, "insert while iterating: no growth");
+    int missed = 0;
+    for (int i = 0; i < m_n; ++i)
+      missed += !seen[i];
+    check(missed == 0, "insert while iterating: every element visited");
+    check(int(m.size()) == next_key, "insert while iterating: size");
+    for (int i = 0; i < next_key; ++i)
+      check(m.count(i) == 1, "insert while iterating: count");
+    free(seen);
+
+    // Growing it again finishes the first rehash; the elements must all
+    // still be there.
+    for (int i = next_key; i < 4 * m_n; ++i)
+      m[i] = i;
+    check(m.bucket_count() > buckets, "grow again: bucket count");
+    int found = 0;
+    for (pow2_table::iterator it = m.begin(); it != m.end(); ++it)
+      ++found;
+    check(found == 4 * m_n && int(m.size()) == found, "grow again: size");
+    for (int i = 0; i < 4 * m_n; ++i)
+      check(m.count(i) == 1, "grow again: count");
+  }
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
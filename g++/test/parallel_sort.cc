@@ -0,0 +1,148 @@
+// sort(parallel_policy(n), ...) against sort for many sizes, shapes of
+// input and thread counts, with a comparator on records, and with a
+// comparator that throws.  The policy never uses more threads than there
+// are processors, so the threads only run on a machine with several;
+// build it with -fsanitize=thread as well.
+
+#include <vector.h>
+#include <algo.h>
+#include <stdio.h>
+#include "bench.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, long n)
+{
+  if (!ok) {
+    printf("FAIL: %s (%ld)\n", what, n);
+    ++failures;
+  }
+}
+
+struct record
+{
+  unsigned key;
+  unsigned id;
+};
+
+struct by_key
+{
+  bool operator()(const record& x, const record& y) const
+    { return x.key < y.key; }
+};
+
+// Throws once calls have counted *left down to zero, and from then on
+// whenever *again is set.
+struct throwing_less
+{
+  long* left;
+  bool again;
+  bool operator()(int x, int y) const
+  {
+    const long n = __sync_sub_and_fetch(left, 1);
+    if (n == 0 || (n < 0 && again))
+      throw 7;
+    return x < y;
+  }
+};
+
+static void shapes(bench_random& r)
+{
+  static const size_t sizes[] = { 0, 1, 17, 1000, 40000, 100000, 1000003 };
+  static const size_t threads[] = { 0, 2, 3, 8 };
+  long where = 0;
+  for (int s = 0; s < 7; ++s)
+    for (int shape = 0; shape < 6; ++shape)
+      for (int t = 0; t < 4; ++t, ++where) {
+        const size_t n = sizes[s];
+        vector<int> v(n);
+        for (size_t i = 0; i < n; ++i)
+          switch (shape) {
+          case 0: v[i] = int(r.next() >> 33); break;      // random
+          case 1: v[i] = int(r.below(4)); break;          // few values
+          case 2: v[i] = int(i); break;                   // sorted
+          case 3: v[i] = int(n - i); break;               // reversed
+          case 4: v[i] = int(i < n / 2 ? i : n - i); break; // pipe organ
+          default: v[i] = 5; break;                       // constant
+          }
+        vector<int> w(v);
+        sort(w.begin(), w.end());
+        sort(parallel_policy(threads[t]), v.begin(), v.end());
+        check(v == w, "same as sort", where);
+      }
+}
+
+static void records(bench_random& r)
+{
+  vector<record> v(500000);
+  for (size_t i = 0; i < v.size(); ++i) {
+    v[i].key = r.below(1000);
+    v[i].id = i;
+  }
+  sort(parallel_policy(8), v.begin(), v.end(), by_key());
+  bool ok = true;
+  for (size_t i = 1; i < v.size(); ++i)
+    ok = ok && v[i - 1].key <= v[i].key;
+  check(ok, "records sorted by key", 0);
+
+  int* a = new int[300000];
+  for (int i = 0; i < 300000; ++i)
+    a[i] = int(r.below(1000000));
+  sort(parallel_policy(), a, a + 300000);
+  ok = true;
+  for (int i = 1; i < 300000; ++i)
+    ok = ok && a[i - 1] <= a[i];
+  check(ok, "array sorted", 0);
+  delete[] a;
+}
+
+#ifdef __STL_USE_EXCEPTIONS
+// A comparator that throws leaves the range a permutation of what it
+// was.  An exception thrown on every later call too reaches the caller.
+// One thrown only once reaches the caller when it can be carried
+// between threads (__STL_EXCEPTION_PTR); otherwise the range is sorted
+// again on the calling thread, so either way the caller sees the
+// exception or a sorted range.
+static void exceptions(bench_random& r)
+{
+  for (int again = 1; again >= 0; --again)
+    for (long when = 1000; when <= 9000000; when *= 30) {
+      vector<int> v(400000);
+      for (size_t i = 0; i < v.size(); ++i)
+        v[i] = int(r.next() >> 33);
+      vector<int> w(v);
+      sort(w.begin(), w.end());
+
+      long left = when;
+      throwing_less less = { &left, again != 0 };
+      bool thrown = false;
+      try {
+        sort(parallel_policy(8), v.begin(), v.end(), less);
+      }
+      catch (int) {
+        thrown = true;
+      }
+      const bool sorted = v == w;
+      if (again)
+        check(thrown, "exception reaches the caller", when);
+      else
+        check(thrown || sorted, "exception or a sorted range", when);
+      sort(v.begin(), v.end());
+      check(v == w, "still a permutation", when);
+    }
+}
+#endif
+
+int main()
+{
+  bench_random r(3);
+  shapes(r);
+  records(r);
+#ifdef __STL_USE_EXCEPTIONS
+  exceptions(r);
+#endif
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
@@ -0,0 +1,57 @@
+// How sort(parallel_policy(n), ...) scales with threads, next to sort,
+// on random unsigned ints.  Each time is the best of three runs on a
+// fresh copy of the same input.  The policy never uses more threads
+// than there are processors.
+//
+// Usage: parallel_sort_bench [max_threads [elements]]
+// max_threads defaults to the number of processors.
+
+#include <vector.h>
+#include <algo.h>
+#include <stdio.h>
+#include "bench.h"
+
+static vector<unsigned>* input;
+
+// The best time of three sorts of the input on n threads, or with sort
+// when n is 0.
+static double best_of_three(long n)
+{
+  double best = 0;
+  for (int run = 0; run < 3; ++run) {
+    vector<unsigned> v(*input);
+    const double t = bench_seconds();
+    if (n == 0)
+      sort(v.begin(), v.end());
+    else
+      sort(parallel_policy(n), v.begin(), v.end());
+    const double s = bench_seconds() - t;
+    if (run == 0 || s < best)
+      best = s;
+  }
+  return best;
+}
+
+int main(int argc, char** argv)
+{
+  const long max_threads = bench_arg(argc, argv, 1, bench_processors());
+  const long n = bench_arg(argc, argv, 2, 10000000);
+
+  vector<unsigned> v(n);
+  bench_random r(9);
+  for (long i = 0; i < n; ++i)
+    v[i] = unsigned(r.next());
+  input = &v;
+
+  const double serial = best_of_three(0);
+  printf("%ld elements, %ld processors\n", n, bench_processors());
+  printf("sort       %8.1f ms\n", serial * 1e3);
+  // Powers of two, and max_threads last.
+  for (long t = 1; ; t = t * 2 < max_threads ? t * 2 : max_threads) {
+    const double s = best_of_three(t);
+    printf("%2ld threads %8.1f ms  x%5.2f\n", t, s * 1e3, serial / s);
+    if (t == max_threads)
+      break;
+  }
+  return 0;
+}
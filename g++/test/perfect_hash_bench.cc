@@ -0,0 +1,91 @@
+// Memory and lookup time of perfect_hash_map against the hash_map it is
+// frozen from.  Memory is what each table asks its allocator for, so
+// malloc's own overhead per block, which the chained table pays once
+// per element, comes on top of the hash_map figure.
+//
+// Usage: perfect_hash_bench [elements [lookup_rounds]]
+
+#include <hash_map.h>
+#include <perfect_hash_map>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+
+// An SGI-style allocator that keeps a count of the bytes outstanding.
+struct counting_alloc
+{
+  static size_t bytes;
+  static void* allocate(size_t n)
+  {
+    bytes += n;
+    return malloc(n);
+  }
+  static void deallocate(void* p, size_t n)
+  {
+    bytes -= n;
+    free(p);
+  }
+  static void* reallocate(void* p, size_t old_n, size_t new_n)
+  {
+    bytes += new_n - old_n;
+    return realloc(p, new_n);
+  }
+};
+
+size_t counting_alloc::bytes = 0;
+
+typedef hash_map<long, long, hash<long>, equal_to<long>, counting_alloc>
+        chained;
+typedef perfect_hash_map<long, long, hash<long>, equal_to<long>,
+                         counting_alloc>
+        perfect;
+
+int main(int argc, char** argv)
+{
+  const long n = bench_arg(argc, argv, 1, 1000000);
+  const long rounds = bench_arg(argc, argv, 2, 5);
+
+  long* keys = new long[n];
+  bench_random r(1);
+  for (long i = 0; i < n; ++i)
+    keys[i] = long(r.next() >> 2) | 1;
+
+  size_t before = counting_alloc::bytes;
+  chained h;
+  for (long i = 0; i < n; ++i)
+    h[keys[i]] = i;
+  const size_t chained_bytes = counting_alloc::bytes - before;
+  const long distinct = h.size();
+
+  before = counting_alloc::bytes;
+  double t = bench_seconds();
+  perfect p = freeze(h);
+  const double build = bench_seconds() - t;
+  const size_t perfect_bytes = counting_alloc::bytes - before;
+
+  bench_shuffle(keys, n, r);
+  long sum = 0;
+  double hit[2], miss[2];
+  for (int which = 0; which < 2; ++which) {
+    t = bench_seconds();
+    for (long k = 0; k < rounds; ++k)
+      for (long i = 0; i < n; ++i)
+        sum += which ? p.find(keys[i])->second : h.find(keys[i])->second;
+    hit[which] = (bench_seconds() - t) * 1e9 / (double(n) * rounds);
+    // Every key is odd, so an even one is a miss.
+    t = bench_seconds();
+    for (long k = 0; k < rounds; ++k)
+      for (long i = 0; i < n; ++i)
+        sum += which ? p.count(keys[i] - 1) : h.count(keys[i] - 1);
+    miss[which] = (bench_seconds() - t) * 1e9 / (double(n) * rounds);
+  }
+
+  printf("%ld elements, freeze %.3f s, %lu in overflow (%ld)\n", distinct,
+         build, (unsigned long) p.overflow_count(), sum);
+  printf("                 bytes/element  hit ns  miss ns\n");
+  printf("hash_map         %13.1f  %6.1f  %7.1f\n",
+         double(chained_bytes) / distinct, hit[0], miss[0]);
+  printf("perfect_hash_map %13.1f  %6.1f  %7.1f\n",
+         double(perfect_bytes) / distinct, hit[1], miss[1]);
+  return 0;
+}
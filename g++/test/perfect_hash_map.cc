@@ -0,0 +1,124 @@
+// perfect_hash_map and perfect_hash_set built by freeze () and from
+// ranges, for many sizes: every key must be found, no other key may be,
+// and keys whose hash codes collide must land in the overflow area.
+
+#include <hash_map.h>
+#include <hash_set.h>
+#include <perfect_hash_map>
+#include <perfect_hash_set>
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, long n)
+{
+  if (!ok) {
+    printf("FAIL: %s (%ld)\n", what, n);
+    ++failures;
+  }
+}
+
+typedef perfect_hash_map<int, int> frozen;
+
+// Keys 13 * i + 5, so that the misses in between are keys too.
+static void check_size(int n)
+{
+  hash_map<int, int> h;
+  for (int i = 0; i < n; ++i)
+    h[i * 13 + 5] = i;
+  frozen p = freeze(h);
+  check(p.size() == size_t(n), "freeze: size", n);
+  check(p.overflow_count() == 0, "freeze: nothing in overflow", n);
+
+  // Past a few hundred keys some are always placed beyond the last
+  // element and found through the remap array.
+  bool right = true;
+  for (int k = -20; k < n * 13 + 20; ++k) {
+    frozen::const_iterator it = p.find(k);
+    if (k >= 5 && (k - 5) % 13 == 0 && (k - 5) / 13 < n)
+      right = right && it != p.end() && it->first == k
+              && it->second == (k - 5) / 13 && p.count(k) == 1;
+    else
+      right = right && it == p.end() && p.count(k) == 0;
+  }
+  check(right, "freeze: find and count", n);
+
+  frozen q(p);
+  frozen r;
+  r = q;
+  int seen = 0;
+  for (frozen::const_iterator it = r.begin(); it != r.end(); ++it, ++seen)
+    right = right && h[it->first] == it->second;
+  check(right && seen == n, "copy: every element, once", n);
+
+  pair<frozen::const_iterator, frozen::const_iterator> range =
+    r.equal_range(5);
+  check(n == 0 ? range.first == range.second
+               : range.second - range.first == 1 && range.first->first == 5,
+        "equal_range", n);
+}
+
+// Every key hashes to one of ten codes.
+struct ten_codes
+{
+  size_t operator()(int k) const { return k % 10; }
+};
+
+struct str_equal
+{
+  bool operator()(const char* a, const char* b) const
+    { return strcmp(a, b) == 0; }
+};
+
+int main()
+{
+  for (int n = 0; n < 3000; n += n < 64 ? 1 : 97)
+    check_size(n);
+  check_size(100000);
+
+  {
+    // Keys with equal hash codes cannot be told apart by the perfect
+    // hash: one of each code is placed and the rest overflow.
+    hash_set<int, ten_codes> s;
+    for (int i = 0; i < 200; ++i)
+      s.insert(i);
+    perfect_hash_set<int, ten_codes> p = freeze(s);
+    check(p.size() == 200, "overflow: size", 0);
+    check(p.overflow_count() == 190, "overflow: count", 0);
+    bool right = true;
+    for (int k = -5; k < 300; ++k)
+      right = right && p.count(k) == (k >= 0 && k < 200);
+    check(right, "overflow: count of every key", 0);
+  }
+
+  {
+    // From a range, with string keys.
+    static const char* words[] = {
+      "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+      "hotel", "india", "juliet", "kilo", "lima", "mike", "november"
+    };
+    const int n = sizeof words / sizeof *words;
+    perfect_hash_set<const char*, hash<const char*>, str_equal>
+      p(words, words + n);
+    bool right = p.size() == size_t(n);
+    char buf[16];
+    for (int i = 0; i < n; ++i) {
+      strcpy(buf, words[i]);
+      right = right && p.count(buf) == 1;
+      buf[0] = 'X';
+      right = right && p.count(buf) == 0;
+    }
+    check(right, "string keys from a range", n);
+  }
+
+  {
+    frozen empty;
+    check(empty.size() == 0 && empty.find(1) == empty.end()
+          && empty.begin() == empty.end(), "empty table", 0);
+  }
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
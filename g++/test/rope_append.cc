@@ -0,0 +1,167 @@
+// Appending to a rope grows the leaf at its right edge in place when
+// nothing else shares it.  Check, against a plain array of characters,
+// that append, push_back, substr, copy and c_str see the right text,
+// and that appending to one rope never changes another that shares its
+// tree.
+
+#include <rope.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, long n)
+{
+  if (!ok) {
+    printf("FAIL: %s (%ld)\n", what, n);
+    ++failures;
+  }
+}
+
+template <class charT>
+static bool same(const rope<charT>& r, const vector<charT>& model)
+{
+  if (r.size() != model.size())
+    return false;
+  vector<charT> buf(model.size() + 1);
+  r.copy(&buf[0]);
+  return model.empty() || memcmp(&buf[0], &model[0],
+                                 model.size() * sizeof(charT)) == 0;
+}
+
+template <class charT>
+static bool same_c_str(const rope<charT>& r, const vector<charT>& model)
+{
+  const charT* s = r.c_str();
+  return (model.empty()
+          || memcmp(s, &model[0], model.size() * sizeof(charT)) == 0)
+         && s[model.size()] == charT();
+}
+
+// One rope under a random mix of operations, checked as it goes.
+template <class charT>
+static void mix(long round, bench_random& r)
+{
+  rope<charT> text;
+  vector<charT> model;
+  vector<rope<charT> > kept;
+  vector<vector<charT> > kept_model;
+  charT buf[3000];
+
+  const long steps = 2000 + r.below(8000);
+  for (long i = 0; i < steps; ++i) {
+    const unsigned long op = r.below(100);
+    if (op < 55) {
+      // Mostly short pieces, now and then one longer than a leaf.
+      size_t len = r.below(40);
+      if (r.below(200) == 0)
+        len = 1000 + r.below(1900);
+      for (size_t j = 0; j < len; ++j)
+        buf[j] = charT('a' + r.below(26));
+      text.append(buf, len);
+      model.insert(model.end(), buf, buf + len);
+    }
+    else if (op < 80) {
+      const charT c = charT('A' + r.below(26));
+      if (op < 70)
+        text.push_back(c);
+      else
+        text.append(c);
+      model.push_back(c);
+    }
+    else if (op < 83) {
+      // A copy shares the tree.  Later appends to text must leave it as
+      // it is now.
+      kept.push_back(text);
+      kept_model.push_back(model);
+    }
+    else if (op < 86) {
+      rope<charT> copy(text);
+      copy.append(buf, 3);
+      copy.push_back(charT('!'));
+      check(copy.size() == model.size() + 4, "append to a copy: size", round);
+    }
+    else if (op < 89 && model.size() > 10) {
+      // A substring shares the leaves it covers, which may include the
+      // right edge.  Appending it to text, and to itself, must not
+      // change either's other copies.
+      const size_t start = r.below(model.size());
+      size_t len = r.below(model.size() - start);
+      if (len > 3000)
+        len = r.below(3000);
+      rope<charT> sub = text.substr(start, len);
+      vector<charT> sub_model(model.begin() + start,
+                              model.begin() + start + len);
+      check(same(sub, sub_model), "substr", round);
+      text.append(sub);
+      model.insert(model.end(), sub_model.begin(), sub_model.end());
+      sub.push_back(charT('#'));
+      sub_model.push_back(charT('#'));
+      check(same(sub, sub_model), "append to a substr", round);
+    }
+    else if (op < 92) {
+      // c_str caches a flat copy, which an append must drop.
+      check(same_c_str(text, model), "c_str", round);
+    }
+    else if (op < 93 && !model.empty()) {
+      const size_t pos = r.below(model.size());
+      text.mutable_reference_at(pos) = charT('Z');
+      model[pos] = charT('Z');
+    }
+    else if (op < 94 && !model.empty())
+      text.balance();
+    else if (op < 95 && !model.empty()) {
+      text.pop_back();
+      model.pop_back();
+    }
+    else if (op < 97 && !model.empty()) {
+      const size_t pos = r.below(model.size());
+      const size_t n = r.below(100);
+      const size_t got = text.copy(pos, n, buf);
+      const size_t want = n < model.size() - pos ? n : model.size() - pos;
+      check(got == want
+            && memcmp(buf, &model[pos], want * sizeof(charT)) == 0,
+            "copy (pos, n, buffer)", round);
+    }
+    if (text.size() != model.size()) {
+      check(false, "size", round);
+      return;
+    }
+  }
+
+  check(same(text, model), "final text", round);
+  check(same_c_str(text, model), "final c_str", round);
+  typename rope<charT>::const_iterator it = text.begin();
+  bool right = true;
+  for (size_t i = 0; i < model.size(); ++i, ++it)
+    right = right && *it == model[i];
+  check(right, "iteration", round);
+  for (size_t i = 0; i < kept.size(); ++i)
+    check(same(kept[i], kept_model[i]), "kept copies unchanged", round);
+}
+
+int main()
+{
+  bench_random r(1);
+  for (long round = 0; round < 20; ++round)
+    mix<char>(round, r);
+  for (long round = 0; round < 5; ++round)
+    mix<wchar_t>(round, r);
+
+  {
+    // Nothing but small appends, most of which grow the last leaf.
+    crope text;
+    vector<char> model;
+    const char* digits = "0123456789abcdefghij";
+    for (long i = 0; i < 1000000; ++i) {
+      text.append(digits, 1 + i % 20);
+      model.insert(model.end(), digits, digits + 1 + i % 20);
+    }
+    check(same(text, model), "many small appends", 0);
+  }
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
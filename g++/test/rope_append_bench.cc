@@ -0,0 +1,90 @@
+// The cost of building a rope by appending to it: short pieces with
+// append, single characters with push_back, and pieces appended while
+// a copy of the rope is alive, which must leave the copy's leaves alone.
+// Memory is what the rope asks of its allocator per character.
+//
+// Usage: rope_append_bench [appends]
+
+#include <rope.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+
+struct counting_alloc
+{
+  static size_t bytes;
+  static void* allocate(size_t n)
+  {
+    bytes += n;
+    return malloc(n);
+  }
+  static void deallocate(void* p, size_t n)
+  {
+    bytes -= n;
+    free(p);
+  }
+  static void* reallocate(void* p, size_t old_n, size_t new_n)
+  {
+    bytes += new_n - old_n;
+    return realloc(p, new_n);
+  }
+};
+
+size_t counting_alloc::bytes = 0;
+
+typedef rope<char, counting_alloc> text;
+
+static const char* line =
+  "2026-10-18 12:00:00 INFO request served in 12ms path=/a/b/c";
+
+static void report(const char* name, long n, double elapsed, const text& t,
+                   size_t bytes)
+{
+  long sum = 0;
+  const double start = bench_seconds();
+  text::const_iterator it = t.begin();
+  for (size_t i = 0; i < t.size(); ++i, ++it)
+    sum += *it;
+  const double scan = bench_seconds() - start;
+  printf("%-22s %7.1f ns/op  %5.2f bytes/char  scan %5.2f ns/char (%ld)\n",
+         name, elapsed * 1e9 / n, double(bytes) / t.size(),
+         scan * 1e9 / t.size(), sum % 7);
+}
+
+int main(int argc, char** argv)
+{
+  const long n = bench_arg(argc, argv, 1, 1000000);
+  printf("%ld appends\n", n);
+
+  {
+    text t;
+    const double start = bench_seconds();
+    for (long i = 0; i < n; ++i)
+      t.append(line, 8 + i % 40);
+    report("append 8-47 chars", n, bench_seconds() - start, t,
+           counting_alloc::bytes);
+  }
+  {
+    text t;
+    const double start = bench_seconds();
+    for (long i = 0; i < n; ++i)
+      t.push_back('a' + i % 26);
+    report("push_back", n, bench_seconds() - start, t,
+           counting_alloc::bytes);
+  }
+  {
+    // Every 64 appends, take a copy and keep it until the next one, so
+    // that the right edge is shared most of the time.
+    text t, copy;
+    const double start = bench_seconds();
+    for (long i = 0; i < n; ++i) {
+      if (i % 64 == 0)
+        copy = t;
+      t.append(line, 8 + i % 40);
+    }
+    const double elapsed = bench_seconds() - start;
+    copy = text();
+    report("append, shared edge", n, elapsed, t, counting_alloc::bytes);
+  }
+  return 0;
+}
@@ -0,0 +1,99 @@
+// Building strings by appending: allocations, moves to new storage and
+// the characters copied by those moves, for one string built from 10^6
+// pieces with and without reserve, for erasing and refilling a string,
+// and for many short-lived strings.
+//
+// Usage: string_builder_bench [appends]
+
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+
+// An SGI-style allocator that counts the blocks asked of it.
+struct counting_alloc
+{
+  static long calls;
+  static void* allocate(size_t n)
+  {
+    ++calls;
+    return malloc(n);
+  }
+  static void deallocate(void* p, size_t)
+  {
+    free(p);
+  }
+  static void* reallocate(void* p, size_t, size_t new_n)
+  {
+    ++calls;
+    return realloc(p, new_n);
+  }
+};
+
+long counting_alloc::calls = 0;
+
+typedef basic_string<char, string_char_traits<char>, counting_alloc> str;
+
+static const char* pieces[] = {
+  "a", "key=", "value;", "0123456789", "GET /x ", "\n", "lorem ipsum dolor"
+};
+
+static void build(long n, size_t reserve, const char* what)
+{
+  const long calls = counting_alloc::calls;
+  const double t = bench_seconds();
+  long moves = 0;
+  double copied = 0;
+  str s;
+  s.reserve(reserve);
+  const char* last = s.data();
+  for (long i = 0; i < n; ++i) {
+    s.append(pieces[i % 7]);
+    if (s.data() != last) {
+      ++moves;
+      copied += s.length();
+      last = s.data();
+    }
+  }
+  printf("%-30s %7.1f ms %7ld allocations %4ld moves %6.2f MB copied"
+         " (%.2f MB built)\n", what, (bench_seconds() - t) * 1e3,
+         counting_alloc::calls - calls, moves, copied / 1e6,
+         s.length() / 1e6);
+}
+
+int main(int argc, char** argv)
+{
+  const long n = bench_arg(argc, argv, 1, 1000000);
+
+  build(n, 0, "appends");
+  build(n, n * 9, "appends after reserve");
+
+  {
+    str s(4000, 'x');
+    const long calls = counting_alloc::calls;
+    const double t = bench_seconds();
+    for (int i = 0; i < 100000; ++i) {
+      s.erase(100);
+      while (s.length() < 3000)
+        s.append("0123456789012345678901234567890123456789");
+    }
+    printf("%-30s %7.1f ms %7ld allocations\n", "erase to 100, refill to 3000",
+           (bench_seconds() - t) * 1e3, counting_alloc::calls - calls);
+  }
+
+  {
+    const long calls = counting_alloc::calls;
+    const double t = bench_seconds();
+    size_t total = 0;
+    for (int i = 0; i < 200000; ++i) {
+      str s;
+      for (int k = 0; k < 25; ++k)
+        s.append(pieces[k % 7]);
+      total += s.length();
+    }
+    printf("%-30s %7.1f ms %7ld allocations (%lu characters)\n",
+           "2*10^5 strings of 25 appends", (bench_seconds() - t) * 1e3,
+           counting_alloc::calls - calls, (unsigned long) total);
+  }
+  return 0;
+}
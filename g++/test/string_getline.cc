@@ -0,0 +1,164 @@
+// getline and operator>> for basic_string<char>, which take whole runs
+// of the get area at once, against the same operators on a string whose
+// traits only copy those of char and so go through the loops that take
+// one character at a time.  Both read the same file with the same mix of
+// calls, widths, delimiters and putbacks; lines are long enough to run
+// across several refills of the buffer, and putting back a character
+// other than the one just read makes libio switch to its backup area.
+
+#include <string>
+#include <fstream.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "bench.h"
+
+struct slow_traits : public string_char_traits<char> { };
+
+typedef basic_string<char> fast_string;
+typedef basic_string<char, slow_traits> slow_string;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, long n)
+{
+  if (!ok) {
+    printf("FAIL: %s (%ld)\n", what, n);
+    ++failures;
+  }
+}
+
+static bool same(const fast_string& f, const slow_string& s)
+{
+  return f.length() == s.length()
+         && fast_string::traits_type::compare(f.data(), s.data(),
+                                              f.length()) == 0;
+}
+
+// Words, runs of blanks and lines of every length, some of them much
+// longer than the stream's buffer.
+static fast_string random_text(bench_random& r)
+{
+  static const char blanks[] = " \t\n\n;";
+  fast_string t;
+  const long items = 2000 + r.below(2000);
+  for (long i = 0; i < items; ++i) {
+    const unsigned long k = r.below(100);
+    size_t n = k < 90 ? r.below(12) : k < 98 ? r.below(300) : r.below(40000);
+    for (; n > 0; --n)
+      t += char('a' + r.below(26));
+    for (n = r.below(4); n > 0; --n)
+      t += blanks[r.below(sizeof(blanks) - 1)];
+  }
+  if (r.below(2))
+    t += '\n';
+  return t;
+}
+
+static void write_file(const char* name, const fast_string& t)
+{
+  FILE* f = fopen(name, "w");
+  if (f == 0 || fwrite(t.data(), 1, t.length(), f) != t.length()
+      || fclose(f) != 0)
+    abort();
+}
+
+static void differential(const char* name, long round, bench_random& r)
+{
+  ifstream fin(name), sin(name);
+  fast_string f;
+  slow_string s;
+  for (long step = 0; fin.good() && sin.good() && step < 100000; ++step) {
+    const long where = round * 1000000 + step;
+    switch (r.below(8)) {
+    case 0: case 1: case 2: {
+      const int w = r.below(3) == 0 ? 1 + r.below(20) : 0;
+      fin.width(w);
+      sin.width(w);
+      fin >> f;
+      sin >> s;
+      break;
+    }
+    case 3: {
+      // Put back one to three characters, each different from the one
+      // before it in the buffer, so that the backup area is used.
+      for (unsigned long n = 1 + r.below(3); n > 0; --n) {
+        const char c = "x \n;"[r.below(4)];
+        fin.putback(c);
+        sin.putback(c);
+      }
+      break;
+    }
+    case 4:
+      getline(fin, f, ';');
+      getline(sin, s, ';');
+      break;
+    default:
+      getline(fin, f);
+      getline(sin, s);
+      break;
+    }
+    check(fin.rdstate() == sin.rdstate(), "stream state", where);
+    check(same(f, s), "string read", where);
+  }
+}
+
+// Reading every line with getline gives back the text split at each
+// newline.
+static void lines(const char* name, const fast_string& t)
+{
+  ifstream in(name);
+  fast_string line;
+  size_t pos = 0;
+  long n = 0;
+  while (getline(in, line)) {
+    size_t e = t.find('\n', pos);
+    if (e == fast_string::npos)
+      e = t.length();
+    check(line == t.substr(pos, e - pos), "line", n);
+    pos = e + 1;
+    ++n;
+  }
+  check(pos >= t.length(), "every line read", n);
+}
+
+int main()
+{
+  char name[] = "/tmp/string_getlineXXXXXX";
+  const int fd = mkstemp(name);
+  if (fd < 0)
+    abort();
+  close(fd);
+
+  bench_random r(1);
+  for (long round = 0; round < 20; ++round) {
+    const fast_string t = random_text(r);
+    write_file(name, t);
+    differential(name, round, r);
+    lines(name, t);
+  }
+
+  // A width counts the terminating null, so width 4 reads three
+  // characters; a character put back ahead of the first word joins it.
+  write_file(name, "alphabet soup\n");
+  {
+    ifstream in(name);
+    fast_string s;
+    in.putback('x');
+    in.width(4);
+    in >> s;
+    check(s == "xal", "width and putback", 0);
+    in >> s;
+    check(s == "phabet", "rest of the word", 0);
+    getline(in, s);
+    check(s == " soup" && in.good(), "rest of the line", 0);
+    getline(in, s);
+    check(s.empty() && in.fail() && in.eof(), "getline at the end", 0);
+  }
+
+  unlink(name);
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
@@ -0,0 +1,81 @@
+// getline and operator>> reading a large file of log lines into a
+// basic_string<char>, against the same operators on a string whose
+// traits only copy those of char and so read one character at a time.
+// The file is written first and removed at the end.
+//
+// Usage: string_getline_bench [megabytes [file]]
+
+#include <string>
+#include <fstream.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "bench.h"
+
+struct slow_traits : public string_char_traits<char> { };
+
+typedef basic_string<char> fast_string;
+typedef basic_string<char, slow_traits> slow_string;
+
+static void write_log(const char* name, long megabytes)
+{
+  static const char* verbs[] = { "GET", "POST", "PUT", "DELETE" };
+  FILE* f = fopen(name, "w");
+  if (f == 0)
+    abort();
+  bench_random r(1);
+  const long bytes = megabytes << 20;
+  for (long n = 0; n < bytes; )
+    n += fprintf(f, "10.%lu.%lu.%lu - - [18/Oct/2026:10:%02lu:%02lu +0000]"
+                 " \"%s /api/v1/item/%lu HTTP/1.1\" %lu %lu\n",
+                 r.below(256), r.below(256), r.below(256), r.below(60),
+                 r.below(60), verbs[r.below(4)], r.below(5000),
+                 200 + r.below(4) * 100, r.below(100000));
+  if (fclose(f) != 0)
+    abort();
+}
+
+template <class str>
+static void read_lines(const char* name, const char* what)
+{
+  ifstream in(name);
+  str line;
+  long lines = 0, bytes = 0;
+  const double t = bench_seconds();
+  while (getline(in, line)) {
+    ++lines;
+    bytes += line.length() + 1;
+  }
+  const double s = bench_seconds() - t;
+  printf("%-22s %10ld lines %8.0f MB/s\n", what, lines, (bytes >> 20) / s);
+}
+
+template <class str>
+static void read_words(const char* name, const char* what)
+{
+  ifstream in(name);
+  str word;
+  long words = 0, bytes = 0;
+  const double t = bench_seconds();
+  while (in >> word) {
+    ++words;
+    bytes += word.length();
+  }
+  const double s = bench_seconds() - t;
+  printf("%-22s %10ld words %8.0f MB/s\n", what, words, (bytes >> 20) / s);
+}
+
+int main(int argc, char** argv)
+{
+  const long megabytes = bench_arg(argc, argv, 1, 2048);
+  const char* name = argc > 2 ? argv[2] : "/tmp/string_getline_bench.log";
+
+  write_log(name, megabytes);
+  printf("%ld MB\n", megabytes);
+  read_lines<slow_string>(name, "getline, by character");
+  read_lines<fast_string>(name, "getline");
+  read_words<slow_string>(name, ">>, by character");
+  read_words<fast_string>(name, ">>");
+  unlink(name);
+  return 0;
+}
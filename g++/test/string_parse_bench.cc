@@ -0,0 +1,99 @@
+// Allocations and time for splitting a synthetic access log into
+// strings, most of them short enough to live inside the string object.
+// Each line and each field becomes a string; the host field is counted
+// in a hash_map, and the fields are copied once at the end.
+//
+// Usage: string_parse_bench [lines]
+
+#include <string>
+#include <hash_map.h>
+#include <vector.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+
+// An SGI-style allocator that counts the blocks asked of it.
+struct counting_alloc
+{
+  static long calls;
+  static void* allocate(size_t n)
+  {
+    ++calls;
+    return malloc(n);
+  }
+  static void deallocate(void* p, size_t)
+  {
+    free(p);
+  }
+  static void* reallocate(void* p, size_t, size_t new_n)
+  {
+    ++calls;
+    return realloc(p, new_n);
+  }
+};
+
+long counting_alloc::calls = 0;
+
+typedef basic_string<char, string_char_traits<char>, counting_alloc> str;
+
+int main(int argc, char** argv)
+{
+  const long lines = bench_arg(argc, argv, 1, 1000000);
+
+  static const char* verbs[] = { "GET", "POST", "PUT", "DELETE" };
+  char* text = (char*) malloc(lines * 80);
+  size_t n = 0;
+  bench_random r(1);
+  for (long i = 0; i < lines; ++i)
+    n += sprintf(text + n, "%s /api/v1/item%lu host%lu.example.com %lu %lu\n",
+                 verbs[r.below(4)], r.below(5000), r.below(300),
+                 200 + r.below(4) * 100, r.below(100000));
+
+  vector<str> fields;
+  fields.reserve(lines * 5);
+  hash_map<str, long, hash<str> > hosts;
+
+  long calls = counting_alloc::calls;
+  double t = bench_seconds();
+  const char* p = text;
+  const char* end = text + n;
+  while (p < end) {
+    const char* nl = (const char*) memchr(p, '\n', end - p);
+    str line(p, nl - p);
+    size_t b = 0;
+    for (int f = 0; b < line.length(); ++f) {
+      size_t k = line.find(' ', b);
+      if (k == str::npos)
+        k = line.length();
+      str field = line.substr(b, k - b);
+      if (f == 2)
+        ++hosts[field];
+      fields.push_back(field);
+      b = k + 1;
+    }
+    p = nl + 1;
+  }
+  const double parse = bench_seconds() - t;
+  const long parse_calls = counting_alloc::calls - calls;
+
+  calls = counting_alloc::calls;
+  t = bench_seconds();
+  vector<str> copy(fields);
+  size_t total = 0;
+  for (size_t i = 0; i < copy.size(); ++i)
+    total += copy[i].length();
+  const double copying = bench_seconds() - t;
+  const long copy_calls = counting_alloc::calls - calls;
+
+  printf("sizeof(string) %lu, %lu fields of %.1f characters, %lu hosts\n",
+         (unsigned long) sizeof(str), (unsigned long) fields.size(),
+         double(total) / fields.size(), (unsigned long) hosts.size());
+  printf("parse: %8.1f ns/field, %.2f allocations/field\n",
+         parse * 1e9 / fields.size(), double(parse_calls) / fields.size());
+  printf("copy:  %8.1f ns/field, %.2f allocations/field\n",
+         copying * 1e9 / copy.size(), double(copy_calls) / copy.size());
+
+  free(text);
+  return 0;
+}
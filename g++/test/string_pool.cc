@@ -0,0 +1,132 @@
+// basic_string_pool: handles compare and hash like their strings, long
+// strings share their Rep with str(), handles work as hash_map keys, and
+// several threads interning the same names at once all get the same
+// handles.  Build it with -fsanitize=thread as well.
+
+#include <string_pool>
+#include <hash_map.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+
+typedef basic_string<char> str;
+typedef basic_string_view<char> view;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+static void handles()
+{
+  string_pool p(4);
+  check(p.shard_count() == 4, "shard count");
+
+  const interned_string e;
+  check(e.empty() && e.length() == 0 && *e.c_str() == 0 && e == p.intern("")
+        && e.hash() == hash<str>()(str()), "the empty handle");
+
+  const interned_string a = p.intern("hello");
+  const interned_string b = p.intern(str("hello"));
+  const interned_string c = p.intern(view("hello world", 5));
+  check(a == b && b == c && !a.empty() && a.length() == 5
+        && strcmp(a.c_str(), "hello") == 0, "one handle per string");
+  check(a.hash() == hash<str>()(str("hello")), "hash of a handle");
+  check(a.str() == "hello" && view(a) == "hello", "str and view");
+
+  // A long string's Rep is shared by str(), and changing the copy
+  // leaves the pooled string alone.
+  const str longer(100, 'q');
+  const interned_string l = p.intern(longer);
+  check(l == p.intern(view(longer)) && l != a && l.c_str()[100] == 0,
+        "long string");
+  str copy = l.str();
+  check(copy == longer && copy.data() == l.data(), "str shares the Rep");
+  copy += 'x';
+  check(copy.data() != l.data() && l.str() == longer, "copy on write");
+
+  interned_string f;
+  check(p.find("hello", f) && f == a, "find");
+  check(!p.find("nope", f), "find a missing string");
+  check(p.size() == 2, "size");
+
+  hash_map<interned_string, int> m;
+  m[a] = 1;
+  m[l] = 2;
+  m[e] = 3;
+  check(m[p.intern("hello")] == 1 && m[p.intern(longer)] == 2
+        && m[interned_string()] == 3 && m.size() == 3, "hash_map keys");
+
+  // Growing the shards keeps every handle.
+  char name[32];
+  for (int i = 0; i < 5000; ++i) {
+    sprintf(name, "k%d", i);
+    p.intern(name);
+  }
+  check(p.find("hello", f) && f == a && p.size() == 5002, "growth");
+  for (int i = 0; i < 5000; ++i) {
+    sprintf(name, "k%d", i);
+    check(p.find(name, f) && f.str() == name, "find after growth");
+  }
+
+  basic_string_pool<wchar_t> wp;
+  const basic_interned_string<wchar_t> w1 = wp.intern(L"wide");
+  const basic_interned_string<wchar_t> w2
+    = wp.intern(basic_string<wchar_t>(L"wide"));
+  check(w1 == w2 && w1.length() == 4 && w1.c_str()[4] == 0, "wide pool");
+}
+
+static const long threads = 8;
+static const int names = 2000;
+
+static string_pool* shared_pool;
+static interned_string seen[threads][names];
+static long thread_failures[threads];
+
+static void intern_thread(void*, long t)
+{
+  char name[64];
+  for (int round = 0; round < 20; ++round)
+    for (int i = 0; i < names; ++i) {
+      const int k = (i * 7 + t * 331) % names;
+      sprintf(name, "host-%d.example.internal.%d", k, k % 7);
+      const interned_string h = shared_pool->intern(name);
+      if (round == 0)
+        seen[t][k] = h;
+      else if (seen[t][k] != h || strcmp(h.c_str(), name) != 0)
+        ++thread_failures[t];
+    }
+}
+
+static void concurrent()
+{
+  string_pool p;
+  shared_pool = &p;
+  bench_run_threads(threads, intern_thread, 0);
+
+  long failed = 0;
+  for (long t = 0; t < threads; ++t)
+    failed += thread_failures[t];
+  check(failed == 0, "each thread keeps getting its handles");
+  bool same = true;
+  for (long t = 1; t < threads; ++t)
+    for (int i = 0; i < names; ++i)
+      same = same && seen[t][i] == seen[0][i];
+  check(same, "all threads get the same handles");
+  check(p.size() == names, "each name is pooled once");
+}
+
+int main()
+{
+  handles();
+  concurrent();
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
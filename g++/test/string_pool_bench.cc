@@ -0,0 +1,128 @@
+// Memory and lookup time of interned strings against plain strings, for
+// records that name a few thousand distinct hosts.  Memory is what the
+// strings and the pool ask their allocator for, plus the vector slots
+// that hold them.
+//
+// Usage: string_pool_bench [records [distinct]]
+
+#include <string_pool>
+#include <hash_map.h>
+#include <vector.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+
+// An SGI-style allocator that keeps a count of the bytes outstanding and
+// of the blocks asked of it.
+struct counting_alloc
+{
+  static size_t bytes;
+  static long calls;
+  static void* allocate(size_t n)
+  {
+    bytes += n;
+    ++calls;
+    return malloc(n);
+  }
+  static void deallocate(void* p, size_t n)
+  {
+    bytes -= n;
+    free(p);
+  }
+  static void* reallocate(void* p, size_t old_n, size_t new_n)
+  {
+    bytes += new_n - old_n;
+    ++calls;
+    return realloc(p, new_n);
+  }
+};
+
+size_t counting_alloc::bytes = 0;
+long counting_alloc::calls = 0;
+
+typedef basic_string<char, string_char_traits<char>, counting_alloc> str;
+typedef basic_string_pool<char, string_char_traits<char>, counting_alloc>
+        pool;
+typedef pool::handle handle;
+
+int main(int argc, char** argv)
+{
+  const long n = bench_arg(argc, argv, 1, 1000000);
+  const long distinct = bench_arg(argc, argv, 2, 10000);
+
+  char (*names)[64] = new char[distinct][64];
+  for (long i = 0; i < distinct; ++i)
+    sprintf(names[i], "node%05ld.rack%02ld.dc-east.example.com", i, i % 40);
+  long* pick = new long[n];
+  bench_random r(1);
+  for (long i = 0; i < n; ++i)
+    pick[i] = r.below(distinct);
+
+  {
+    const size_t bytes = counting_alloc::bytes;
+    const long calls = counting_alloc::calls;
+    const double t = bench_seconds();
+    vector<str> v;
+    v.reserve(n);
+    for (long i = 0; i < n; ++i)
+      v.push_back(str(names[pick[i]]));
+    printf("strings:  %6.1f MB, %8ld allocations, %6.1f ms\n",
+           (counting_alloc::bytes - bytes + n * sizeof(str)) / 1e6,
+           counting_alloc::calls - calls, (bench_seconds() - t) * 1e3);
+  }
+  {
+    const size_t bytes = counting_alloc::bytes;
+    const long calls = counting_alloc::calls;
+    const double t = bench_seconds();
+    pool p;
+    vector<handle> v;
+    v.reserve(n);
+    for (long i = 0; i < n; ++i)
+      v.push_back(p.intern(names[pick[i]]));
+    printf("interned: %6.1f MB, %8ld allocations, %6.1f ms"
+           " (%lu strings pooled)\n",
+           (counting_alloc::bytes - bytes + n * sizeof(handle)) / 1e6,
+           counting_alloc::calls - calls, (bench_seconds() - t) * 1e3,
+           (unsigned long) p.size());
+  }
+
+  pool p;
+  vector<str> keys;
+  vector<handle> handles;
+  hash_map<str, long, hash<str> > by_string;
+  hash_map<handle, long, hash<handle> > by_handle;
+  for (long i = 0; i < distinct; ++i) {
+    keys.push_back(str(names[i]));
+    handles.push_back(p.intern(names[i]));
+    by_string[keys[i]] = i;
+    by_handle[handles[i]] = i;
+  }
+
+  const long finds = 10 * n;
+  long sum = 0;
+  double t = bench_seconds();
+  for (long i = 0; i < finds; ++i)
+    sum += by_string.find(keys[pick[i % n]])->second;
+  printf("hash_map find by string:  %6.1f ns\n",
+         (bench_seconds() - t) * 1e9 / finds);
+
+  t = bench_seconds();
+  for (long i = 0; i < finds; ++i)
+    sum += by_handle.find(handles[pick[i % n]])->second;
+  printf("hash_map find by handle:  %6.1f ns\n",
+         (bench_seconds() - t) * 1e9 / finds);
+
+  t = bench_seconds();
+  for (long i = 0; i < finds; ++i) {
+    handle h;
+    p.find(names[pick[i % n]], h);
+    sum += h.length();
+  }
+  printf("pool find by char*:       %6.1f ns\n",
+         (bench_seconds() - t) * 1e9 / finds);
+
+  // Keep the results alive.
+  if (sum == 42)
+    puts("");
+  return 0;
+}
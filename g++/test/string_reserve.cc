@@ -0,0 +1,157 @@
+// basic_string's capacity: reserve keeps the storage until the string
+// outgrows it, growth at least doubles the capacity, erasing never
+// reallocates, and shrink_to_fit moves the characters into the local
+// buffer or storage that just fits them, leaving a shared Rep alone.
+
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+
+// An SGI-style allocator that counts the blocks asked of it.
+struct counting_alloc
+{
+  static long calls;
+  static void* allocate(size_t n)
+  {
+    ++calls;
+    return malloc(n);
+  }
+  static void deallocate(void* p, size_t)
+  {
+    free(p);
+  }
+  static void* reallocate(void* p, size_t, size_t new_n)
+  {
+    ++calls;
+    return realloc(p, new_n);
+  }
+};
+
+long counting_alloc::calls = 0;
+
+typedef basic_string<char, string_char_traits<char>, counting_alloc> str;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+static void reserve()
+{
+  str s;
+  check(s.capacity() == 15, "an empty string uses the local buffer");
+  s.reserve(10);
+  check(s.capacity() == 15, "reserve within the local buffer");
+
+  s = "hello";
+  s.reserve(1000);
+  check(s.capacity() >= 1000 && s == "hello", "reserve keeps the contents");
+
+  // Appends, erases and appends again within the reserved capacity
+  // stay in the same storage.
+  const char* d = s.data();
+  const size_t cap = s.capacity();
+  long calls = counting_alloc::calls;
+  while (s.length() < 1000)
+    s += 'x';
+  s.erase(3);
+  s.append(900, 'y');
+  check(s.data() == d && s.capacity() == cap && s.length() == 903,
+        "appends within the reserved capacity");
+  check(counting_alloc::calls == calls, "no allocations after reserve");
+
+  for (int i = 0; i < 1000; ++i) {
+    s.erase(100);
+    while (s.length() < 900)
+      s.append("0123456789012345678901234567890123456789");
+  }
+  check(s.data() == d && counting_alloc::calls == calls,
+        "erase and refill do not reallocate");
+
+#ifdef __STL_USE_EXCEPTIONS
+  bool thrown = false;
+  try {
+    s.reserve(s.max_size() + 1);
+  }
+  catch (...) {
+    thrown = true;
+  }
+  check(thrown && s.data() == d, "reserve past max_size");
+#endif
+}
+
+static void shrink_to_fit()
+{
+  str s(1000, 'x');
+  s.erase(903);
+  s.shrink_to_fit();
+  check(s.length() == 903 && s.capacity() >= 903 && s.capacity() < 1000
+        && s == str(903, 'x'), "shrink to an exact Rep");
+
+  const size_t cap = s.capacity();
+  s.shrink_to_fit();
+  check(s.capacity() == cap, "shrinking twice changes nothing");
+
+  s.erase(5);
+  s.shrink_to_fit();
+  check(s.capacity() == 15 && s == "xxxxx", "shrink into the local buffer");
+
+  // A shared Rep is kept, and reserve on a shared string unshares it.
+  str a(100, 'a');
+  str b = a;
+  b.shrink_to_fit();
+  check(b.data() == a.data(), "shrink_to_fit keeps a shared Rep");
+  b.reserve(500);
+  check(b.data() != a.data() && b == a && b.capacity() >= 500
+        && a.capacity() < 500, "reserve unshares");
+
+  basic_string<wchar_t> w;
+  w.reserve(100);
+  check(w.capacity() >= 100, "wide reserve");
+  w.append(50, L'q');
+  w.shrink_to_fit();
+  check(w.length() == 50 && w.capacity() >= 50 && w.capacity() < 100,
+        "wide shrink_to_fit");
+}
+
+// new_storage doubles the capacity when a string outgrows it, but not
+// when a shared string is copied so that it can be changed.
+static void new_storage()
+{
+  str g;
+  const char* last = g.data();
+  size_t cap = g.capacity();
+  long moves = 0;
+  for (int i = 0; i < 100000; ++i) {
+    g += 'z';
+    if (g.data() != last) {
+      ++moves;
+      check(g.capacity() >= 2 * cap, "growth doubles the capacity");
+      last = g.data();
+      cap = g.capacity();
+    }
+  }
+  check(moves < 20, "appends reallocate a logarithmic number of times");
+
+  str a(100, 'a');
+  str b = a;
+  b += 'b';
+  check(b.capacity() >= 101 && b.capacity() < 200,
+        "unsharing copies without doubling");
+}
+
+int main()
+{
+  reserve();
+  shrink_to_fit();
+  new_storage();
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
@@ -0,0 +1,233 @@
+// The searches of basic_string and basic_string_view against plain
+// loops, for random text, needles and positions.  char goes through the
+// memchr, SSE2 and Horspool routines of std/strsearch.h and wchar_t
+// through the generic loops.  The vector loops read sixteen bytes at a
+// time, so the text is also placed against a page that cannot be read,
+// on either side, to show that no load goes past the string.
+
+#include <string>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "bench.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, long n)
+{
+  if (!ok) {
+    printf("FAIL: %s (%ld)\n", what, n);
+    ++failures;
+  }
+}
+
+static const size_t npos = size_t(-1);
+
+template <class charT>
+static bool in(const charT* s, size_t n, charT c)
+{
+  for (size_t i = 0; i < n; ++i)
+    if (s[i] == c)
+      return true;
+  return false;
+}
+
+template <class charT>
+static bool match(const charT* h, const charT* s, size_t n)
+{
+  for (size_t i = 0; i < n; ++i)
+    if (h[i] != s[i])
+      return false;
+  return true;
+}
+
+// The searches written out character by character.
+template <class charT>
+static size_t naive_find(const charT* h, size_t hn, const charT* s,
+                         size_t n, size_t pos)
+{
+  for (size_t i = pos; i <= hn && n <= hn - i; ++i)
+    if (match(h + i, s, n))
+      return i;
+  return npos;
+}
+
+template <class charT>
+static size_t naive_rfind(const charT* h, size_t hn, const charT* s,
+                          size_t n, size_t pos)
+{
+  if (n > hn)
+    return npos;
+  for (size_t i = pos < hn - n ? pos : hn - n; ; --i) {
+    if (match(h + i, s, n))
+      return i;
+    if (i == 0)
+      return npos;
+  }
+}
+
+template <class charT>
+static size_t naive_first_of(const charT* h, size_t hn, const charT* s,
+                             size_t n, size_t pos, bool of)
+{
+  for (size_t i = pos; i < hn; ++i)
+    if (in(s, n, h[i]) == of)
+      return i;
+  return npos;
+}
+
+template <class charT>
+static size_t naive_last_of(const charT* h, size_t hn, const charT* s,
+                            size_t n, size_t pos, bool of)
+{
+  if (hn == 0)
+    return npos;
+  for (size_t i = pos < hn - 1 ? pos : hn - 1; ; --i) {
+    if (in(s, n, h[i]) == of)
+      return i;
+    if (i == 0)
+      return npos;
+  }
+}
+
+// Every search of the view v = (h, hn) for the needle (s, n) from pos.
+template <class charT>
+static void compare(const charT* h, size_t hn, const charT* s, size_t n,
+                    size_t pos, long step)
+{
+  basic_string_view<charT> v(h, hn);
+  check(v.find(s, pos, n) == naive_find(h, hn, s, n, pos), "find", step);
+  check(v.rfind(s, pos, n) == naive_rfind(h, hn, s, n, pos), "rfind", step);
+  check(v.find_first_of(s, pos, n) == naive_first_of(h, hn, s, n, pos, true),
+        "find_first_of", step);
+  check(v.find_last_of(s, pos, n) == naive_last_of(h, hn, s, n, pos, true),
+        "find_last_of", step);
+  check(v.find_first_not_of(s, pos, n)
+        == naive_first_of(h, hn, s, n, pos, false),
+        "find_first_not_of", step);
+  check(v.find_last_not_of(s, pos, n)
+        == naive_last_of(h, hn, s, n, pos, false),
+        "find_last_not_of", step);
+  if (n > 0) {
+    check(v.find(s[0], pos) == naive_find(h, hn, s, 1, pos),
+          "find(char)", step);
+    check(v.rfind(s[0], pos) == naive_rfind(h, hn, s, 1, pos),
+          "rfind(char)", step);
+  }
+}
+
+template <class charT>
+static void random_text(charT* p, size_t n, unsigned long alphabet,
+                        bench_random& r)
+{
+  for (size_t i = 0; i < n; ++i)
+    p[i] = charT('a' + r.below(alphabet));
+}
+
+static size_t random_pos(size_t hn, bench_random& r)
+{
+  return r.below(3) == 0 ? npos : r.below(hn + 3);
+}
+
+// Random searches through basic_string, with small alphabets so that
+// partial matches are common.
+template <class charT>
+static void random_searches(long steps, bench_random& r)
+{
+  charT h[2000], s[100];
+  for (long step = 0; step < steps; ++step) {
+    const unsigned long alphabet = 1 + r.below(r.below(4) == 0 ? 60 : 4);
+    const size_t hn = r.below(r.below(8) == 0 ? 2000 : 70);
+    const size_t n = r.below(r.below(4) == 0 ? 100 : 6);
+    random_text(h, hn, alphabet, r);
+    if (hn > 0 && n <= hn && r.below(2) == 0)
+      memcpy(s, h + r.below(hn - n + 1), n * sizeof(charT));
+    else
+      random_text(s, n, alphabet, r);
+
+    basic_string<charT> str(h, hn);
+    const size_t pos = random_pos(hn, r);
+    check(str.find(s, pos, n) == naive_find(h, hn, s, n, pos),
+          "string find", step);
+    check(str.rfind(s, pos, n) == naive_rfind(h, hn, s, n, pos),
+          "string rfind", step);
+    compare(str.data(), hn, s, n, pos, step);
+  }
+}
+
+// Two guard pages around some readable ones.
+struct guarded
+{
+  char* base;
+  size_t page, size;
+
+  explicit guarded(size_t pages)
+  {
+    page = sysconf(_SC_PAGESIZE);
+    size = (pages + 2) * page;
+    base = (char*) mmap(0, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED
+        || mprotect(base, page, PROT_NONE)
+        || mprotect(base + size - page, page, PROT_NONE))
+      abort();
+  }
+  ~guarded() { munmap(base, size); }
+
+  char* begin() { return base + page; }
+  char* end() { return base + size - page; }
+};
+
+// Text and needles against the guard pages: the text ending where the
+// readable pages end, and starting where they start; the needle too.
+// Needles from 32 bytes are searched for with Horspool's skip table
+// when the text is eight times longer, so lengths go well past that.
+static void guarded_searches(bench_random& r)
+{
+  guarded text(1), needle(1);
+  long step = 0;
+  for (size_t hn = 0; hn <= 600; hn += hn < 70 ? 1 : 13) {
+    for (size_t n = 0; n <= 80 && n <= hn + 2; n += n < 20 ? 1 : 7) {
+      const unsigned long alphabet = 1 + r.below(3);
+      for (int side = 0; side < 2; ++side, ++step) {
+        char* h = side ? text.begin() : text.end() - hn;
+        char* s = side ? needle.begin() : needle.end() - n;
+        random_text(h, hn, alphabet, r);
+        if (n > 0 && n <= hn && r.below(2) == 0)
+          memcpy(s, h + r.below(hn - n + 1), n);
+        else
+          random_text(s, n, alphabet, r);
+        compare<char>(h, hn, s, n, 0, step);
+        compare<char>(h, hn, s, n, npos, step);
+        compare<char>(h, hn, s, n, random_pos(hn, r), step);
+      }
+    }
+  }
+
+  // Horspool directly, whatever the ratio of text to needle.
+  for (size_t hn = 1; hn <= 200; ++hn)
+    for (size_t n = 1; n <= hn; n += 1 + n / 8, ++step) {
+      char* h = text.end() - hn;
+      char* s = needle.end() - n;
+      random_text(h, hn, 2, r);
+      memcpy(s, h + r.below(hn - n + 1), n);
+      if (r.below(4) == 0)
+        s[n - 1] = 'z';
+      const char* p = __str_horspool(h, hn, s, n);
+      check((p ? size_t(p - h) : npos) == naive_find(h, hn, s, n, 0),
+            "__str_horspool", step);
+    }
+}
+
+int main()
+{
+  bench_random r(1);
+  random_searches<char>(200000, r);
+  random_searches<wchar_t>(30000, r);
+  guarded_searches(r);
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
@@ -0,0 +1,110 @@
+// Searches of the kind used to pick apart a web server log, over a
+// synthetic access log: scans of the whole log for short and long
+// needles, searches within each line, and tokenizing with the
+// find_*_of family.  Times are in milliseconds.
+//
+// Usage: string_search_bench [lines]
+
+#include <string>
+#include <vector.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+
+typedef basic_string<char> str;
+
+static const char* verbs[] = { "GET", "POST", "PUT", "DELETE" };
+static const char* agents[] = {
+  "Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/115.0",
+  "curl/7.88.1",
+  "python-requests/2.31.0",
+  "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36"
+};
+
+static double started;
+
+static void start()
+{
+  started = bench_seconds();
+}
+
+static void report(const char* what)
+{
+  printf("%-40s %8.1f\n", what, (bench_seconds() - started) * 1e3);
+}
+
+int main(int argc, char** argv)
+{
+  const long lines = bench_arg(argc, argv, 1, 1000000);
+
+  char* text = (char*) malloc(lines * 200);
+  size_t n = 0;
+  bench_random r(1);
+  for (long i = 0; i < lines; ++i)
+    n += sprintf(text + n, "10.%lu.%lu.%lu - - [18/Oct/2026:10:%02lu:%02lu"
+                 " +0000] \"%s /api/v1/item/%lu?q=%lu HTTP/1.1\" %lu %lu"
+                 " \"%s\"\n",
+                 r.below(256), r.below(256), r.below(256), r.below(60),
+                 r.below(60), verbs[r.below(4)], r.below(5000), r.below(100),
+                 200 + r.below(4) * 100, r.below(100000), agents[r.below(4)]);
+  const str log(text, n);
+  free(text);
+
+  vector<str> line;
+  line.reserve(lines);
+  for (size_t b = 0, e; b < n; b = e + 1) {
+    e = log.find('\n', b);
+    line.push_back(log.substr(b, e - b));
+  }
+
+  printf("%lu lines, %lu MB\n", (unsigned long) line.size(),
+         (unsigned long) (n >> 20));
+  size_t sum = 0;
+
+  start();
+  for (size_t p = 0; (p = log.find("\" 500 ", p)) != str::npos; ++p)
+    ++sum;
+  report("count '\" 500 ' in the log");
+
+  start();
+  sum += log.find("Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7)"
+                  " AppleWebKit/605.1.15");
+  report("absent 68-byte user agent");
+
+  start();
+  sum += log.find(" - - [18/Oct/2026:10:61:61 +0000] \"GET /api/v1");
+  report("long needle with common end bytes");
+
+  start();
+  for (size_t i = 0; i < line.size(); ++i)
+    sum += line[i].find("HTTP/1.1\" 4") != str::npos;
+  report("find 'HTTP/1.1\" 4' in each line");
+
+  start();
+  for (size_t i = 0; i < line.size(); ++i)
+    sum += line[i].rfind('"') + line[i].rfind("/api/");
+  report("rfind '\"' and \"/api/\" in each line");
+
+  start();
+  for (size_t i = 0; i < line.size(); ++i) {
+    const str& l = line[i];
+    for (size_t b = 0; (b = l.find_first_not_of(" \t", b)) != str::npos; ) {
+      const size_t e = l.find_first_of(" \t\"[]", b);
+      ++sum;
+      if (e == str::npos)
+        break;
+      b = e + 1;
+    }
+  }
+  report("tokenize with find_first_(not_)of");
+
+  start();
+  for (size_t i = 0; i < line.size(); ++i)
+    sum += line[i].find_last_of("?&=") + line[i].find_last_not_of("\" ");
+  report("find_last_of / find_last_not_of");
+
+  // Keep the results alive.
+  if (sum == 42)
+    puts("");
+  return 0;
+}
@@ -0,0 +1,239 @@
+// basic_string keeps short strings inside the object and longer ones in
+// a shared Rep on the heap.  Run strings through a random mix of
+// operations, checking each against a plain array of characters, with
+// lengths chosen to cross the boundary between the two often; then
+// check the transitions one by one.
+
+#include <string>
+#include <vector.h>
+#include <stdio.h>
+#include <string.h>
+#include "bench.h"
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, long n)
+{
+  if (!ok) {
+    printf("FAIL: %s (%ld)\n", what, n);
+    ++failures;
+  }
+}
+
+template <class charT>
+static bool same(const basic_string<charT>& s, const vector<charT>& model)
+{
+  if (s.length() != model.size() || s.capacity() < s.length())
+    return false;
+  if (!model.empty()
+      && memcmp(s.data(), &model[0], model.size() * sizeof(charT)) != 0)
+    return false;
+  const charT* c = s.c_str();
+  return (model.empty()
+          || memcmp(c, &model[0], model.size() * sizeof(charT)) == 0)
+         && c[model.size()] == charT();
+}
+
+// Mostly lengths around the size of the local buffer.
+static size_t random_length(bench_random& r)
+{
+  const unsigned long k = r.below(10);
+  return k < 7 ? r.below(24) : k < 9 ? r.below(100) : r.below(600);
+}
+
+template <class charT>
+static void random_text(vector<charT>& v, size_t n, bench_random& r)
+{
+  v.erase(v.begin(), v.end());
+  for (size_t i = 0; i < n; ++i)
+    v.push_back(charT('a' + r.below(26)));
+}
+
+template <class charT>
+static void mix(long steps, bench_random& r)
+{
+  typedef basic_string<charT> str;
+  const int n = 12;
+  str s[n];
+  vector<charT> m[n];
+  vector<charT> t;
+
+  for (long step = 0; step < steps; ++step) {
+    const int i = r.below(n), j = r.below(n);
+    random_text(t, random_length(r), r);
+    const charT* tp = t.empty() ? 0 : &t[0];
+    switch (r.below(16)) {
+    case 0:
+      s[i].assign(tp, t.size());
+      m[i] = t;
+      break;
+    case 1:
+      s[i] = s[j];
+      m[i] = m[j];
+      break;
+    case 2: {
+      // Every combination of local and heap strings gets swapped.
+      str c(s[j]);
+      vector<charT> cm(m[j]);
+      s[i].swap(c);
+      m[i].swap(cm);
+      check(same(c, cm), "swap: other side", step);
+      break;
+    }
+    case 3:
+      s[i].append(tp, t.size());
+      m[i].insert(m[i].end(), t.begin(), t.end());
+      break;
+    case 4: {
+      // Appending a string to itself reads the old contents while the
+      // storage may be replaced.
+      vector<charT> add(m[j]);
+      s[i] += s[j];
+      m[i].insert(m[i].end(), add.begin(), add.end());
+      break;
+    }
+    case 5:
+      if (!m[i].empty()) {
+        const size_t pos = r.below(m[i].size());
+        size_t len = r.below(30);
+        s[i].erase(pos, len);
+        if (len > m[i].size() - pos)
+          len = m[i].size() - pos;
+        m[i].erase(m[i].begin() + pos, m[i].begin() + pos + len);
+      }
+      break;
+    case 6: {
+      const size_t pos = r.below(m[i].size() + 1);
+      s[i].insert(pos, tp, t.size());
+      m[i].insert(m[i].begin() + pos, t.begin(), t.end());
+      break;
+    }
+    case 7:
+      if (!m[i].empty()) {
+        const size_t pos = r.below(m[i].size());
+        size_t len = r.below(m[i].size() - pos + 1);
+        s[i].replace(pos, len, tp, t.size());
+        m[i].erase(m[i].begin() + pos, m[i].begin() + pos + len);
+        m[i].insert(m[i].begin() + pos, t.begin(), t.end());
+      }
+      break;
+    case 8:
+      if (!m[j].empty()) {
+        const size_t pos = r.below(m[j].size());
+        size_t len = r.below(40);
+        if (len > m[j].size() - pos)
+          len = m[j].size() - pos;
+        s[i] = s[j].substr(pos, len);
+        m[i] = vector<charT>(m[j].begin() + pos, m[j].begin() + pos + len);
+      }
+      break;
+    case 9: {
+      const size_t len = random_length(r);
+      s[i].resize(len, charT('z'));
+      m[i].resize(len, charT('z'));
+      break;
+    }
+    case 10:
+      s[i].reserve(random_length(r));
+      check(s[i].capacity() >= m[i].size(), "reserve: capacity", step);
+      break;
+    case 11: {
+      // A shared Rep is kept, so shrink an unshared copy to see the
+      // move back into the object.
+      str c(s[i].data(), s[i].length());
+      c.reserve(200);
+      c.shrink_to_fit();
+      s[i].shrink_to_fit();
+      const size_t local = 16 / sizeof(charT) > 1 ? 16 / sizeof(charT) : 2;
+      if (m[i].size() < local)
+        check(c.capacity() == local - 1, "shrink_to_fit: local", step);
+      check(same(c, m[i]), "shrink_to_fit: contents", step);
+      break;
+    }
+    case 12:
+      if (!m[i].empty()) {
+        // A write through operator[] must not show in copies.
+        const size_t pos = r.below(m[i].size());
+        s[i][pos] = charT('#');
+        m[i][pos] = charT('#');
+      }
+      break;
+    case 13:
+      if (!m[j].empty()) {
+        // Assigning part of a string to itself.
+        const size_t pos = r.below(m[j].size());
+        vector<charT> part(m[j].begin() + pos, m[j].end());
+        s[j].assign(s[j], pos, str::npos);
+        m[j] = part;
+      }
+      break;
+    case 14:
+      s[i] += charT('+');
+      m[i].push_back(charT('+'));
+      break;
+    default: {
+      str c(s[i]);
+      check(same(c, m[i]), "copy", step);
+      c += charT('!');
+      break;
+    }
+    }
+    check(same(s[i], m[i]) && same(s[j], m[j]), "contents", step);
+  }
+  for (int i = 0; i < n; ++i)
+    check(same(s[i], m[i]), "final contents", i);
+}
+
+int main()
+{
+  bench_random r(1);
+  mix<char>(300000, r);
+  mix<wchar_t>(100000, r);
+
+  typedef basic_string<char> str;
+  const char* text = "0123456789abcdefghijklmnopqrstuvwxyz";
+  {
+    // Fifteen characters fit in the object, sixteen do not.
+    str a(text, 15);
+    str b(text, 16);
+    check(a.capacity() == 15, "15 characters are local", 0);
+    check(b.capacity() >= 16, "16 characters are on the heap", 0);
+
+    // Growing past the buffer moves to the heap; shrinking back and
+    // shrink_to_fit returns to the buffer.
+    a += 'x';
+    check(a.length() == 16 && a.capacity() >= 16, "grow to the heap", 0);
+    a.erase(3);
+    check(a.capacity() >= 16, "erase keeps capacity", 0);
+    a.shrink_to_fit();
+    check(a.capacity() == 15 && a == str(text, 3), "shrink to local", 0);
+
+    // A heap string shared by copies is not changed by a write to one.
+    str c(b);
+    c[0] = 'X';
+    check(b == str(text, 16) && c[0] == 'X', "copy on write", 0);
+
+    // Swapping a local string with a heap one exchanges contents both
+    // ways.
+    str l(text, 5), h(text, 30);
+    l.swap(h);
+    check(l == str(text, 30) && h == str(text, 5), "swap local and heap", 0);
+    check(h.capacity() == 15, "swap: short side is local", 0);
+    l.swap(l);
+    check(l == str(text, 30), "swap with itself", 0);
+
+    // A substring of a long string that is short lives in its own
+    // buffer.
+    str sub = h.substr(1, 3);
+    check(sub == "123" && sub.capacity() == 15, "short substring", 0);
+
+    str empty;
+    check(empty.c_str()[0] == 0 && empty.length() == 0, "empty c_str", 0);
+    const basic_string<wchar_t> wempty;
+    check(wempty.c_str()[0] == 0, "empty wide c_str", 0);
+  }
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
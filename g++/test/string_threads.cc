@@ -0,0 +1,131 @@
+// Many threads copying and destroying strings that share one Rep.  Each
+// string object belongs to one thread at a time, but the Reps behind
+// them are shared across threads, so their reference counts are changed
+// from all the threads at once.  The allocator counts the bytes
+// outstanding, so a lost or doubled release shows as a leak, a double
+// free or a corrupted string.  Build it with -fsanitize=thread as well.
+
+#include <string>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+
+// An SGI-style allocator that keeps an atomic count of the bytes
+// outstanding.
+struct counting_alloc
+{
+  static long bytes;
+  static void* allocate(size_t n)
+  {
+    __sync_fetch_and_add(&bytes, long(n));
+    return malloc(n);
+  }
+  static void deallocate(void* p, size_t n)
+  {
+    __sync_fetch_and_sub(&bytes, long(n));
+    free(p);
+  }
+  static void* reallocate(void* p, size_t old_n, size_t new_n)
+  {
+    __sync_fetch_and_add(&bytes, long(new_n) - long(old_n));
+    return realloc(p, new_n);
+  }
+};
+
+long counting_alloc::bytes = 0;
+
+typedef basic_string<char, string_char_traits<char>, counting_alloc> str;
+
+static const long threads = 8;
+static const long steps = 200000;
+static const int sources = 8;
+static const int slots = 16;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+static long thread_failures[threads];
+
+// The strings every thread copies from; they are not changed while the
+// threads run.
+static str* source;
+
+static bool intact(const str& s)
+{
+  if (s.length() < 40)
+    return false;
+  const char c = s[0];
+  for (size_t i = 1; i < s.length(); ++i)
+    if (s[i] != c && s[i] != 'x')
+      return false;
+  return true;
+}
+
+// Strings handed from one thread to another, so that the last copy of a
+// Rep is often dropped by a thread other than the one that made it.
+static pthread_mutex_t mailbox_lock = PTHREAD_MUTEX_INITIALIZER;
+static str* mailbox;
+
+static void copy_thread(void*, long t)
+{
+  str keep[slots];
+  bench_random r(t + 1);
+  for (long i = 0; i < steps; ++i) {
+    const unsigned long k = r.next();
+    str c(source[k % sources]);
+    keep[(k >> 8) % slots] = c;
+    if ((k >> 16) % 64 == 0) {
+      // Unsharing a copy leaves the source and the other copies alone.
+      str d(keep[(k >> 24) % slots]);
+      d += 'x';
+      keep[(k >> 32) % slots] = d;
+    }
+    if ((k >> 40) % 16 == 0) {
+      str& mine = keep[(k >> 44) % slots];
+      pthread_mutex_lock(&mailbox_lock);
+      mailbox[(k >> 48) % slots].swap(mine);
+      pthread_mutex_unlock(&mailbox_lock);
+      if (!mine.empty() && !intact(mine))
+        ++thread_failures[t];
+    }
+  }
+  for (int k = 0; k < slots; ++k)
+    if (!intact(keep[k]))
+      ++thread_failures[t];
+}
+
+int main()
+{
+  {
+    str s[sources];
+    for (int i = 0; i < sources; ++i)
+      s[i] = str(size_t(40 + i), char('a' + i));
+    str m[slots];
+    source = s;
+    mailbox = m;
+
+    bench_run_threads(threads, copy_thread, 0);
+
+    long failed = 0;
+    for (long t = 0; t < threads; ++t)
+      failed += thread_failures[t];
+    check(failed == 0, "copies are intact");
+    for (int i = 0; i < sources; ++i)
+      check(s[i] == str(size_t(40 + i), char('a' + i)), "sources unchanged");
+    for (int k = 0; k < slots; ++k)
+      check(m[k].empty() || intact(m[k]), "mailbox is intact");
+  }
+  check(counting_alloc::bytes == 0, "every Rep is freed once");
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}
@@ -0,0 +1,163 @@
+// basic_string_view: its members, comparisons and hashing mixed with
+// basic_string and charT*, and looking up string keys in a hash_map and
+// a map by view without building a string for each lookup.
+
+#include <string>
+#include <hash_map.h>
+#include <map.h>
+#include <algo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// An SGI-style allocator that counts the blocks asked of it.
+struct counting_alloc
+{
+  static long calls;
+  static void* allocate(size_t n)
+  {
+    ++calls;
+    return malloc(n);
+  }
+  static void deallocate(void* p, size_t)
+  {
+    free(p);
+  }
+  static void* reallocate(void* p, size_t, size_t new_n)
+  {
+    ++calls;
+    return realloc(p, new_n);
+  }
+};
+
+long counting_alloc::calls = 0;
+
+typedef basic_string<char, string_char_traits<char>, counting_alloc> str;
+typedef basic_string_view<char> view;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what)
+{
+  if (!ok) {
+    printf("FAIL: %s\n", what);
+    ++failures;
+  }
+}
+
+static void members()
+{
+  const str s("hello, wonderful world of views");
+  const view v = s;
+  check(v.data() == s.data() && v.size() == s.size(), "view of a string");
+
+  const view w = v.substr(7, 9);
+  check(w == "wonderful" && "wonderful" == w && w.length() == 9, "substr");
+  check(w.find("der") == 3 && w.find('z') == view::npos && w.rfind('o') == 1,
+        "find in a view");
+  check(v.find(w) == 7 && s.find(w) == 7 && s.rfind(w) == 7,
+        "find a view");
+  check(s.find_first_of(view("xyzw")) == 7
+        && v.find_last_not_of("sweiv") == 25, "find_*_of");
+
+  check(w.compare("wonder") > 0 && w.compare("wonderfully") < 0
+        && w.compare(view("wonderful")) == 0, "compare");
+  check(s.compare(v) == 0 && s == v && v == s && !(s != v), "equality");
+  check(s < w && w > s && w <= w && w >= w && v > s.c_str() + 1,
+        "ordering");
+
+  check(s.substr(7, 9) == w && str(w) == "wonderful", "string from a view");
+  str t;
+  t.assign(w);
+  t += view(" stuff");
+  t.append(view("!"));
+  check(t == "wonderful stuff!", "assign and append a view");
+
+  view u = w;
+  u.remove_prefix(3);
+  u.remove_suffix(2);
+  check(u == "derf" && u.front() == 'd' && u.back() == 'f',
+        "remove_prefix and remove_suffix");
+  check(view().empty() && view("").size() == 0, "empty views");
+
+  char buf[8];
+  check(w.copy(buf, 3, 2) == 3 && memcmp(buf, "nde", 3) == 0, "copy");
+  check(count(v.begin(), v.end(), 'o') == 4 && *v.rbegin() == 's',
+        "iterators");
+
+  view a("abc"), b("xy");
+  a.swap(b);
+  check(a == "xy" && b == "abc", "swap");
+
+  const basic_string<wchar_t> ws(L"abcabcab");
+  const basic_string_view<wchar_t> wv = ws;
+  check(wv.find(L"cab") == 2 && wv.rfind(L"cab") == 5
+        && wv.find_first_not_of(L"ab") == 2 && ws.find(wv.substr(3)) == 0
+        && ws.find(wv.substr(4)) == 1, "wide views");
+}
+
+// The hash of a string and of a view of the same characters agree, so
+// either can find the other.
+static void hashing()
+{
+  const str s("wonderful");
+  const view v("wonderful");
+  check(hash<str>()(s) == hash<view>()(v) && hash<str>()(v) == hash<str>()(s)
+        && hash<view>()(s) == hash<view>()(v), "hashes agree");
+
+  hash_map<view, int, hash<view> > hv;
+  hv[view("x")] = 1;
+  check(hv.find(view("y")) == hv.end() && hv.find(view("x")) != hv.end(),
+        "hash_map keyed on views");
+}
+
+// Lookups by view in containers of strings with transparent hashing
+// and comparison.  None of them may allocate.
+static void lookup()
+{
+  typedef hash_map<str, int, hash<str>, equal_to<void> > hashed;
+  typedef map<str, int, less<void> > ordered;
+  hashed h;
+  ordered m;
+  static const char* words[] = {
+    "alpha", "beta", "gamma", "delta", "a-much-longer-key-than-local"
+  };
+  for (int i = 0; i < 5; ++i) {
+    h[str(words[i])] = i;
+    m[str(words[i])] = i;
+  }
+
+  const view text("gamma beta zeta alpha a-much-longer-key-than-local"
+                  " delta delta");
+  const long calls = counting_alloc::calls;
+  int found = 0, sum = 0;
+  for (size_t b = 0; b < text.size(); ) {
+    size_t e = text.find(' ', b);
+    if (e == view::npos)
+      e = text.size();
+    const view word = text.substr(b, e - b);
+    hashed::iterator i = h.find(word);
+    ordered::iterator j = m.find(word);
+    if (i != h.end()) {
+      ++found;
+      sum += i->second;
+      check(j != m.end() && j->second == i->second, "map agrees");
+    } else
+      check(j == m.end(), "map agrees on a miss");
+    check(h.count(word) == m.count(word), "count");
+    b = e + 1;
+  }
+  check(counting_alloc::calls == calls, "lookups do not allocate");
+  check(found == 6 && sum == 2 + 1 + 0 + 4 + 3 + 3, "lookups find the keys");
+}
+
+int main()
+{
+  members();
+  hashing();
+  lookup();
+
+  if (failures == 0)
+    puts("ok");
+  return failures != 0;
+}